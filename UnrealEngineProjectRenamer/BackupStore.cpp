@@ -0,0 +1,236 @@
+#include "BackupStore.h"
+#include "MappedFile.h"
+#include "Sha256.h"
+#include "Trace.h"
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Manifest paths are stored as generic UTF-8 so they survive a move between platforms
+    std::string ToManifestPath(const fs::path& path)
+    {
+        std::u8string text = path.generic_u8string();
+        return std::string(text.begin(), text.end());
+    }
+
+    fs::path FromManifestPath(const std::string& text)
+    {
+        return fs::path(std::u8string(text.begin(), text.end()));
+    }
+
+    fs::path BlobPath(const fs::path& storeDirectory, const std::string& hash)
+    {
+        return storeDirectory / BackupStore::ObjectsFolderName / hash.substr(0, 2) / hash;
+    }
+}
+
+BackupStore::BackupStore(const fs::path& storeDirectory, const fs::path& runDirectory)
+    : storeDirectory(storeDirectory), runDirectory(runDirectory)
+{
+    // A resumed run keeps the copies taken before it was interrupted, which hold the original content
+    std::map<fs::path, std::string> entries;
+    std::string error;
+    if (ReadManifest(runDirectory, entries, error))
+    {
+        for (const auto& [relativePath, hash] : entries)
+        {
+            storedPaths.insert(ToManifestPath(relativePath));
+        }
+    }
+}
+
+BackupStore::Result BackupStore::StoreFile(const fs::path& filePath, const fs::path& relativePath, std::string& error)
+{
+    MappedFile file(filePath);
+    if (!file.IsOpen())
+    {
+        error = "Could not open " + filePath.string();
+        return Result::Failed;
+    }
+
+    return StoreContent(file.View(), relativePath, error);
+}
+
+BackupStore::Result BackupStore::StoreContent(std::string_view content, const fs::path& relativePath, std::string& error)
+{
+    std::string manifestPath = ToManifestPath(relativePath);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!storedPaths.insert(manifestPath).second) return Result::AlreadyStored;
+    }
+
+    std::string hash = Sha256::HashHex(content);
+    fs::path blobPath = BlobPath(storeDirectory, hash);
+
+    try
+    {
+        // Unique content is only ever written once across all runs
+        if (!fs::exists(blobPath) && !WriteBlob(blobPath, content, error))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            storedPaths.erase(manifestPath);
+            return Result::Failed;
+        }
+
+        // Mirror the project layout in the run folder with links to the blobs
+        fs::path linkPath = runDirectory / relativePath;
+        fs::create_directories(linkPath.parent_path());
+
+        std::error_code linkError;
+        fs::remove(linkPath, linkError);
+        fs::create_hard_link(blobPath, linkPath, linkError);
+        if (linkError)
+        {
+            // File systems without hard links get a plain copy instead
+            fs::copy_file(blobPath, linkPath, fs::copy_options::overwrite_existing);
+        }
+    }
+    catch (const fs::filesystem_error& e)
+    {
+        error = e.what();
+        std::lock_guard<std::mutex> lock(mutex);
+        storedPaths.erase(manifestPath);
+        return Result::Failed;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!manifest.is_open())
+    {
+        manifest.open(runDirectory / ManifestFileName, std::ios::binary | std::ios::app);
+    }
+    manifest << hash << ' ' << content.size() << ' ' << manifestPath << '\n';
+    manifest.flush();
+
+    if (!manifest)
+    {
+        error = "Could not write the backup manifest";
+        storedPaths.erase(manifestPath);
+        return Result::Failed;
+    }
+    return Result::Stored;
+}
+
+void BackupStore::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    manifest.close();
+}
+
+bool BackupStore::WriteBlob(const fs::path& blobPath, std::string_view content, std::string& error)
+{
+    static std::atomic<unsigned> tempCounter{ 0 };
+
+    fs::create_directories(blobPath.parent_path());
+
+    // Write under a unique temporary name so concurrent writers of the same blob never collide
+    std::ostringstream tempName;
+    tempName << blobPath.filename().string() << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id()) << '_' << tempCounter++;
+    fs::path tempPath = blobPath.parent_path() / tempName.str();
+
+    {
+        std::ofstream blob(tempPath, std::ios::binary | std::ios::trunc);
+        blob.write(content.data(), content.size());
+        blob.close();
+        TraceAdd(TraceCounter::SystemCalls, 3);
+        TraceAdd(TraceCounter::BytesWritten, content.size());
+        if (blob.fail())
+        {
+            std::error_code ignored;
+            fs::remove(tempPath, ignored);
+            error = "Could not write backup blob " + blobPath.string();
+            return false;
+        }
+    }
+
+    std::error_code renameError;
+    fs::rename(tempPath, blobPath, renameError);
+    if (renameError)
+    {
+        std::error_code ignored;
+        fs::remove(tempPath, ignored);
+
+        // Another writer stored the same content first
+        if (fs::exists(blobPath)) return true;
+
+        error = "Could not store backup blob " + blobPath.string() + ": " + renameError.message();
+        return false;
+    }
+
+    // Blobs are shared by every run that links to them, so protect them from edits
+    std::error_code ignored;
+    fs::permissions(blobPath, fs::perms::owner_write | fs::perms::group_write | fs::perms::others_write, fs::perm_options::remove, ignored);
+    return true;
+}
+
+bool BackupStore::ReadManifest(const fs::path& runDirectory, std::map<fs::path, std::string>& entries, std::string& error)
+{
+    std::ifstream manifest(runDirectory / ManifestFileName, std::ios::binary);
+    if (!manifest)
+    {
+        error = "No backup manifest found in " + runDirectory.string();
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        if (line.empty()) continue;
+
+        // <sha256> <size> <relative path>
+        size_t hashEnd = line.find(' ');
+        size_t sizeEnd = hashEnd == std::string::npos ? std::string::npos : line.find(' ', hashEnd + 1);
+        if (sizeEnd == std::string::npos)
+        {
+            error = "Malformed manifest line: " + line;
+            return false;
+        }
+
+        // The first entry of a path holds its original content
+        entries.emplace(FromManifestPath(line.substr(sizeEnd + 1)), line.substr(0, hashEnd));
+    }
+    return true;
+}
+
+bool BackupStore::RestoreBlob(const fs::path& storeDirectory, const std::string& hash, const fs::path& targetPath, std::string& error)
+{
+    try
+    {
+        fs::create_directories(targetPath.parent_path());
+
+        // Copy rather than link so later edits to the project never reach the store
+        if (fs::exists(targetPath))
+        {
+            fs::permissions(targetPath, fs::perms::owner_write, fs::perm_options::add);
+        }
+        fs::copy_file(BlobPath(storeDirectory, hash), targetPath, fs::copy_options::overwrite_existing);
+        fs::permissions(targetPath, fs::perms::owner_write, fs::perm_options::add);
+    }
+    catch (const fs::filesystem_error& e)
+    {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+bool BackupStore::Restore(const fs::path& runDirectory, std::vector<fs::path>& restoredFiles, std::string& error)
+{
+    fs::path storeDirectory = runDirectory.parent_path();
+    fs::path projectRoot = storeDirectory.parent_path();
+
+    std::map<fs::path, std::string> entries;
+    if (!ReadManifest(runDirectory, entries, error)) return false;
+
+    for (const auto& [relativePath, hash] : entries)
+    {
+        fs::path targetPath = projectRoot / relativePath;
+        if (!RestoreBlob(storeDirectory, hash, targetPath, error)) return false;
+        restoredFiles.push_back(targetPath);
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Content-addressed store for backed up files under UEPR_Backups.
+// Every unique file content is written once as a blob in Objects/<xx>/<sha256>; each run only
+// keeps a manifest of (hash, size, path) plus hard links to those blobs, so repeated renames
+// cost space proportional to what actually changed rather than to the size of the project.
+class BackupStore
+{
+public:
+    enum class Result
+    {
+        Stored,
+        AlreadyStored,
+        Failed
+    };
+
+    // storeDirectory is UEPR_Backups, runDirectory the timestamped folder of this run
+    BackupStore(const std::filesystem::path& storeDirectory, const std::filesystem::path& runDirectory);
+
+    // Back up a file on disk under its path relative to the project root.
+    // Only the first copy of a path in a run is kept, since it holds the original content.
+    Result StoreFile(const std::filesystem::path& filePath, const std::filesystem::path& relativePath, std::string& error);
+
+    // Back up content that has already been read, so the file is not read a second time
+    Result StoreContent(std::string_view content, const std::filesystem::path& relativePath, std::string& error);
+
+    const std::filesystem::path& RunDirectory() const { return runDirectory; }
+
+    // Close the manifest, so the project folder can be renamed
+    void Close();
+
+    // Copy every file recorded in a run's manifest back into the project it was taken from
+    static bool Restore(const std::filesystem::path& runDirectory, std::vector<std::filesystem::path>& restoredFiles, std::string& error);
+
+    // Read a run's manifest as relative path -> content hash
+    static bool ReadManifest(const std::filesystem::path& runDirectory, std::map<std::filesystem::path, std::string>& entries, std::string& error);
+
+    // Copy one stored content back to a file, replacing what is there
+    static bool RestoreBlob(const std::filesystem::path& storeDirectory, const std::string& hash, const std::filesystem::path& targetPath, std::string& error);
+
+    static constexpr const char* ManifestFileName = "manifest.txt";
+    static constexpr const char* ObjectsFolderName = "Objects";
+
+private:
+    bool WriteBlob(const std::filesystem::path& blobPath, std::string_view content, std::string& error);
+
+    std::filesystem::path storeDirectory;
+    std::filesystem::path runDirectory;
+
+    std::mutex mutex;
+    std::set<std::string> storedPaths;
+    std::ofstream manifest;
+};
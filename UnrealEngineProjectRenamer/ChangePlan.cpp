@@ -0,0 +1,167 @@
+#include "ChangePlan.h"
+#include "TextDiff.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::vector<ChangePlan::TextEdit> EditsFromDiff(std::string_view before, std::string_view after)
+    {
+        std::vector<ChangePlan::TextEdit> edits;
+        for (const DiffBlock& block : DiffLines(before, after))
+        {
+            edits.push_back({ block.beforeOffset, block.beforeLength, std::string(after.substr(block.afterOffset, block.afterLength)) });
+        }
+        return edits;
+    }
+
+    // Short single line rendering of edited text
+    std::string Quote(std::string_view text)
+    {
+        const size_t maxLength = 60;
+
+        std::string quoted = "\"";
+        for (size_t i = 0; i < text.size() && i < maxLength; ++i)
+        {
+            switch (text[i])
+            {
+            case '\n': quoted += "\\n"; break;
+            case '\r': quoted += "\\r"; break;
+            case '\t': quoted += "\\t"; break;
+            case '"':  quoted += "\\\""; break;
+            default:   quoted += text[i]; break;
+            }
+        }
+        quoted += text.size() > maxLength ? "\"..." : "\"";
+        return quoted;
+    }
+}
+
+ChangePlan::ChangePlan(const fs::path& projectRoot)
+    : projectRoot(projectRoot)
+{
+}
+
+void ChangePlan::RecordEdit(const fs::path& filePath, std::string_view before, std::string_view after, std::vector<TextEdit> edits)
+{
+    if (before == after) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& change : changes)
+    {
+        if (change.kind == Kind::Edit && change.path == filePath)
+        {
+            // Edits of an already edited file are relative to its planned content, so diff against the original again
+            change.after.assign(after);
+            change.edits = EditsFromDiff(change.before, change.after);
+            return;
+        }
+    }
+
+    Change change{ Kind::Edit, filePath, fs::path(), std::string(before), std::string(after), std::move(edits) };
+    if (change.edits.empty())
+    {
+        change.edits = EditsFromDiff(change.before, change.after);
+    }
+    changes.push_back(std::move(change));
+}
+
+void ChangePlan::RecordRename(const fs::path& from, const fs::path& to)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    changes.push_back({ Kind::Rename, from, to, std::string(), std::string(), {} });
+}
+
+void ChangePlan::RecordDelete(const fs::path& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    changes.push_back({ Kind::Delete, path, fs::path(), std::string(), std::string(), {} });
+}
+
+void ChangePlan::RecordCommand(const std::string& command)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    changes.push_back({ Kind::Command, fs::path(), fs::path(), std::string(), command, {} });
+}
+
+bool ChangePlan::PlannedContent(const fs::path& filePath, std::string& content) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& change : changes)
+    {
+        if (change.kind == Kind::Edit && change.path == filePath)
+        {
+            content = change.after;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ChangePlan::Size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return changes.size();
+}
+
+void ChangePlan::SortSince(size_t first)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (first >= changes.size()) return;
+
+    std::stable_sort(changes.begin() + first, changes.end(), [](const Change& a, const Change& b) { return a.path < b.path; });
+}
+
+std::string ChangePlan::DisplayPath(const fs::path& path) const
+{
+    std::error_code error;
+    fs::path relativePath = fs::relative(path, projectRoot, error);
+    if (error || relativePath.empty() || relativePath == "." || *relativePath.begin() == "..") return path.generic_string();
+    return relativePath.generic_string();
+}
+
+void ChangePlan::Write(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    out << "\nChange plan for " << projectRoot << " (dry run, nothing was changed):\n";
+    if (changes.empty())
+    {
+        out << "  no changes\n";
+        return;
+    }
+
+    for (const auto& change : changes)
+    {
+        switch (change.kind)
+        {
+        case Kind::Edit:
+            out << "  edit    " << DisplayPath(change.path) << " (" << change.edits.size() << (change.edits.size() == 1 ? " range)\n" : " ranges)\n");
+            for (const auto& edit : change.edits)
+            {
+                out << "            [" << edit.offset << ", " << edit.offset + edit.length << ") "
+                    << Quote(std::string_view(change.before).substr(edit.offset, edit.length)) << " -> " << Quote(edit.replacement) << "\n";
+            }
+            break;
+        case Kind::Rename:
+            out << "  rename  " << DisplayPath(change.path) << " -> " << DisplayPath(change.target) << "\n";
+            break;
+        case Kind::Delete:
+            out << "  delete  " << DisplayPath(change.path) << "\n";
+            break;
+        case Kind::Command:
+            out << "  run     " << change.after << "\n";
+            break;
+        }
+    }
+
+    for (const auto& change : changes)
+    {
+        if (change.kind != Kind::Edit) continue;
+
+        std::string name = DisplayPath(change.path);
+        out << "\n" << UnifiedDiff(change.before, change.after, "a/" + name, "b/" + name);
+    }
+    out.flush();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every change a rename would make to a project, collected instead of made during --dry-run.
+// Steps record edits from pool workers, so recording is thread safe. The plan is printed as a
+// list of renames, deletions and byte-range edits followed by a unified diff per edited file.
+class ChangePlan
+{
+public:
+    // A byte range of the original file and the text that replaces it
+    struct TextEdit
+    {
+        size_t offset = 0;
+        size_t length = 0;
+        std::string replacement;
+    };
+
+    explicit ChangePlan(const std::filesystem::path& projectRoot);
+
+    // Record new content for a file. Without explicit edits the byte ranges are taken from a
+    // line diff. A second edit of the same file is merged into the first.
+    void RecordEdit(const std::filesystem::path& filePath, std::string_view before, std::string_view after, std::vector<TextEdit> edits = {});
+    void RecordRename(const std::filesystem::path& from, const std::filesystem::path& to);
+    void RecordDelete(const std::filesystem::path& path);
+    void RecordCommand(const std::string& command);
+
+    // The content a file will have once its planned edits are made, for steps that edit a file twice
+    bool PlannedContent(const std::filesystem::path& filePath, std::string& content) const;
+
+    // Changes recorded by parallel tasks arrive in any order; sort those recorded since `first` by path
+    size_t Size() const;
+    void SortSince(size_t first);
+
+    void Write(std::ostream& out) const;
+
+private:
+    enum class Kind
+    {
+        Edit,
+        Rename,
+        Delete,
+        Command
+    };
+
+    struct Change
+    {
+        Kind kind;
+        std::filesystem::path path;
+        std::filesystem::path target;
+        std::string before;
+        std::string after;
+        std::vector<TextEdit> edits;
+    };
+
+    std::string DisplayPath(const std::filesystem::path& path) const;
+
+    std::filesystem::path projectRoot;
+    mutable std::mutex mutex;
+    std::vector<Change> changes;
+};
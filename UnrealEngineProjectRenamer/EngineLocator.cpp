@@ -0,0 +1,276 @@
+#include "EngineLocator.h"
+#include "Platform.h"
+#include <fstream>
+#include <iterator>
+#include <regex>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // The index stores paths as UTF-8, like the backup manifest
+    std::string ToIndexPath(const fs::path& path)
+    {
+        std::u8string text = path.u8string();
+        return std::string(text.begin(), text.end());
+    }
+
+    fs::path FromIndexPath(const std::string& text)
+    {
+        return fs::path(std::u8string(text.begin(), text.end()));
+    }
+
+    std::string ReadText(const fs::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    // "5.3" for an engine whose Build.version has MajorVersion 5 and MinorVersion 3
+    std::string EngineVersion(const fs::path& engineDirectory)
+    {
+        std::string content = ReadText(engineDirectory / "Engine" / "Build" / "Build.version");
+        std::smatch major;
+        std::smatch minor;
+        if (!std::regex_search(content, major, std::regex(R"("MajorVersion"\s*:\s*(\d+))"))
+            || !std::regex_search(content, minor, std::regex(R"("MinorVersion"\s*:\s*(\d+))")))
+        {
+            return std::string();
+        }
+        return major[1].str() + "." + minor[1].str();
+    }
+
+    // Installs the Epic Games Launcher knows about, from the "UE_5.3" AppName of each InstallationList entry
+    void ReadLauncherManifest(std::map<std::string, fs::path>& installs)
+    {
+        std::string content = ReadText(SharedConfigDirectory() / "Epic" / "UnrealEngineLauncher" / "LauncherInstalled.dat");
+
+        std::regex entryRegex(R"(\{[^{}]*\})");
+        std::regex locationRegex(R"re("InstallLocation"\s*:\s*"([^"]*)")re");
+        std::regex appNameRegex(R"re("AppName"\s*:\s*"UE_([^"]*)")re");
+        for (std::sregex_iterator entry(content.begin(), content.end(), entryRegex), end; entry != end; ++entry)
+        {
+            std::string text = entry->str();
+            std::smatch location;
+            std::smatch appName;
+            if (std::regex_search(text, location, locationRegex) && std::regex_search(text, appName, appNameRegex))
+            {
+                // JSON escapes the backslashes of Windows paths
+                std::string path = std::regex_replace(location[1].str(), std::regex(R"(\\\\)"), "\\");
+                installs.emplace(appName[1].str(), FromIndexPath(path));
+            }
+        }
+    }
+
+    // Source builds registered by UnrealVersionSelector: the Builds registry key on Windows, Install.ini elsewhere
+    void ReadRegisteredBuilds(std::map<std::string, fs::path>& installs)
+    {
+        for (const auto& [name, value] : ReadRegistryStrings(false, "SOFTWARE\\Epic Games\\Unreal Engine\\Builds"))
+        {
+            installs.emplace(name, FromIndexPath(value));
+        }
+
+        std::ifstream installIni(UserConfigDirectory() / "Epic" / "UnrealEngine" / "Install.ini");
+        std::string line;
+        bool inInstallations = false;
+        while (std::getline(installIni, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty() && line.front() == '[')
+            {
+                inInstallations = line == "[Installations]";
+                continue;
+            }
+
+            size_t separator = line.find('=');
+            if (inInstallations && separator != std::string::npos)
+            {
+                installs.emplace(line.substr(0, separator), FromIndexPath(line.substr(separator + 1)));
+            }
+        }
+    }
+
+    // Engines in the search path folders, or directly below them, keyed by their version
+    void SearchEngines(const std::vector<fs::path>& searchPath, std::map<std::string, fs::path>& installs)
+    {
+        for (const auto& folder : searchPath)
+        {
+            std::vector<fs::path> candidates = { folder };
+            std::error_code error;
+            for (fs::directory_iterator it(folder, error), end; !error && it != end; it.increment(error))
+            {
+                if (it->is_directory(error)) candidates.push_back(it->path());
+            }
+
+            for (const auto& candidate : candidates)
+            {
+                if (!IsEngineDirectory(candidate)) continue;
+
+                std::string version = EngineVersion(candidate);
+                if (!version.empty())
+                {
+                    installs.emplace(version, candidate);
+                }
+            }
+        }
+    }
+}
+
+EngineLocator::EngineLocator(const fs::path& indexFile, const std::vector<fs::path>& searchPath)
+    : indexFile(indexFile), searchPath(searchPath)
+{
+}
+
+bool EngineLocator::Resolve(const std::string& association, const fs::path& projectRoot, fs::path& engineDirectory, std::string& source)
+{
+    if (association.empty())
+    {
+        for (fs::path directory = projectRoot.parent_path(); !directory.empty(); directory = directory.parent_path())
+        {
+            if (IsEngineDirectory(directory))
+            {
+                engineDirectory = directory;
+                source = "the engine source tree around the project";
+                return true;
+            }
+            if (directory == directory.parent_path()) break;
+        }
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    LoadIndex();
+
+    auto cached = index.find(association);
+    if (cached != index.end() && IsEngineDirectory(cached->second))
+    {
+        engineDirectory = cached->second;
+        source = "the engine index " + indexFile.string();
+        return true;
+    }
+
+    // Look for installs once per process; the Launcher registry key is specific to the association
+    std::map<std::string, fs::path> installs;
+    for (const auto& [name, value] : ReadRegistryStrings(true, "SOFTWARE\\EpicGames\\Unreal Engine\\" + association))
+    {
+        if (name == "InstalledDirectory") installs.emplace(association, FromIndexPath(value));
+    }
+    if (!discovered)
+    {
+        discovered = true;
+        DiscoverInstalls(installs);
+    }
+
+    // Installs that moved are replaced, installs that are gone are dropped
+    for (auto entry = index.begin(); entry != index.end();)
+    {
+        entry = IsEngineDirectory(entry->second) ? std::next(entry) : index.erase(entry);
+    }
+    for (const auto& [key, directory] : installs)
+    {
+        if (IsEngineDirectory(directory)) index[key] = directory;
+    }
+    SaveIndex();
+
+    auto found = index.find(association);
+    if (found == index.end())
+    {
+        return false;
+    }
+    engineDirectory = found->second;
+    source = "the installed engines";
+    return true;
+}
+
+void EngineLocator::Remember(const std::string& association, const fs::path& engineDirectory)
+{
+    if (association.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    LoadIndex();
+    auto entry = index.find(association);
+    if (entry != index.end() && entry->second == engineDirectory) return;
+
+    index[association] = engineDirectory;
+    SaveIndex();
+}
+
+std::string EngineLocator::ReadEngineAssociation(std::string_view uprojectContent)
+{
+    std::string content(uprojectContent);
+    std::smatch matches;
+    if (std::regex_search(content, matches, std::regex(R"re("EngineAssociation"\s*:\s*"([^"]*)")re")))
+    {
+        return matches[1].str();
+    }
+    return std::string();
+}
+
+fs::path EngineLocator::DefaultIndexFile()
+{
+    return UserCacheDirectory() / "UnrealEngineProjectRenamer" / "engines.txt";
+}
+
+void EngineLocator::LoadIndex()
+{
+    if (indexLoaded) return;
+    indexLoaded = true;
+
+    // One "<association>\t<engine folder>" line per install
+    std::ifstream file(indexFile, std::ios::binary);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t separator = line.find('\t');
+        if (separator != std::string::npos)
+        {
+            index[line.substr(0, separator)] = FromIndexPath(line.substr(separator + 1));
+        }
+    }
+}
+
+void EngineLocator::SaveIndex()
+{
+    std::string content;
+    for (const auto& [association, directory] : index)
+    {
+        content += association;
+        content += '\t';
+        content += ToIndexPath(directory);
+        content += '\n';
+    }
+
+    // The index only saves time, so a read-only cache folder is not an error
+    std::error_code error;
+    fs::create_directories(indexFile.parent_path(), error);
+    WriteFileAtomically(indexFile, content, error);
+}
+
+void EngineLocator::DiscoverInstalls(std::map<std::string, fs::path>& installs) const
+{
+    ReadLauncherManifest(installs);
+    ReadRegisteredBuilds(installs);
+    SearchEngines(searchPath, installs);
+}
+
+bool IsEngineDirectory(const fs::path& directory)
+{
+    std::error_code error;
+    return fs::is_regular_file(directory / "Engine" / "Build" / "Build.version", error);
+}
+
+fs::path FindUnrealBuildTool(const fs::path& engineDirectory)
+{
+    fs::path dotNetDirectory = engineDirectory / "Engine" / "Binaries" / "DotNET";
+    std::string unrealBuildToolName = ExecutableName("UnrealBuildTool");
+
+    for (const fs::path& candidate : { dotNetDirectory / "UnrealBuildTool" / unrealBuildToolName, dotNetDirectory / unrealBuildToolName })
+    {
+        std::error_code error;
+        if (fs::is_regular_file(candidate, error))
+        {
+            return candidate;
+        }
+    }
+    return fs::path();
+}
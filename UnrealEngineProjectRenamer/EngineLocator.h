@@ -0,0 +1,56 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Finds the Unreal Engine install a project belongs to from the EngineAssociation of its .uproject,
+// without asking. An association is a version like "5.3" for Launcher installs or a GUID for
+// source builds, and is resolved against, in order:
+//   - the Epic Games Launcher install manifest (LauncherInstalled.dat),
+//   - the Launcher registry keys and the registered source builds on Windows,
+//   - Install.ini of registered source builds on Linux and macOS,
+//   - engines found in the folders of a search path, matched by their Build.version.
+// Every install found is kept in a small index file, so later lookups, and later runs,
+// only check that the cached folder still holds an engine.
+class EngineLocator
+{
+public:
+    EngineLocator(const std::filesystem::path& indexFile, const std::vector<std::filesystem::path>& searchPath);
+
+    // Resolve an association to an engine folder. An empty association means the project lives
+    // inside an engine source tree, which is found by walking up from the project folder.
+    // `source` describes where the engine was found.
+    bool Resolve(const std::string& association, const std::filesystem::path& projectRoot, std::filesystem::path& engineDirectory, std::string& source);
+
+    // Remember an engine folder entered by hand for an association
+    void Remember(const std::string& association, const std::filesystem::path& engineDirectory);
+
+    // The EngineAssociation of a .uproject file's content, or an empty string
+    static std::string ReadEngineAssociation(std::string_view uprojectContent);
+
+    // Where the index lives unless told otherwise: <user cache>/UnrealEngineProjectRenamer/engines.txt
+    static std::filesystem::path DefaultIndexFile();
+
+private:
+    void LoadIndex();
+    void SaveIndex();
+    void DiscoverInstalls(std::map<std::string, std::filesystem::path>& installs) const;
+
+    std::filesystem::path indexFile;
+    std::vector<std::filesystem::path> searchPath;
+
+    std::mutex mutex;
+    bool indexLoaded = false;
+    bool discovered = false;
+    std::map<std::string, std::filesystem::path> index;
+};
+
+// Whether a folder is the root of an engine install, holding Engine/Build/Build.version
+bool IsEngineDirectory(const std::filesystem::path& directory);
+
+// UnrealBuildTool of an engine install: Engine/Binaries/DotNET/UnrealBuildTool/ for UE5,
+// Engine/Binaries/DotNET/ for UE4. Returns an empty path if neither exists.
+std::filesystem::path FindUnrealBuildTool(const std::filesystem::path& engineDirectory);
@@ -0,0 +1,936 @@
+#include "FileIo.h"
+#include "MappedFile.h"
+#include "Platform.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+// Operations are enumerators, not macros; headers with this feature flag (Linux 5.12) know all those used here
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_NATIVE_WORKERS)
+#define UEPR_HAS_IO_URING
+#endif
+#endif
+
+#ifdef UEPR_HAS_IO_URING
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // One pool task per file, each mapping or writing its file on its own
+    class ThreadPoolFileIo : public FileIo
+    {
+    public:
+        explicit ThreadPoolFileIo(ThreadPool& pool)
+            : pool(pool)
+        {
+        }
+
+        const char* Name() const override { return "thread pool"; }
+
+        void ReadFiles(const std::vector<fs::path>& files, const ReadCallback& onRead) override
+        {
+            TaskGroup group;
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                pool.Submit(group, [&files, &onRead, i]()
+                    {
+                        MappedFile file(files[i]);
+                        onRead(i, file.View(), file.IsOpen());
+                    });
+            }
+            pool.Wait(group);
+        }
+
+        void WriteFiles(const std::vector<FileWrite>& writes, std::vector<std::error_code>& errors) override
+        {
+            errors.assign(writes.size(), std::error_code());
+
+            TaskGroup group;
+            for (size_t i = 0; i < writes.size(); ++i)
+            {
+                pool.Submit(group, [&writes, &errors, i]()
+                    {
+                        WriteFileAtomically(writes[i].path, writes[i].content, errors[i]);
+                    });
+            }
+            pool.Wait(group);
+        }
+
+    private:
+        ThreadPool& pool;
+    };
+
+#ifdef UEPR_HAS_IO_URING
+
+    // Files in flight at once, each with a registered buffer that holds it if it is small enough.
+    // Headers, sources and configs are nearly always smaller; larger files are read into the heap.
+    constexpr unsigned SlotCount = 64;
+    constexpr size_t SlotBufferSize = 64 * 1024;
+
+    // Largest read or write handed to the kernel at once
+    constexpr size_t MaxTransfer = 1u << 30;
+
+    int SetupRing(unsigned entries, io_uring_params& params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    int EnterRing(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    int RegisterRing(int ringFd, unsigned opcode, const void* argument, unsigned count)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, argument, count));
+    }
+
+    // The umask of the process, read without changing it. Every bit counts as masked if it cannot be read.
+    mode_t ReadUmask()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.rfind("Umask:", 0) == 0)
+            {
+                return static_cast<mode_t>(std::strtoul(line.c_str() + 6, nullptr, 8));
+            }
+        }
+        return 0777;
+    }
+
+    // The submission and completion queues shared with the kernel. Only one thread drives it at a time.
+    class Ring
+    {
+    public:
+        Ring() = default;
+        ~Ring() { Close(); }
+
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        bool Open(unsigned entries)
+        {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            ringFd = SetupRing(entries, params);
+            if (ringFd < 0) return false;
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMapping)
+            {
+                sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+            }
+
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) return false;
+            cqRing = singleMapping ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) return false;
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqesMapping = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+            if (sqesMapping == MAP_FAILED) return false;
+            sqes = static_cast<io_uring_sqe*>(sqesMapping);
+
+            char* sq = static_cast<char*>(sqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            sqEntries = params.sq_entries;
+
+            char* cq = static_cast<char*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            localTail = *sqTail;
+            return true;
+        }
+
+        void Close()
+        {
+            if (sqes != nullptr) munmap(sqes, sqesSize);
+            if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+            if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+            if (ringFd >= 0) close(ringFd);
+            sqes = nullptr;
+            cqRing = sqRing = MAP_FAILED;
+            ringFd = -1;
+        }
+
+        int Descriptor() const { return ringFd; }
+
+        // Whether every operation the backend queues is known to the kernel
+        bool Supports(std::initializer_list<unsigned> opcodes) const
+        {
+            const unsigned probedOps = 256;
+            void* memory = std::calloc(1, sizeof(io_uring_probe) + probedOps * sizeof(io_uring_probe_op));
+            if (memory == nullptr) return false;
+            io_uring_probe* probe = static_cast<io_uring_probe*>(memory);
+
+            bool supported = RegisterRing(ringFd, IORING_REGISTER_PROBE, probe, probedOps) >= 0;
+            for (unsigned opcode : opcodes)
+            {
+                supported = supported && opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+            }
+            std::free(memory);
+            return supported;
+        }
+
+        // A cleared submission entry, queued to go with the next Submit. Submits first when the queue is full.
+        // Once the ring failed the entry is a scratch one that never reaches the kernel.
+        io_uring_sqe* Queue(uint64_t userData)
+        {
+            unsigned head = std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+            if (localTail - head >= sqEntries)
+            {
+                Submit(0);
+                head = std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+            }
+            if (isFailed || localTail - head >= sqEntries)
+            {
+                std::memset(&discarded, 0, sizeof(discarded));
+                return &discarded;
+            }
+
+            unsigned index = localTail & sqMask;
+            io_uring_sqe* entry = &sqes[index];
+            std::memset(entry, 0, sizeof(*entry));
+            entry->user_data = userData;
+            sqArray[index] = index;
+            localTail++;
+            queued++;
+            inFlight++;
+            return entry;
+        }
+
+        // Hand the queued entries to the kernel and wait until at least `waitFor` operations completed.
+        // Returns false if the ring itself failed.
+        bool Submit(unsigned waitFor)
+        {
+            if (isFailed) return false;
+            std::atomic_ref<unsigned>(*sqTail).store(localTail, std::memory_order_release);
+            while (queued > 0 || waitFor > 0)
+            {
+                int submitted = EnterRing(ringFd, queued, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0);
+                TraceAdd(TraceCounter::SystemCalls, 1);
+                if (submitted < 0)
+                {
+                    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                    isFailed = true;
+                    return false;
+                }
+                queued -= static_cast<unsigned>(submitted);
+                waitFor = 0;
+            }
+            return true;
+        }
+
+        // After a failed Submit: take back the entries the kernel has not taken, and wait for every
+        // operation it has, calling onCompletion for each. Until then the kernel may still write to
+        // the memory those operations point at. Returns false if even waiting fails.
+        template <typename Callback>
+        bool Settle(Callback&& onCompletion)
+        {
+            // Without a kernel polling thread entries are only taken during io_uring_enter
+            localTail -= queued;
+            inFlight -= queued;
+            queued = 0;
+            std::atomic_ref<unsigned>(*sqTail).store(localTail, std::memory_order_release);
+
+            Reap(onCompletion);
+            while (inFlight > 0)
+            {
+                int result = EnterRing(ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+                TraceAdd(TraceCounter::SystemCalls, 1);
+                if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+                Reap(onCompletion);
+            }
+            return true;
+        }
+
+        // Call onCompletion(userData, result) for every operation completed so far
+        template <typename Callback>
+        void Reap(Callback&& onCompletion)
+        {
+            unsigned head = *cqHead;
+            unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+            while (head != tail)
+            {
+                const io_uring_cqe& completion = cqes[head & cqMask];
+                uint64_t userData = completion.user_data;
+                int result = completion.res;
+                head++;
+                std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+                inFlight--;
+                onCompletion(userData, result);
+                tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+            }
+        }
+
+        // Operations queued or submitted whose completion has not been reaped yet
+        unsigned InFlight() const { return inFlight; }
+
+    private:
+        int ringFd = -1;
+        void* sqRing = MAP_FAILED;
+        void* cqRing = MAP_FAILED;
+        size_t sqRingSize = 0;
+        size_t cqRingSize = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqesSize = 0;
+
+        unsigned* sqHead = nullptr;
+        unsigned* sqTail = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned sqMask = 0;
+        unsigned sqEntries = 0;
+
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe* cqes = nullptr;
+
+        unsigned localTail = 0;
+        unsigned queued = 0;
+        unsigned inFlight = 0;
+        bool isFailed = false;
+        io_uring_sqe discarded;
+    };
+
+    // What a completed operation was, kept in the low bits of its user data next to the slot
+    enum Operation : uint64_t
+    {
+        OpOpen,
+        OpStat,
+        OpRead,
+        OpWrite,
+        OpSync,
+        OpClose,
+        OpRename
+    };
+
+    constexpr uint64_t OperationBits = 3;
+
+    uint64_t UserData(unsigned slot, Operation operation)
+    {
+        return (static_cast<uint64_t>(slot) << OperationBits) | operation;
+    }
+
+    // Each file goes through the ring one step at a time: a read is an open and a stat queued together,
+    // then reads until the whole file is in, then a close; a write is a stat for the mode to keep, an
+    // open of the temporary file, writes, a flush, a close and the rename over the target. The steps of
+    // every file in flight go to the kernel together, in one system call per round.
+    class IoUringFileIo : public FileIo
+    {
+    public:
+        explicit IoUringFileIo(ThreadPool& pool)
+            : pool(pool), fallback(pool)
+        {
+        }
+
+        bool Open()
+        {
+            if (!ring.Open(SlotCount * 4)) return false;
+            if (!ring.Supports({ IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_CLOSE, IORING_OP_RENAMEAT }))
+            {
+                return false;
+            }
+
+            buffers = std::make_unique<char[]>(SlotCount * SlotBufferSize);
+            iovec vectors[SlotCount];
+            for (unsigned i = 0; i < SlotCount; ++i)
+            {
+                vectors[i].iov_base = buffers.get() + i * SlotBufferSize;
+                vectors[i].iov_len = SlotBufferSize;
+            }
+
+            // Registering pins the buffers once instead of on every read. A low locked memory limit
+            // can refuse it, the buffers then still work for plain reads.
+            buffersRegistered = RegisterRing(ring.Descriptor(), IORING_REGISTER_BUFFERS, vectors, SlotCount) >= 0;
+
+            processUmask = ReadUmask();
+            return true;
+        }
+
+        const char* Name() const override { return "io_uring"; }
+
+        void ReadFiles(const std::vector<fs::path>& files, const ReadCallback& onRead) override;
+        void WriteFiles(const std::vector<FileWrite>& writes, std::vector<std::error_code>& errors) override;
+
+    private:
+        ThreadPool& pool;
+
+        // Used while the ring is busy with the files of another project, or after it failed
+        ThreadPoolFileIo fallback;
+
+        // Registered with the ring, so they go after it
+        std::unique_ptr<char[]> buffers;
+        bool buffersRegistered = false;
+
+        std::mutex ringMutex;
+        Ring ring;
+        bool isBroken = false;
+        mode_t processUmask = 0777;
+    };
+
+    void IoUringFileIo::ReadFiles(const std::vector<fs::path>& files, const ReadCallback& onRead)
+    {
+        std::unique_lock<std::mutex> ringLock(ringMutex, std::try_to_lock);
+        if (!ringLock.owns_lock() || isBroken)
+        {
+            fallback.ReadFiles(files, onRead);
+            return;
+        }
+
+        TraceSpan span("ReadBatch", "file");
+
+        struct Slot
+        {
+            size_t file = 0;
+            int fd = -1;
+            int pending = 0;
+            bool failed = false;
+            struct statx status;
+            size_t size = 0;
+            size_t done = 0;
+            char* data = nullptr;
+            std::unique_ptr<char[]> largeData;
+        };
+        std::vector<Slot> slots(SlotCount);
+
+        // Slots are handed to the pool once their file is read, and given back once it is processed
+        std::mutex slotMutex;
+        std::condition_variable slotFreed;
+        std::vector<unsigned> freeSlots;
+        std::deque<unsigned> readSlots;
+        for (unsigned i = SlotCount; i > 0; --i)
+        {
+            freeSlots.push_back(i - 1);
+        }
+
+        std::mutex errorMutex;
+        std::exception_ptr firstError;
+
+        auto process = [&](unsigned index)
+            {
+                Slot& slot = slots[index];
+                try
+                {
+                    onRead(slot.file, slot.failed ? std::string_view() : std::string_view(slot.data, slot.done), !slot.failed);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!firstError) firstError = std::current_exception();
+                }
+                slot.largeData.reset();
+
+                std::lock_guard<std::mutex> lock(slotMutex);
+                freeSlots.push_back(index);
+                slotFreed.notify_one();
+            };
+
+        // Process the oldest file read. Returns false if none is waiting.
+        auto processNext = [&]() -> bool
+            {
+                unsigned index;
+                {
+                    std::lock_guard<std::mutex> lock(slotMutex);
+                    if (readSlots.empty()) return false;
+                    index = readSlots.front();
+                    readSlots.pop_front();
+                }
+                process(index);
+                return true;
+            };
+
+        TaskGroup group;
+        size_t finishedFiles = 0;
+        std::vector<bool> isHandedOver(files.size(), false);
+
+        // The slot may take the next file before its close completes, so the close carries the descriptor
+        std::vector<int> closingFds;
+        auto closed = [&](int fd)
+            {
+                auto found = std::find(closingFds.begin(), closingFds.end(), fd);
+                if (found != closingFds.end()) closingFds.erase(found);
+            };
+
+        auto finish = [&](unsigned index)
+            {
+                Slot& slot = slots[index];
+                if (slot.fd >= 0)
+                {
+                    io_uring_sqe* entry = ring.Queue(UserData(static_cast<unsigned>(slot.fd), OpClose));
+                    entry->opcode = IORING_OP_CLOSE;
+                    entry->fd = slot.fd;
+                    closingFds.push_back(slot.fd);
+                    slot.fd = -1;
+                }
+                if (!slot.failed)
+                {
+                    TraceAdd(TraceCounter::BytesRead, slot.done);
+                }
+                finishedFiles++;
+                isHandedOver[slot.file] = true;
+                {
+                    std::lock_guard<std::mutex> lock(slotMutex);
+                    readSlots.push_back(index);
+                }
+                pool.Submit(group, [&processNext]() { processNext(); });
+            };
+
+        auto queueRead = [&](unsigned index)
+            {
+                Slot& slot = slots[index];
+                io_uring_sqe* entry = ring.Queue(UserData(index, OpRead));
+                entry->fd = slot.fd;
+                entry->addr = reinterpret_cast<uint64_t>(slot.data + slot.done);
+                entry->len = static_cast<uint32_t>(std::min(slot.size - slot.done, MaxTransfer));
+                entry->off = slot.done;
+                if (slot.largeData == nullptr && buffersRegistered)
+                {
+                    entry->opcode = IORING_OP_READ_FIXED;
+                    entry->buf_index = static_cast<uint16_t>(index);
+                }
+                else
+                {
+                    entry->opcode = IORING_OP_READ;
+                }
+            };
+
+        auto onCompletion = [&](uint64_t userData, int result)
+            {
+                unsigned index = static_cast<unsigned>(userData >> OperationBits);
+                Operation operation = static_cast<Operation>(userData & ((1u << OperationBits) - 1));
+                if (operation == OpClose)
+                {
+                    closed(static_cast<int>(index));
+                    return;
+                }
+                Slot& slot = slots[index];
+
+                switch (operation)
+                {
+                case OpOpen:
+                case OpStat:
+                    if (result < 0) slot.failed = true;
+                    else if (operation == OpOpen) slot.fd = result;
+                    else slot.size = static_cast<size_t>(slot.status.stx_size);
+
+                    if (--slot.pending > 0) break;
+                    if (slot.failed || slot.size == 0)
+                    {
+                        finish(index);
+                        break;
+                    }
+                    if (slot.size <= SlotBufferSize)
+                    {
+                        slot.data = buffers.get() + index * SlotBufferSize;
+                    }
+                    else
+                    {
+                        slot.largeData.reset(new char[slot.size]);
+                        slot.data = slot.largeData.get();
+                    }
+                    queueRead(index);
+                    break;
+
+                case OpRead:
+                    if (result == -EINTR || result == -EAGAIN)
+                    {
+                        queueRead(index);
+                        break;
+                    }
+                    if (result < 0) slot.failed = true;
+                    else slot.done += static_cast<size_t>(result);
+
+                    // A file that shrank since it was stat'ed ends at the first empty read
+                    if (!slot.failed && result > 0 && slot.done < slot.size)
+                    {
+                        queueRead(index);
+                        break;
+                    }
+                    finish(index);
+                    break;
+
+                default:
+                    break;
+                }
+            };
+
+        size_t nextFile = 0;
+        bool isSettled = true;
+        while (finishedFiles < files.size() || ring.InFlight() > 0)
+        {
+            // Start a file in every free slot, its open and stat go to the kernel together
+            while (nextFile < files.size())
+            {
+                unsigned index;
+                {
+                    std::lock_guard<std::mutex> lock(slotMutex);
+                    if (freeSlots.empty()) break;
+                    index = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+
+                Slot& slot = slots[index];
+                slot.file = nextFile++;
+                slot.fd = -1;
+                slot.pending = 2;
+                slot.failed = false;
+                slot.size = 0;
+                slot.done = 0;
+                slot.data = nullptr;
+
+                const char* path = files[slot.file].c_str();
+                io_uring_sqe* open = ring.Queue(UserData(index, OpOpen));
+                open->opcode = IORING_OP_OPENAT;
+                open->fd = AT_FDCWD;
+                open->addr = reinterpret_cast<uint64_t>(path);
+                open->open_flags = O_RDONLY | O_CLOEXEC;
+
+                io_uring_sqe* stat = ring.Queue(UserData(index, OpStat));
+                stat->opcode = IORING_OP_STATX;
+                stat->fd = AT_FDCWD;
+                stat->addr = reinterpret_cast<uint64_t>(path);
+                stat->len = STATX_SIZE;
+                stat->off = reinterpret_cast<uint64_t>(&slot.status);
+            }
+
+            if (ring.InFlight() > 0)
+            {
+                if (!ring.Submit(1))
+                {
+                    // Nothing more can be read through the ring, the rest is read on the pool. The reads
+                    // in flight are waited for first, then the files they opened are closed.
+                    isBroken = true;
+                    isSettled = ring.Settle([&](uint64_t userData, int result)
+                        {
+                            unsigned index = static_cast<unsigned>(userData >> OperationBits);
+                            Operation operation = static_cast<Operation>(userData & ((1u << OperationBits) - 1));
+                            if (operation == OpClose) closed(static_cast<int>(index));
+                            else if (operation == OpOpen && result >= 0) slots[index].fd = result;
+                        });
+                    for (Slot& slot : slots)
+                    {
+                        if (slot.fd >= 0) close(slot.fd);
+                        slot.fd = -1;
+                    }
+                    // Closes the kernel never took are done here. Ones it may still run are left to it.
+                    for (int fd : closingFds)
+                    {
+                        if (isSettled) close(fd);
+                    }
+                    closingFds.clear();
+                    break;
+                }
+                ring.Reap(onCompletion);
+            }
+            else if (finishedFiles < files.size() && !processNext())
+            {
+                // Every slot holds a file being processed on the pool
+                std::unique_lock<std::mutex> lock(slotMutex);
+                slotFreed.wait(lock, [&] { return !freeSlots.empty() || !readSlots.empty(); });
+            }
+        }
+
+        while (processNext())
+        {
+        }
+        pool.Wait(group);
+
+        if (isBroken)
+        {
+            // The files the ring had not read yet are read on the pool instead
+            std::vector<fs::path> remaining;
+            std::vector<size_t> remainingIndex;
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                if (!isHandedOver[i])
+                {
+                    remaining.push_back(files[i]);
+                    remainingIndex.push_back(i);
+                }
+            }
+            fallback.ReadFiles(remaining, [&](size_t index, std::string_view content, bool isRead) { onRead(remainingIndex[index], content, isRead); });
+        }
+
+        if (!isSettled)
+        {
+            // The kernel may still write to the slots, so they are never freed
+            static_cast<void>(new std::vector<Slot>(std::move(slots)));
+        }
+
+        if (firstError) std::rethrow_exception(firstError);
+    }
+
+    void IoUringFileIo::WriteFiles(const std::vector<FileWrite>& writes, std::vector<std::error_code>& errors)
+    {
+        std::unique_lock<std::mutex> ringLock(ringMutex, std::try_to_lock);
+        if (!ringLock.owns_lock() || isBroken)
+        {
+            fallback.WriteFiles(writes, errors);
+            return;
+        }
+
+        TraceSpan span("WriteBatch", "file");
+        errors.assign(writes.size(), std::error_code());
+
+        struct Slot
+        {
+            size_t write = 0;
+            std::string tempPath;
+            int fd = -1;
+            int error = 0;
+            bool isBusy = false;
+            mode_t mode = 0644;
+            struct statx status;
+            size_t done = 0;
+        };
+        std::vector<Slot> slots(SlotCount);
+        std::vector<unsigned> freeSlots;
+        for (unsigned i = SlotCount; i > 0; --i)
+        {
+            freeSlots.push_back(i - 1);
+        }
+        std::vector<bool> isFinished(writes.size(), false);
+
+        auto finish = [&](unsigned index)
+            {
+                Slot& slot = slots[index];
+                isFinished[slot.write] = true;
+                slot.isBusy = false;
+                if (slot.error != 0)
+                {
+                    unlink(slot.tempPath.c_str());
+                    errors[slot.write] = std::error_code(slot.error, std::generic_category());
+                }
+                TraceAdd(TraceCounter::BytesWritten, slot.done);
+                freeSlots.push_back(index);
+            };
+
+        auto queueWrite = [&](unsigned index)
+            {
+                Slot& slot = slots[index];
+                std::string_view content = writes[slot.write].content;
+                io_uring_sqe* entry = ring.Queue(UserData(index, OpWrite));
+                entry->opcode = IORING_OP_WRITE;
+                entry->fd = slot.fd;
+                entry->addr = reinterpret_cast<uint64_t>(content.data() + slot.done);
+                entry->len = static_cast<uint32_t>(std::min(content.size() - slot.done, MaxTransfer));
+                entry->off = slot.done;
+            };
+
+        auto queueSync = [&](unsigned index)
+            {
+                io_uring_sqe* entry = ring.Queue(UserData(index, OpSync));
+                entry->opcode = IORING_OP_FSYNC;
+                entry->fd = slots[index].fd;
+            };
+
+        auto queueClose = [&](unsigned index)
+            {
+                io_uring_sqe* entry = ring.Queue(UserData(index, OpClose));
+                entry->opcode = IORING_OP_CLOSE;
+                entry->fd = slots[index].fd;
+            };
+
+        auto onCompletion = [&](uint64_t userData, int result)
+            {
+                unsigned index = static_cast<unsigned>(userData >> OperationBits);
+                Operation operation = static_cast<Operation>(userData & ((1u << OperationBits) - 1));
+                Slot& slot = slots[index];
+                std::string_view content = writes[slot.write].content;
+
+                switch (operation)
+                {
+                case OpStat:
+                {
+                    // Keep the permissions of the file being replaced
+                    if (result >= 0) slot.mode = slot.status.stx_mode & 07777;
+                    io_uring_sqe* entry = ring.Queue(UserData(index, OpOpen));
+                    entry->opcode = IORING_OP_OPENAT;
+                    entry->fd = AT_FDCWD;
+                    entry->addr = reinterpret_cast<uint64_t>(slot.tempPath.c_str());
+                    entry->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+                    entry->len = slot.mode;
+                    break;
+                }
+
+                case OpOpen:
+                    if (result < 0)
+                    {
+                        slot.error = -result;
+                        finish(index);
+                        break;
+                    }
+                    slot.fd = result;
+
+                    // The umask applies to a created file, only then the mode needs setting again
+                    if ((slot.mode & processUmask) != 0)
+                    {
+                        fchmod(slot.fd, slot.mode);
+                        TraceAdd(TraceCounter::SystemCalls, 1);
+                    }
+                    if (content.empty()) queueSync(index);
+                    else queueWrite(index);
+                    break;
+
+                case OpWrite:
+                    if (result == -EINTR || result == -EAGAIN)
+                    {
+                        queueWrite(index);
+                        break;
+                    }
+                    if (result <= 0)
+                    {
+                        slot.error = result < 0 ? -result : EIO;
+                        queueClose(index);
+                        break;
+                    }
+                    slot.done += static_cast<size_t>(result);
+                    if (slot.done < content.size()) queueWrite(index);
+                    else queueSync(index);
+                    break;
+
+                case OpSync:
+                    if (result < 0) slot.error = -result;
+                    queueClose(index);
+                    break;
+
+                case OpClose:
+                {
+                    slot.fd = -1;
+                    if (slot.error != 0)
+                    {
+                        finish(index);
+                        break;
+                    }
+                    io_uring_sqe* entry = ring.Queue(UserData(index, OpRename));
+                    entry->opcode = IORING_OP_RENAMEAT;
+                    entry->fd = AT_FDCWD;
+                    entry->addr = reinterpret_cast<uint64_t>(slot.tempPath.c_str());
+                    entry->len = static_cast<uint32_t>(AT_FDCWD);
+                    entry->off = reinterpret_cast<uint64_t>(writes[slot.write].path.c_str());
+                    break;
+                }
+
+                case OpRename:
+                    if (result < 0) slot.error = -result;
+                    finish(index);
+                    break;
+
+                default:
+                    break;
+                }
+            };
+
+        size_t nextWrite = 0;
+        while (nextWrite < writes.size() || ring.InFlight() > 0)
+        {
+            while (nextWrite < writes.size() && !freeSlots.empty())
+            {
+                unsigned index = freeSlots.back();
+                freeSlots.pop_back();
+
+                Slot& slot = slots[index];
+                slot.write = nextWrite++;
+                slot.tempPath = writes[slot.write].path.native() + AtomicWriteSuffix;
+                slot.fd = -1;
+                slot.error = 0;
+                slot.isBusy = true;
+                slot.mode = 0644;
+                slot.done = 0;
+
+                io_uring_sqe* stat = ring.Queue(UserData(index, OpStat));
+                stat->opcode = IORING_OP_STATX;
+                stat->fd = AT_FDCWD;
+                stat->addr = reinterpret_cast<uint64_t>(writes[slot.write].path.c_str());
+                stat->len = STATX_MODE;
+                stat->off = reinterpret_cast<uint64_t>(&slot.status);
+            }
+
+            if (!ring.Submit(1))
+            {
+                // Writes the ring did not finish are reported as failed rather than retried. The ones in
+                // flight are waited for first, then their files are closed and their temporary files removed.
+                isBroken = true;
+                bool isSettled = ring.Settle([&](uint64_t userData, int result)
+                    {
+                        unsigned index = static_cast<unsigned>(userData >> OperationBits);
+                        Operation operation = static_cast<Operation>(userData & ((1u << OperationBits) - 1));
+                        Slot& slot = slots[index];
+                        if (operation == OpOpen && result >= 0) slot.fd = result;
+                        else if (operation == OpClose) slot.fd = -1;
+                        else if (operation == OpRename)
+                        {
+                            if (result < 0) slot.error = -result;
+                            finish(index);
+                        }
+                    });
+                for (Slot& slot : slots)
+                {
+                    if (!slot.isBusy) continue;
+                    // A close the kernel may still run is left to it
+                    if (slot.fd >= 0 && isSettled) close(slot.fd);
+                    slot.fd = -1;
+                    slot.error = EIO;
+                    finish(static_cast<unsigned>(&slot - slots.data()));
+                }
+                for (size_t i = 0; i < writes.size(); ++i)
+                {
+                    if (!isFinished[i]) errors[i] = std::make_error_code(std::errc::io_error);
+                }
+                if (!isSettled)
+                {
+                    // The kernel may still write to the slots, so they are never freed
+                    static_cast<void>(new std::vector<Slot>(std::move(slots)));
+                }
+                break;
+            }
+            ring.Reap(onCompletion);
+        }
+    }
+
+#endif
+}
+
+std::unique_ptr<FileIo> CreateFileIo(FileIoBackend backend, ThreadPool& pool)
+{
+#ifdef UEPR_HAS_IO_URING
+    if (backend != FileIoBackend::ThreadPool)
+    {
+        auto ioUring = std::make_unique<IoUringFileIo>(pool);
+        if (ioUring->Open()) return ioUring;
+    }
+#else
+    (void)backend;
+#endif
+    return std::make_unique<ThreadPoolFileIo>(pool);
+}
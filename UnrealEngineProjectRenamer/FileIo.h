@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+class ThreadPool;
+
+// Reads and rewrites of many project files at once, for the scan and rewrite passes.
+// The thread pool backend opens, maps and writes each file in its own pool task. On Linux the
+// io_uring backend queues the opens, reads, writes, flushes and renames of a whole batch of files
+// to the kernel at once, with reads landing in buffers registered once, so each system call
+// carries the work of many files instead of one.
+enum class FileIoBackend
+{
+    Auto,       // io_uring where the kernel offers it, the thread pool otherwise
+    IoUring,
+    ThreadPool
+};
+
+// Content that replaces the whole of a file
+struct FileWrite
+{
+    std::filesystem::path path;
+    std::string_view content;
+};
+
+class FileIo
+{
+public:
+    // Called once per file with its whole content, which is only valid during the call.
+    // Files that cannot be read are handed over with isRead false and no content.
+    using ReadCallback = std::function<void(size_t index, std::string_view content, bool isRead)>;
+
+    virtual ~FileIo() = default;
+
+    virtual const char* Name() const = 0;
+
+    // Read every file and call onRead for each on the pool, in any order. Returns once all calls have finished.
+    virtual void ReadFiles(const std::vector<std::filesystem::path>& files, const ReadCallback& onRead) = 0;
+
+    // Replace each file like WriteFileAtomically: the content is written to a temporary file next to it,
+    // flushed and renamed over it. errors holds one entry per write, empty for the writes that succeeded.
+    virtual void WriteFiles(const std::vector<FileWrite>& writes, std::vector<std::error_code>& errors) = 0;
+};
+
+// The backend asked for. Asking for io_uring where it is unavailable gives the thread pool backend.
+std::unique_ptr<FileIo> CreateFileIo(FileIoBackend backend, ThreadPool& pool);
@@ -0,0 +1,222 @@
+#include "Journal.h"
+#include "BackupStore.h"
+#include "Platform.h"
+#include "ProgressLedger.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Journal paths are stored relative to the project root as generic UTF-8, like the manifest
+    std::string ToJournalPath(const fs::path& path)
+    {
+        std::u8string text = path.generic_u8string();
+        return std::string(text.begin(), text.end());
+    }
+
+    fs::path FromJournalPath(const std::string& text)
+    {
+        return fs::path(std::u8string(text.begin(), text.end()));
+    }
+
+    struct Entry
+    {
+        std::string operation;
+        std::string path;
+        std::string target;
+    };
+
+    std::vector<std::string> SplitFields(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+}
+
+Journal::Journal(const fs::path& projectRoot, const fs::path& runDirectory)
+    : projectRoot(projectRoot)
+{
+    file.Open(runDirectory / JournalFileName);
+}
+
+bool Journal::RecordEdit(const fs::path& filePath)
+{
+    return Append("edit", filePath, fs::path(), false);
+}
+
+bool Journal::Sync()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file.Sync();
+}
+
+bool Journal::RecordRename(const fs::path& from, const fs::path& to)
+{
+    return Append("rename", from, to, true);
+}
+
+bool Journal::RecordDelete(const fs::path& path)
+{
+    return Append("delete", path, fs::path(), true);
+}
+
+bool Journal::RecordProjectRename(const std::string& oldFolderName, const std::string& newFolderName)
+{
+    return AppendLine("rename-project\t" + oldFolderName + "\t" + newFolderName, true);
+}
+
+void Journal::Commit()
+{
+    AppendLine("commit", true);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file.Close();
+}
+
+bool Journal::Append(const std::string& operation, const fs::path& path, const fs::path& target, bool sync)
+{
+    std::string line = operation + "\t" + ToJournalPath(fs::relative(path, projectRoot));
+    if (!target.empty())
+    {
+        line += '\t';
+        line += ToJournalPath(fs::relative(target, projectRoot));
+    }
+    return AppendLine(line, sync);
+}
+
+bool Journal::AppendLine(const std::string& line, bool sync)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file.Append(line + '\n') && (!sync || file.Sync());
+}
+
+bool Journal::Rollback(const fs::path& runDirectory, std::vector<std::string>& actions, std::string& error)
+{
+    std::ifstream journalFile(runDirectory / JournalFileName, std::ios::binary);
+    if (!journalFile)
+    {
+        error = "No journal found in " + runDirectory.string();
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    std::string line;
+    while (std::getline(journalFile, line))
+    {
+        if (line.empty()) continue;
+
+        std::vector<std::string> fields = SplitFields(line);
+        entries.push_back({ fields[0], fields.size() > 1 ? fields[1] : "", fields.size() > 2 ? fields[2] : "" });
+    }
+    journalFile.close();
+
+    // A run that failed before its first backup has no manifest, which is fine
+    std::map<fs::path, std::string> originals;
+    std::string manifestError;
+    BackupStore::ReadManifest(runDirectory, originals, manifestError);
+
+    // The project folder may be renamed back, so the store and run folders are found again from the root
+    fs::path projectRoot = runDirectory.parent_path().parent_path();
+    fs::path storeName = runDirectory.parent_path().filename();
+    fs::path runName = runDirectory.filename();
+
+    std::set<fs::path> restoredFiles;
+    size_t failures = 0;
+
+    auto restore = [&](const fs::path& relativePath, const char* description)
+        {
+            auto original = originals.find(relativePath);
+            if (original == originals.end())
+            {
+                actions.push_back(std::string("Cannot restore ") + description + " " + (projectRoot / relativePath).string() + ", it was not backed up");
+                return;
+            }
+
+            std::string restoreError;
+            if (BackupStore::RestoreBlob(projectRoot / storeName, original->second, projectRoot / relativePath, restoreError))
+            {
+                actions.push_back(std::string("Restored ") + description + " " + (projectRoot / relativePath).string());
+            }
+            else
+            {
+                failures++;
+                error = restoreError;
+            }
+        };
+
+    for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry)
+    {
+        fs::path path = FromJournalPath(entry->path);
+        fs::path target = FromJournalPath(entry->target);
+
+        if (entry->operation == "rename-project")
+        {
+            fs::path oldRoot = projectRoot.parent_path() / path;
+            if (projectRoot.filename() != target || fs::exists(oldRoot)) continue;
+
+            std::error_code renameError;
+            if (RenamePathWithRetry(projectRoot, oldRoot, 10, std::chrono::seconds(1), renameError))
+            {
+                actions.push_back("Renamed project folder back to " + oldRoot.string());
+                projectRoot = oldRoot;
+            }
+            else
+            {
+                error = "Could not rename " + projectRoot.string() + " back to " + oldRoot.string() + ": " + renameError.message();
+                return false;
+            }
+        }
+        else if (entry->operation == "rename")
+        {
+            fs::path from = projectRoot / path;
+            fs::path to = projectRoot / target;
+
+            // Only undo renames that actually happened before the run stopped
+            if (!fs::exists(to) || fs::exists(from)) continue;
+
+            std::error_code renameError;
+            if (RenamePath(to, from, renameError))
+            {
+                actions.push_back("Renamed " + to.string() + " back to " + from.string());
+            }
+            else
+            {
+                failures++;
+                error = "Could not rename " + to.string() + " back to " + from.string() + ": " + renameError.message();
+            }
+        }
+        else if (entry->operation == "edit" || entry->operation == "delete")
+        {
+            // An interrupted atomic write leaves its temporary file behind
+            fs::path tempPath = projectRoot / path;
+            tempPath += AtomicWriteSuffix;
+            std::error_code ignored;
+            fs::remove(tempPath, ignored);
+
+            if (restoredFiles.insert(path).second)
+            {
+                restore(path, entry->operation == "edit" ? "file" : "deleted");
+            }
+        }
+    }
+
+    // Record the rollback in the journal, which now lives under the restored project root
+    std::ofstream rolledBack(projectRoot / storeName / runName / JournalFileName, std::ios::binary | std::ios::app);
+    rolledBack << "rollback\n";
+
+    // An undone run is never resumed
+    ProgressLedger::MarkRolledBack(projectRoot / storeName / runName);
+
+    return failures == 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Platform.h"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Write-ahead journal of one rename run, kept next to the backup manifest in the run folder.
+// Every edit, rename and deletion is recorded and flushed to disk before it is made, so after a crash,
+// a power loss, a full disk or a failed step the run can be undone in reverse order with --rollback.
+// Original file contents come from the run's backup manifest.
+class Journal
+{
+public:
+    Journal(const std::filesystem::path& projectRoot, const std::filesystem::path& runDirectory);
+
+    // Record an operation about to be made. Returns false if the journal could not be written,
+    // in which case the operation must not go ahead. Edits come in batches, so they are only on disk
+    // once Sync has returned; the other operations are flushed to disk before they return.
+    bool RecordEdit(const std::filesystem::path& filePath);
+    bool Sync();
+    bool RecordRename(const std::filesystem::path& from, const std::filesystem::path& to);
+    bool RecordDelete(const std::filesystem::path& path);
+
+    // The project folder itself is renamed last, and is recorded by folder name
+    bool RecordProjectRename(const std::string& oldFolderName, const std::string& newFolderName);
+
+    // Mark every operation of the run as issued and close the journal, so nothing inside
+    // the project is held open when the project folder is renamed last
+    void Commit();
+
+    // Undo every journaled operation of a run, newest first. Each undone step is described in `actions`.
+    static bool Rollback(const std::filesystem::path& runDirectory, std::vector<std::string>& actions, std::string& error);
+
+    static constexpr const char* JournalFileName = "journal.txt";
+
+private:
+    bool Append(const std::string& operation, const std::filesystem::path& path, const std::filesystem::path& target, bool sync);
+    bool AppendLine(const std::string& line, bool sync);
+
+    std::filesystem::path projectRoot;
+    std::mutex mutex;
+    AppendFile file;
+};
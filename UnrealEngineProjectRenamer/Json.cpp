@@ -0,0 +1,333 @@
+#include "Json.h"
+#include <cstdint>
+
+namespace
+{
+    // Deeper documents than any descriptor are rejected instead of exhausting the stack
+    constexpr int MaxDepth = 256;
+
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(std::string_view document)
+            : document(document)
+        {
+        }
+
+        bool ParseDocument(JsonValue& root, std::string& error)
+        {
+            // Files saved by some editors start with a UTF-8 byte order mark
+            if (document.substr(0, 3) == "\xEF\xBB\xBF") position = 3;
+
+            if (!ParseValue(root, 0))
+            {
+                error = message;
+                return false;
+            }
+            SkipWhitespace();
+            if (position != document.size())
+            {
+                Fail("unexpected text after the document");
+                error = message;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        bool Fail(const std::string& what)
+        {
+            // Report the line and column, which is what people look for in a hand-edited file
+            size_t line = 1;
+            size_t column = 1;
+            for (size_t i = 0; i < position && i < document.size(); ++i)
+            {
+                if (document[i] == '\n')
+                {
+                    ++line;
+                    column = 1;
+                }
+                else
+                {
+                    ++column;
+                }
+            }
+            message = what + " at line " + std::to_string(line) + ", column " + std::to_string(column);
+            return false;
+        }
+
+        void SkipWhitespace()
+        {
+            while (position < document.size())
+            {
+                char c = document[position];
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+                ++position;
+            }
+        }
+
+        bool Consume(std::string_view literal)
+        {
+            if (document.substr(position, literal.size()) != literal) return false;
+            position += literal.size();
+            return true;
+        }
+
+        bool ParseValue(JsonValue& value, int depth)
+        {
+            if (depth > MaxDepth) return Fail("nested too deeply");
+
+            SkipWhitespace();
+            if (position >= document.size()) return Fail("unexpected end of the document");
+
+            value.offset = position;
+            bool parsed = false;
+            char c = document[position];
+            if (c == '{')
+            {
+                value.type = JsonValue::Type::Object;
+                parsed = ParseObject(value, depth);
+            }
+            else if (c == '[')
+            {
+                value.type = JsonValue::Type::Array;
+                parsed = ParseArray(value, depth);
+            }
+            else if (c == '"')
+            {
+                value.type = JsonValue::Type::String;
+                parsed = ParseString(value.text);
+            }
+            else if (c == '-' || (c >= '0' && c <= '9'))
+            {
+                value.type = JsonValue::Type::Number;
+                parsed = ParseNumber(value.text);
+            }
+            else if (Consume("true") || Consume("false"))
+            {
+                value.type = JsonValue::Type::Boolean;
+                value.text = document.substr(value.offset, position - value.offset);
+                parsed = true;
+            }
+            else if (Consume("null"))
+            {
+                value.type = JsonValue::Type::Null;
+                parsed = true;
+            }
+            else
+            {
+                return Fail("unexpected character");
+            }
+
+            value.length = position - value.offset;
+            return parsed;
+        }
+
+        bool ParseObject(JsonValue& value, int depth)
+        {
+            ++position;
+            SkipWhitespace();
+            if (Consume("}")) return true;
+
+            while (true)
+            {
+                SkipWhitespace();
+                std::string key;
+                if (position >= document.size() || document[position] != '"') return Fail("expected a member name");
+                if (!ParseString(key)) return false;
+
+                SkipWhitespace();
+                if (!Consume(":")) return Fail("expected ':'");
+
+                value.members.emplace_back(std::move(key), JsonValue());
+                if (!ParseValue(value.members.back().second, depth + 1)) return false;
+
+                SkipWhitespace();
+                if (Consume("}")) return true;
+                if (!Consume(",")) return Fail("expected ',' or '}'");
+            }
+        }
+
+        bool ParseArray(JsonValue& value, int depth)
+        {
+            ++position;
+            SkipWhitespace();
+            if (Consume("]")) return true;
+
+            while (true)
+            {
+                value.items.emplace_back();
+                if (!ParseValue(value.items.back(), depth + 1)) return false;
+
+                SkipWhitespace();
+                if (Consume("]")) return true;
+                if (!Consume(",")) return Fail("expected ',' or ']'");
+            }
+        }
+
+        bool ParseNumber(std::string& text)
+        {
+            size_t start = position;
+            Consume("-");
+            auto skipDigits = [this]()
+                {
+                    size_t first = position;
+                    while (position < document.size() && document[position] >= '0' && document[position] <= '9') ++position;
+                    return position > first;
+                };
+
+            if (!skipDigits()) return Fail("invalid number");
+            if (Consume(".") && !skipDigits()) return Fail("invalid number");
+            if (position < document.size() && (document[position] == 'e' || document[position] == 'E'))
+            {
+                ++position;
+                if (!Consume("+")) Consume("-");
+                if (!skipDigits()) return Fail("invalid number");
+            }
+            text = document.substr(start, position - start);
+            return true;
+        }
+
+        bool ParseHex4(uint32_t& codePoint)
+        {
+            if (position + 4 > document.size()) return Fail("invalid escape");
+
+            codePoint = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                char c = document[position++];
+                codePoint <<= 4;
+                if (c >= '0' && c <= '9') codePoint |= c - '0';
+                else if (c >= 'a' && c <= 'f') codePoint |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') codePoint |= c - 'A' + 10;
+                else return Fail("invalid escape");
+            }
+            return true;
+        }
+
+        static void AppendUtf8(std::string& text, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                text += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                text += static_cast<char>(0xC0 | (codePoint >> 6));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                text += static_cast<char>(0xE0 | (codePoint >> 12));
+                text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                text += static_cast<char>(0xF0 | (codePoint >> 18));
+                text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        bool ParseString(std::string& text)
+        {
+            ++position;
+            while (position < document.size())
+            {
+                char c = document[position++];
+                if (c == '"') return true;
+                if (static_cast<unsigned char>(c) < 0x20) return Fail("control character in a string");
+                if (c != '\\')
+                {
+                    text += c;
+                    continue;
+                }
+
+                if (position >= document.size()) break;
+                char escape = document[position++];
+                switch (escape)
+                {
+                case '"': text += '"'; break;
+                case '\\': text += '\\'; break;
+                case '/': text += '/'; break;
+                case 'b': text += '\b'; break;
+                case 'f': text += '\f'; break;
+                case 'n': text += '\n'; break;
+                case 'r': text += '\r'; break;
+                case 't': text += '\t'; break;
+                case 'u':
+                {
+                    uint32_t codePoint = 0;
+                    if (!ParseHex4(codePoint)) return false;
+
+                    // Characters outside the basic plane are written as a surrogate pair
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && Consume("\\u"))
+                    {
+                        uint32_t low = 0;
+                        if (!ParseHex4(low)) return false;
+                        if (low < 0xDC00 || low >= 0xE000) return Fail("invalid surrogate pair");
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(text, codePoint);
+                    break;
+                }
+                default:
+                    return Fail("invalid escape");
+                }
+            }
+            return Fail("unterminated string");
+        }
+
+        std::string_view document;
+        size_t position = 0;
+        std::string message;
+    };
+}
+
+const JsonValue* JsonValue::Find(std::string_view key) const
+{
+    for (const auto& [name, value] : members)
+    {
+        if (name == key) return &value;
+    }
+    return nullptr;
+}
+
+bool ParseJson(std::string_view document, JsonValue& root, std::string& error)
+{
+    root = JsonValue();
+    return JsonParser(document).ParseDocument(root, error);
+}
+
+std::string QuoteJson(std::string_view text)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"': quoted += "\\\""; break;
+        case '\\': quoted += "\\\\"; break;
+        case '\n': quoted += "\\n"; break;
+        case '\r': quoted += "\\r"; break;
+        case '\t': quoted += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                quoted += "\\u00";
+                quoted += hexDigits[(c >> 4) & 0xF];
+                quoted += hexDigits[c & 0xF];
+            }
+            else
+            {
+                quoted += c;
+            }
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
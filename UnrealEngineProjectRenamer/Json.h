@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// A parsed JSON value that remembers where it was read from. Descriptor files are edited by
+// replacing single values at these offsets, so the rest of the file keeps its formatting byte for byte.
+struct JsonValue
+{
+    enum class Type
+    {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    Type type = Type::Null;
+    std::string text;                                       // Decoded string, or the literal of a number or boolean
+    std::vector<JsonValue> items;                           // Array items
+    std::vector<std::pair<std::string, JsonValue>> members; // Object members in file order
+    size_t offset = 0;                                      // Where the value starts in the document, quotes included
+    size_t length = 0;
+
+    bool IsString() const { return type == Type::String; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    // The first member with this key, or nullptr
+    const JsonValue* Find(std::string_view key) const;
+};
+
+// Parse a whole JSON document. A leading UTF-8 byte order mark is skipped.
+// On failure `error` describes the problem and where it is.
+bool ParseJson(std::string_view document, JsonValue& root, std::string& error);
+
+// The JSON string literal for a text, quotes included
+std::string QuoteJson(std::string_view text);
@@ -0,0 +1,275 @@
+#include "Logger.h"
+#include "globals.h"
+#include "Json.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    struct Batch
+    {
+        std::atomic<Batch*> next{ nullptr };
+        std::vector<LogLine> lines;
+    };
+
+    // Queue of many producers and one consumer. A producer swaps its batch in as the head and then links
+    // the previous head to it, so it never waits for another thread. The logger thread follows the links
+    // from the tail, starting at a stub that is never deleted.
+    Batch stub;
+    std::atomic<Batch*> head{ &stub };
+    Batch* tail = &stub;
+
+    // Batches queued and batches printed. The logger thread sleeps on the first, FlushLog on the second.
+    std::atomic<uint64_t> pushed{ 0 };
+    std::atomic<uint64_t> printed{ 0 };
+
+    // Threads waiting in FlushLog. While there are any the logger thread reports every batch it prints,
+    // so a flush does not wait for other threads to stop logging.
+    std::atomic<int> flushWaiters{ 0 };
+
+    std::thread loggerThread;
+    bool isRunning = false;
+
+    LogLevel consoleLevel = LogLevel::Info;
+    std::ofstream jsonLog;
+    std::chrono::steady_clock::time_point logStart = std::chrono::steady_clock::now();
+
+    // Without the logger thread lines are printed by the caller, one block at a time
+    std::mutex directMutex;
+
+    // What the console was last left at, so the colour and stream only change when a line needs it
+    ConsoleColour currentColour = COLOUR_WHITE;
+    std::ostream* currentStream = &std::cout;
+
+    const char* LevelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Verbose: return "verbose";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Error: return "error";
+        }
+        return "info";
+    }
+
+    void PrintLine(const LogLine& line)
+    {
+        size_t textStart = line.message.find_first_not_of('\n');
+        if (textStart == std::string::npos) textStart = line.message.size();
+
+        if (line.level >= consoleLevel)
+        {
+            std::ostream* stream = line.level == LogLevel::Error ? &std::cerr : &std::cout;
+            if (stream != currentStream)
+            {
+                currentStream->flush();
+                currentStream = stream;
+            }
+            if (line.colour != currentColour)
+            {
+                SetConsoleColour(line.colour);
+                currentColour = line.colour;
+            }
+
+            // Keep the leading blank lines and tag the text after them
+            std::ostream& output = *stream;
+            output.write(line.message.data(), textStart);
+            if (!line.project.empty())
+            {
+                output << '[' << line.project << "] ";
+            }
+            output.write(line.message.data() + textStart, line.message.size() - textStart) << '\n';
+        }
+
+        if (jsonLog.is_open())
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - logStart;
+            jsonLog << "{\"time\":" << std::fixed << std::setprecision(3) << elapsed.count() << ",\"level\":\"" << LevelName(line.level) << '"';
+            if (!line.project.empty())
+            {
+                jsonLog << ",\"project\":" << QuoteJson(line.project);
+            }
+            jsonLog << ",\"message\":" << QuoteJson(std::string_view(line.message).substr(textStart)) << "}\n";
+        }
+    }
+
+    // Leave the console as the rest of the program expects it once the queue runs dry
+    void EndOfBurst()
+    {
+        currentStream->flush();
+        if (currentColour != COLOUR_WHITE)
+        {
+            SetConsoleColour(COLOUR_WHITE);
+            currentColour = COLOUR_WHITE;
+        }
+        if (jsonLog.is_open())
+        {
+            jsonLog.flush();
+        }
+    }
+
+    // Take the lines of the oldest batch. Returns false if the queue is empty, or a producer has
+    // swapped in its batch but not linked it yet.
+    bool Pop(std::vector<LogLine>& lines)
+    {
+        Batch* first = tail;
+        Batch* next = first->next.load(std::memory_order_acquire);
+        if (next == nullptr) return false;
+
+        // The batch taken becomes the new stub, its lines are moved out
+        lines = std::move(next->lines);
+        tail = next;
+        if (first != &stub)
+        {
+            delete first;
+        }
+        return true;
+    }
+
+    // Flush what was printed so far and wake the threads in FlushLog
+    void ReportPrinted(uint64_t done)
+    {
+        EndOfBurst();
+        printed.store(done, std::memory_order_release);
+        printed.notify_all();
+    }
+
+    void Drain()
+    {
+        std::vector<LogLine> lines;
+        uint64_t done = 0;
+        while (true)
+        {
+            uint64_t available = pushed.load(std::memory_order_acquire);
+            if (done == available)
+            {
+                ReportPrinted(done);
+                pushed.wait(available, std::memory_order_acquire);
+                continue;
+            }
+
+            if (!Pop(lines))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for (const auto& line : lines)
+            {
+                PrintLine(line);
+            }
+            done++;
+
+            // SubmitLog never queues an empty batch, so this is the last one, pushed by StopLogger.
+            // It stays as the tail for StopLogger to delete.
+            if (lines.empty())
+            {
+                ReportPrinted(done);
+                return;
+            }
+            if (flushWaiters.load() != 0)
+            {
+                ReportPrinted(done);
+            }
+        }
+    }
+
+    void Push(std::vector<LogLine>&& lines)
+    {
+        Batch* batch = new Batch;
+        batch->lines = std::move(lines);
+        Batch* previous = head.exchange(batch, std::memory_order_acq_rel);
+        previous->next.store(batch, std::memory_order_release);
+        pushed.fetch_add(1, std::memory_order_release);
+        pushed.notify_one();
+    }
+}
+
+bool StartLogger(LogLevel level, const std::filesystem::path& jsonFile, std::string& error)
+{
+    consoleLevel = level;
+    if (!jsonFile.empty())
+    {
+        jsonLog.open(jsonFile, std::ios::binary | std::ios::trunc);
+        if (!jsonLog)
+        {
+            error = "Could not create " + jsonFile.string();
+            return false;
+        }
+    }
+
+    logStart = std::chrono::steady_clock::now();
+    loggerThread = std::thread(Drain);
+    isRunning = true;
+    return true;
+}
+
+void StopLogger()
+{
+    if (!isRunning) return;
+
+    // The logger thread prints every batch queued before this empty one and exits when it takes it
+    Push({});
+    loggerThread.join();
+    isRunning = false;
+
+    if (tail != &stub)
+    {
+        delete tail;
+        tail = &stub;
+        stub.next.store(nullptr, std::memory_order_relaxed);
+        head.store(&stub, std::memory_order_relaxed);
+    }
+    jsonLog.close();
+}
+
+void FlushLog()
+{
+    if (!isRunning) return;
+
+    // Registered before the target is taken, so the batch that reaches it is reported
+    flushWaiters.fetch_add(1);
+    uint64_t target = pushed.load(std::memory_order_acquire);
+    uint64_t current = printed.load(std::memory_order_acquire);
+    while (current < target)
+    {
+        printed.wait(current, std::memory_order_acquire);
+        current = printed.load(std::memory_order_acquire);
+    }
+    flushWaiters.fetch_sub(1);
+}
+
+bool IsLogged(LogLevel level)
+{
+    return level >= consoleLevel || jsonLog.is_open();
+}
+
+void SubmitLog(std::vector<LogLine>&& lines)
+{
+    if (lines.empty()) return;
+
+    if (isRunning)
+    {
+        Push(std::move(lines));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(directMutex);
+    for (const auto& line : lines)
+    {
+        PrintLine(line);
+    }
+    EndOfBurst();
+}
+
+LogLevel LevelOfColour(ConsoleColour colour)
+{
+    if (colour == COLOUR_RED) return LogLevel::Error;
+    if (colour == COLOUR_ORANGE) return LogLevel::Warning;
+    return LogLevel::Info;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Platform.h"
+
+// Console output of a rename. Workers queue their lines without taking a lock and a logger thread
+// prints them, so file operations never wait for the terminal, which on Windows consoles is slower
+// than rewriting a small file. Before StartLogger, and in tools that never call it, lines are
+// printed by the thread that logs them.
+
+enum class LogLevel
+{
+    Verbose,
+    Info,
+    Warning,
+    Error
+};
+
+struct LogLine
+{
+    LogLevel level;
+    ConsoleColour colour;
+
+    // The project the line is about when several are renamed at once, shown in front of the text
+    std::string project;
+
+    // Leading line breaks print blank lines before the text, as in the rest of the console output
+    std::string message;
+};
+
+// Start the logger thread. Lines below `consoleLevel` are not printed, and with `jsonFile` set
+// every line is also written there as one JSON object per line. Returns false with `error` set
+// if the JSON file could not be created.
+bool StartLogger(LogLevel consoleLevel, const std::filesystem::path& jsonFile, std::string& error);
+
+// Print everything still queued and stop the logger thread
+void StopLogger();
+
+// Wait until every line queued so far is on the console, before prompting or printing directly
+void FlushLog();
+
+// Whether a line of this level goes anywhere, so callers can skip formatting it
+bool IsLogged(LogLevel level);
+
+// Queue lines that are printed together, never interleaved with the lines of other threads
+void SubmitLog(std::vector<LogLine>&& lines);
+
+// The level of a line shown in this colour: red lines are errors and orange lines warnings
+LogLevel LevelOfColour(ConsoleColour colour);
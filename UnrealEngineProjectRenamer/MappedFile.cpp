@@ -0,0 +1,146 @@
+#include "MappedFile.h"
+#include "Trace.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(isOpen, other.isOpen);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    isOpen = true;
+
+    // Empty files cannot be mapped, but are still valid to scan
+    if (fileSize.QuadPart == 0)
+    {
+        TraceAdd(TraceCounter::SystemCalls, 2);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        Close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        Close();
+        return false;
+    }
+
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    TraceAdd(TraceCounter::SystemCalls, 4);
+    TraceAdd(TraceCounter::BytesRead, size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data != nullptr) UnmapViewOfFile(data);
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    if (fileHandle != nullptr) CloseHandle(fileHandle);
+
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    isOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+
+    struct stat fileStat;
+    if (::fstat(file, &fileStat) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    isOpen = true;
+    if (fileStat.st_size == 0)
+    {
+        ::close(file);
+        TraceAdd(TraceCounter::SystemCalls, 3);
+        return true;
+    }
+
+    void* view = ::mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED)
+    {
+        isOpen = false;
+        return false;
+    }
+
+    ::madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(fileStat.st_size);
+    TraceAdd(TraceCounter::SystemCalls, 5);
+    TraceAdd(TraceCounter::BytesRead, size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data != nullptr) ::munmap(const_cast<char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+    isOpen = false;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. Lets a file be scanned in place without
+// copying it into the heap; the mapping must be closed before the file is rewritten.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path) { Open(path); }
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map the file, replacing any previous mapping. Returns false if it cannot be opened.
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return isOpen; }
+    size_t Size() const { return size; }
+    std::string_view View() const { return std::string_view(data, size); }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool isOpen = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
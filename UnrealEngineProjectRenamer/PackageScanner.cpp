@@ -0,0 +1,479 @@
+#include "PackageScanner.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // First four bytes of every package, and what they read as when the package is byte-swapped
+    constexpr uint32_t PackageFileTag = 0x9E2A83C1;
+    constexpr uint32_t PackageFileTagSwapped = 0xC1832A9E;
+
+    // Legacy file versions this reader knows the summary layout of, UE 4.0 to UE 5
+    constexpr int32_t OldestLegacyFileVersion = -2;
+    constexpr int32_t NewestLegacyFileVersion = -8;
+
+    // Object versions that change the header layout
+    constexpr int32_t VersionSerializeTextInPackages = 459;
+    constexpr int32_t VersionNameHashesSerialized = 504;
+    constexpr int32_t VersionPackageSummaryLocalizationId = 516;
+    constexpr int32_t VersionNonOuterPackageImport = 520;
+    constexpr int32_t VersionUE5OptionalResources = 1003;
+    constexpr int32_t VersionUE5SoftObjectPathList = 1008;
+    constexpr int32_t VersionUE5PackageSavedHash = 1016;
+
+    constexpr uint32_t PackageFlagFilterEditorOnly = 0x80000000;
+
+    // Names are at most 1024 characters; anything far longer means the header is not what it seems
+    constexpr int64_t MaxStringLength = 65536;
+    constexpr int32_t MaxCustomVersions = 65536;
+
+    // Packages are scanned in chunks, one pool task per chunk
+    constexpr size_t PackagesPerTask = 64;
+
+    // Bounds checked little-endian reads from a mapped package. A read past the end marks the reader
+    // as failed and returns zero, so a damaged header is detected once after a sequence of reads.
+    class HeaderReader
+    {
+    public:
+        explicit HeaderReader(std::string_view data) : data(data) {}
+
+        bool Failed() const { return failed; }
+        size_t Size() const { return data.size(); }
+
+        void Seek(int64_t offset)
+        {
+            if (offset < 0 || static_cast<uint64_t>(offset) > data.size()) failed = true;
+            else position = static_cast<size_t>(offset);
+        }
+
+        void Skip(size_t length)
+        {
+            if (failed || data.size() - position < length) failed = true;
+            else position += length;
+        }
+
+        uint32_t ReadUInt32()
+        {
+            if (failed || data.size() - position < 4)
+            {
+                failed = true;
+                return 0;
+            }
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data() + position);
+            position += 4;
+            return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        }
+
+        int32_t ReadInt32()
+        {
+            return static_cast<int32_t>(ReadUInt32());
+        }
+
+        // FString: a length including the terminating zero, positive for Latin-1 and negative for UTF-16
+        std::string ReadString()
+        {
+            int64_t length = ReadInt32();
+            if (failed || length == 0) return std::string();
+
+            if (length > 0)
+            {
+                if (length > MaxStringLength || data.size() - position < static_cast<size_t>(length))
+                {
+                    failed = true;
+                    return std::string();
+                }
+                std::string text = Latin1ToUtf8(data.substr(position, static_cast<size_t>(length) - 1));
+                position += static_cast<size_t>(length);
+                return text;
+            }
+
+            int64_t units = -length;
+            if (units > MaxStringLength || data.size() - position < static_cast<size_t>(units) * 2)
+            {
+                failed = true;
+                return std::string();
+            }
+            std::string text = Utf16ToUtf8(data.substr(position, static_cast<size_t>(units - 1) * 2));
+            position += static_cast<size_t>(units) * 2;
+            return text;
+        }
+
+    private:
+        static void AppendUtf8(std::string& text, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                text += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                text += static_cast<char>(0xC0 | (codePoint >> 6));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                text += static_cast<char>(0xE0 | (codePoint >> 12));
+                text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                text += static_cast<char>(0xF0 | (codePoint >> 18));
+                text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        static std::string Latin1ToUtf8(std::string_view bytes)
+        {
+            std::string text;
+            text.reserve(bytes.size());
+            for (char c : bytes)
+            {
+                AppendUtf8(text, static_cast<unsigned char>(c));
+            }
+            return text;
+        }
+
+        static std::string Utf16ToUtf8(std::string_view bytes)
+        {
+            std::string text;
+            text.reserve(bytes.size() / 2);
+            for (size_t i = 0; i + 1 < bytes.size(); i += 2)
+            {
+                uint32_t unit = static_cast<unsigned char>(bytes[i]) | (static_cast<unsigned char>(bytes[i + 1]) << 8);
+                if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < bytes.size())
+                {
+                    uint32_t low = static_cast<unsigned char>(bytes[i + 2]) | (static_cast<unsigned char>(bytes[i + 3]) << 8);
+                    if (low >= 0xDC00 && low < 0xE000)
+                    {
+                        AppendUtf8(text, 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00));
+                        i += 2;
+                        continue;
+                    }
+                }
+                AppendUtf8(text, unit);
+            }
+            return text;
+        }
+
+        std::string_view data;
+        size_t position = 0;
+        bool failed = false;
+    };
+
+    // The part of an import entry needed to build its path
+    struct Import
+    {
+        int32_t objectName;
+        int32_t objectNumber;
+        int32_t outer;
+    };
+
+    // An FName is a name table entry plus a number, which is appended as _<number - 1> when set
+    std::string NameText(const std::vector<std::string>& names, int32_t index, int32_t number)
+    {
+        std::string text = names[static_cast<size_t>(index)];
+        if (number > 0)
+        {
+            text += '_';
+            text += std::to_string(number - 1);
+        }
+        return text;
+    }
+}
+
+PackageScanner::PackageScanner(const std::vector<std::string>& oldModuleNames)
+{
+    for (const auto& moduleName : oldModuleNames)
+    {
+        scriptPackages.push_back("/Script/" + moduleName);
+    }
+}
+
+bool PackageScanner::IsOldScriptName(std::string_view name) const
+{
+    for (const auto& scriptPackage : scriptPackages)
+    {
+        // /Script/MyGame and /Script/MyGame.MyClass, but never /Script/MyGameCore
+        if (name.size() >= scriptPackage.size() && name.compare(0, scriptPackage.size(), scriptPackage) == 0
+            && (name.size() == scriptPackage.size() || name[scriptPackage.size()] == '.' || name[scriptPackage.size()] == ':'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+PackageScanner::Result PackageScanner::Scan(const fs::path& packagePath) const
+{
+    TraceSpan span("ScanPackage", "file");
+    span.SetDetail(packagePath);
+
+    Result result;
+    result.packagePath = packagePath;
+
+    MappedFile file(packagePath);
+    if (!file.IsOpen())
+    {
+        result.error = "the file could not be opened";
+        return result;
+    }
+    HeaderReader reader(file.View());
+
+    // Package file summary, up to the import table
+    uint32_t tag = reader.ReadUInt32();
+    if (tag != PackageFileTag)
+    {
+        result.error = tag == PackageFileTagSwapped ? "byte-swapped packages are not supported" : "it is not an Unreal package";
+        return result;
+    }
+
+    int32_t legacyFileVersion = reader.ReadInt32();
+    if (legacyFileVersion > OldestLegacyFileVersion || legacyFileVersion < NewestLegacyFileVersion)
+    {
+        result.error = "unsupported package file version " + std::to_string(legacyFileVersion);
+        return result;
+    }
+    if (legacyFileVersion != -4)
+    {
+        reader.Skip(4); // UE3 version
+    }
+    int32_t fileVersionUE4 = reader.ReadInt32();
+    int32_t fileVersionUE5 = legacyFileVersion <= -8 ? reader.ReadInt32() : 0;
+    int32_t fileVersionLicensee = reader.ReadInt32();
+
+    // From UE 5.4 the saved hash and the total header size come before the custom versions
+    bool hasSavedHash = fileVersionUE5 >= VersionUE5PackageSavedHash;
+    if (hasSavedHash)
+    {
+        reader.Skip(20); // Saved hash
+        reader.Skip(4); // Total header size
+    }
+
+    // Custom versions: tag and version pairs, then GUID, version and friendly name, then GUID and version
+    int32_t customVersionCount = reader.ReadInt32();
+    if (customVersionCount < 0 || customVersionCount > MaxCustomVersions)
+    {
+        result.error = "the package summary is damaged";
+        return result;
+    }
+    for (int32_t i = 0; i < customVersionCount && !reader.Failed(); ++i)
+    {
+        if (legacyFileVersion == -2)
+        {
+            reader.Skip(8);
+        }
+        else if (legacyFileVersion >= -5)
+        {
+            reader.Skip(20);
+            reader.ReadString();
+        }
+        else
+        {
+            reader.Skip(20);
+        }
+    }
+
+    if (!hasSavedHash)
+    {
+        reader.Skip(4); // Total header size
+    }
+    reader.ReadString(); // Package name
+    uint32_t packageFlags = reader.ReadUInt32();
+    int32_t nameCount = reader.ReadInt32();
+    int32_t nameOffset = reader.ReadInt32();
+
+    // Cooked packages saved without versions have the layout of an unknown engine, so only their names are read
+    bool isUnversioned = fileVersionUE4 == 0 && fileVersionUE5 == 0 && fileVersionLicensee == 0;
+    bool isFilterEditorOnly = (packageFlags & PackageFlagFilterEditorOnly) != 0;
+    int32_t importCount = 0;
+    int32_t importOffset = 0;
+    if (!isUnversioned)
+    {
+        if (fileVersionUE5 >= VersionUE5SoftObjectPathList) reader.Skip(8);
+        if (!isFilterEditorOnly && fileVersionUE4 >= VersionPackageSummaryLocalizationId) reader.ReadString();
+        if (fileVersionUE4 >= VersionSerializeTextInPackages) reader.Skip(8);
+        reader.Skip(8); // Export count and offset
+        importCount = reader.ReadInt32();
+        importOffset = reader.ReadInt32();
+    }
+
+    // Every name entry takes at least its four byte length
+    if (reader.Failed() || nameCount < 0 || static_cast<size_t>(nameCount) > reader.Size() / 4 || importCount < 0)
+    {
+        result.error = "the package summary is damaged";
+        return result;
+    }
+
+    // Name table
+    std::vector<std::string> names;
+    names.reserve(static_cast<size_t>(nameCount));
+    bool hasNameHashes = isUnversioned || fileVersionUE4 >= VersionNameHashesSerialized;
+    reader.Seek(nameOffset);
+    for (int32_t i = 0; i < nameCount && !reader.Failed(); ++i)
+    {
+        names.push_back(reader.ReadString());
+        if (hasNameHashes) reader.Skip(4);
+    }
+    if (reader.Failed())
+    {
+        result.error = "the name table is damaged";
+        return result;
+    }
+
+    // Most packages never name an old script package, and are done here
+    std::vector<bool> isOldName(names.size(), false);
+    bool namesOldPackage = false;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        isOldName[i] = IsOldScriptName(names[i]);
+        namesOldPackage = namesOldPackage || isOldName[i];
+    }
+    if (!namesOldPackage)
+    {
+        return result;
+    }
+
+    // Import table: class package, class name, outer, object name, then fields that depend on the version
+    std::vector<Import> imports;
+    if (importCount > 0)
+    {
+        size_t importSize = 28;
+        if (fileVersionUE4 >= VersionNonOuterPackageImport && !isFilterEditorOnly) importSize += 8;
+        if (fileVersionUE5 >= VersionUE5OptionalResources) importSize += 4;
+        if (static_cast<size_t>(importCount) > reader.Size() / importSize)
+        {
+            result.error = "the import table is damaged";
+            return result;
+        }
+
+        imports.reserve(static_cast<size_t>(importCount));
+        reader.Seek(importOffset);
+        for (int32_t i = 0; i < importCount && !reader.Failed(); ++i)
+        {
+            reader.Skip(16); // Class package and class name
+            Import entry;
+            entry.outer = reader.ReadInt32();
+            entry.objectName = reader.ReadInt32();
+            entry.objectNumber = reader.ReadInt32();
+            reader.Skip(importSize - 28);
+            imports.push_back(entry);
+
+            if (entry.objectName < 0 || entry.objectName >= nameCount)
+            {
+                result.error = "the import table is damaged";
+                return result;
+            }
+        }
+        if (reader.Failed())
+        {
+            result.error = "the import table is damaged";
+            return result;
+        }
+    }
+
+    // An import's path starts at the package it is imported from, its outermost import
+    std::vector<bool> isImportedPackage(names.size(), false);
+    std::vector<bool> hasImportedObjects(names.size(), false);
+    for (const auto& entry : imports)
+    {
+        std::vector<const Import*> chain = { &entry };
+        while (chain.back()->outer < 0 && chain.size() <= imports.size())
+        {
+            size_t outerIndex = static_cast<size_t>(-(static_cast<int64_t>(chain.back()->outer) + 1));
+            if (outerIndex >= imports.size()) break;
+            chain.push_back(&imports[outerIndex]);
+        }
+
+        const Import* package = chain.back();
+        if (package->outer != 0 || !isOldName[static_cast<size_t>(package->objectName)])
+        {
+            continue;
+        }
+        isImportedPackage[static_cast<size_t>(package->objectName)] = true;
+
+        // The package import itself is implied by the objects imported from it
+        if (chain.size() == 1) continue;
+        hasImportedObjects[static_cast<size_t>(package->objectName)] = true;
+
+        // /Script/<Module>.<Object>, then :<Subobject> for each level below
+        std::string path = NameText(names, package->objectName, package->objectNumber);
+        for (size_t level = chain.size() - 1; level-- > 0;)
+        {
+            path += level == chain.size() - 2 ? '.' : ':';
+            path += NameText(names, chain[level]->objectName, chain[level]->objectNumber);
+        }
+        result.imports.push_back(std::move(path));
+    }
+
+    // A package imported without any of its objects is still a dependency
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (isImportedPackage[i] && !hasImportedObjects[i])
+        {
+            result.imports.push_back(names[i]);
+        }
+    }
+
+    // Names the imports do not account for, such as soft object paths into an old script package
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (isOldName[i] && !isImportedPackage[i])
+        {
+            result.names.push_back(names[i]);
+        }
+    }
+    span.Add(TraceCounter::Matches, result.imports.size() + result.names.size());
+    return result;
+}
+
+std::vector<PackageScanner::Result> PackageScanner::ScanAll(const std::vector<fs::path>& packageFiles, ThreadPool& pool) const
+{
+    std::vector<Result> results(packageFiles.size());
+
+    TaskGroup group;
+    for (size_t first = 0; first < packageFiles.size(); first += PackagesPerTask)
+    {
+        pool.Submit(group, [this, &packageFiles, &results, first]()
+            {
+                size_t last = std::min(first + PackagesPerTask, packageFiles.size());
+                for (size_t i = first; i < last; ++i)
+                {
+                    results[i] = Scan(packageFiles[i]);
+                }
+            });
+    }
+    pool.Wait(group);
+
+    results.erase(std::remove_if(results.begin(), results.end(), [](const Result& result)
+        {
+            return result.imports.empty() && result.names.empty() && result.error.empty();
+        }), results.end());
+    return results;
+}
+
+std::vector<fs::path> PackageScanner::FindPackageFiles(const ProjectSnapshot& snapshot, const std::vector<fs::path>& contentDirectories)
+{
+    std::vector<fs::path> packageFiles;
+    for (const auto& contentDirectory : contentDirectories)
+    {
+        for (const auto& entry : snapshot.ListRecursive(contentDirectory))
+        {
+            fs::path extension = entry.path.extension();
+            if (!entry.isDirectory && (extension == ".uasset" || extension == ".umap"))
+            {
+                packageFiles.push_back(entry.path);
+            }
+        }
+    }
+
+    // Listing order differs between file systems; a stable order keeps the report reproducible
+    std::sort(packageFiles.begin(), packageFiles.end());
+    return packageFiles;
+}
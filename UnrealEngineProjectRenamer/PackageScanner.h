@@ -0,0 +1,50 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ProjectSnapshot.h"
+#include "ThreadPool.h"
+
+// Finds the references of .uasset and .umap packages to the script packages of renamed modules,
+// /Script/<Module>, which break unless redirects cover them. Only the package header is read: the
+// file summary, the name table and the import table, straight from a memory mapping. Export data is
+// never touched, so a scan only reads the first pages of each package and no package is copied
+// into the heap, however large the Content folder is.
+class PackageScanner
+{
+public:
+    // What one package references
+    struct Result
+    {
+        std::filesystem::path packagePath;
+
+        // Imported objects of an old script package, as /Script/<Module>.<Object>[:<Subobject>]
+        std::vector<std::string> imports;
+
+        // Names of the name table that refer to an old script package without being imported from it,
+        // such as soft object paths
+        std::vector<std::string> names;
+
+        // Why the header could not be read, if it could not
+        std::string error;
+    };
+
+    // `oldModuleNames` are the modules whose /Script/<Module> packages are looked for
+    explicit PackageScanner(const std::vector<std::string>& oldModuleNames);
+
+    // Read one package header
+    Result Scan(const std::filesystem::path& packagePath) const;
+
+    // Scan packages on the pool. Only packages with references or errors are returned, in the order given.
+    std::vector<Result> ScanAll(const std::vector<std::filesystem::path>& packageFiles, ThreadPool& pool) const;
+
+    // Every .uasset and .umap below the given Content folders, in a stable order
+    static std::vector<std::filesystem::path> FindPackageFiles(const ProjectSnapshot& snapshot, const std::vector<std::filesystem::path>& contentDirectories);
+
+private:
+    // Whether a name is an old script package or an object inside one
+    bool IsOldScriptName(std::string_view name) const;
+
+    std::vector<std::string> scriptPackages;
+};
@@ -0,0 +1,838 @@
+#include "Platform.h"
+#include "Trace.h"
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#include <psapi.h>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+
+void SetConsoleColour(ConsoleColour colour)
+{
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    SetConsoleTextAttribute(hConsole, colour);
+}
+
+void WaitForKeyPress()
+{
+    _getch();
+}
+
+std::tm ToLocalTime(std::time_t time)
+{
+    std::tm localTime{};
+    localtime_s(&localTime, &time);
+    return localTime;
+}
+
+bool RenamePath(const fs::path& from, const fs::path& to, std::error_code& error)
+{
+    if (MoveFileExW(from.wstring().c_str(), to.wstring().c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        error.clear();
+        return true;
+    }
+
+    error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+    return false;
+}
+
+bool WriteFileAtomically(const fs::path& path, std::string_view content, std::error_code& error)
+{
+    fs::path tempPath = path;
+    tempPath += AtomicWriteSuffix;
+
+    HANDLE file = CreateFileW(tempPath.wstring().c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+        return false;
+    }
+
+    bool written = true;
+    size_t offset = 0;
+    while (written && offset < content.size())
+    {
+        DWORD chunk = content.size() - offset > 0x40000000 ? 0x40000000 : static_cast<DWORD>(content.size() - offset);
+        DWORD bytesWritten = 0;
+        written = WriteFile(file, content.data() + offset, chunk, &bytesWritten, NULL) && bytesWritten == chunk;
+        offset += bytesWritten;
+    }
+    written = written && FlushFileBuffers(file);
+    TraceAdd(TraceCounter::SystemCalls, 4);
+    TraceAdd(TraceCounter::BytesWritten, offset);
+    if (!written)
+    {
+        error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+    }
+    CloseHandle(file);
+
+    if (written && MoveFileExW(tempPath.wstring().c_str(), path.wstring().c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        error.clear();
+        return true;
+    }
+
+    if (written)
+    {
+        error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+    }
+    DeleteFileW(tempPath.wstring().c_str());
+    return false;
+}
+
+bool AppendFile::Open(const fs::path& path)
+{
+    Close();
+    HANDLE file = CreateFileW(path.wstring().c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    handle = reinterpret_cast<std::intptr_t>(file);
+    return true;
+}
+
+bool AppendFile::Append(std::string_view text)
+{
+    if (handle == -1) return false;
+    size_t offset = 0;
+    while (offset < text.size())
+    {
+        DWORD chunk = text.size() - offset > 0x40000000 ? 0x40000000 : static_cast<DWORD>(text.size() - offset);
+        DWORD bytesWritten = 0;
+        if (!WriteFile(reinterpret_cast<HANDLE>(handle), text.data() + offset, chunk, &bytesWritten, NULL) || bytesWritten == 0) return false;
+        offset += bytesWritten;
+    }
+    TraceAdd(TraceCounter::SystemCalls, 1);
+    return true;
+}
+
+bool AppendFile::Sync()
+{
+    if (handle == -1) return false;
+    TraceAdd(TraceCounter::SystemCalls, 1);
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(handle)) != 0;
+}
+
+void AppendFile::Close()
+{
+    if (handle == -1) return;
+    CloseHandle(reinterpret_cast<HANDLE>(handle));
+    handle = -1;
+}
+
+bool ReadFileStamp(const fs::path& path, uint64_t& size, int64_t& modified)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    TraceAdd(TraceCounter::SystemCalls, 1);
+    if (!GetFileAttributesExW(path.wstring().c_str(), GetFileExInfoStandard, &data)) return false;
+    size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+
+    // file_time_type counts the same 100 ns intervals since 1601 as FILETIME
+    modified = static_cast<int64_t>((static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+bool ReadFileStamp(const fs::directory_entry& entry, uint64_t& size, int64_t& modified)
+{
+    std::error_code error;
+    size = entry.file_size(error);
+    if (error) return false;
+    fs::file_time_type writeTime = entry.last_write_time(error);
+    if (error) return false;
+    modified = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+bool IsAccessDenied(const std::error_code& error)
+{
+    return error.category() == std::system_category()
+        && (error.value() == ERROR_ACCESS_DENIED || error.value() == ERROR_SHARING_VIOLATION);
+}
+
+std::string ExecutableName(const std::string& name)
+{
+    return name + ".exe";
+}
+
+std::string EnvironmentVariable(const std::string& name)
+{
+    std::wstring wideName = fs::path(name).wstring();
+    DWORD size = GetEnvironmentVariableW(wideName.c_str(), NULL, 0);
+    if (size == 0) return std::string();
+
+    std::wstring value(size, L'\0');
+    size = GetEnvironmentVariableW(wideName.c_str(), value.data(), size);
+    value.resize(size);
+    return fs::path(value).string();
+}
+
+fs::path UserConfigDirectory()
+{
+    return EnvironmentVariable("APPDATA");
+}
+
+fs::path UserCacheDirectory()
+{
+    return EnvironmentVariable("LOCALAPPDATA");
+}
+
+fs::path SharedConfigDirectory()
+{
+    return EnvironmentVariable("ProgramData");
+}
+
+std::vector<std::pair<std::string, std::string>> ReadRegistryStrings(bool localMachine, const std::string& subKey)
+{
+    std::vector<std::pair<std::string, std::string>> values;
+
+    HKEY key;
+    if (RegOpenKeyExW(localMachine ? HKEY_LOCAL_MACHINE : HKEY_CURRENT_USER, fs::path(subKey).wstring().c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS)
+    {
+        return values;
+    }
+
+    // Value names are at most 16383 characters; longer data than a path is of no use here
+    std::wstring name(16384, L'\0');
+    std::wstring data(32768, L'\0');
+    for (DWORD index = 0; ; ++index)
+    {
+        DWORD nameLength = static_cast<DWORD>(name.size());
+        DWORD dataSize = static_cast<DWORD>(data.size() * sizeof(wchar_t));
+        DWORD type = 0;
+        LONG result = RegEnumValueW(key, index, name.data(), &nameLength, NULL, &type, reinterpret_cast<LPBYTE>(data.data()), &dataSize);
+        if (result == ERROR_NO_MORE_ITEMS) break;
+        if (result != ERROR_SUCCESS || type != REG_SZ) continue;
+
+        std::wstring value(data.data(), dataSize / sizeof(wchar_t));
+        while (!value.empty() && value.back() == L'\0') value.pop_back();
+        values.emplace_back(fs::path(name.substr(0, nameLength)).string(), fs::path(value).string());
+    }
+
+    RegCloseKey(key);
+    return values;
+}
+
+
+namespace
+{
+    // Quote an argument so CommandLineToArgvW, and with it every C runtime, reads it back unchanged
+    std::wstring QuoteArgument(const std::wstring& argument)
+    {
+        std::wstring quoted = L"\"";
+        size_t backslashes = 0;
+        for (wchar_t character : argument)
+        {
+            if (character == L'\\')
+            {
+                backslashes++;
+                continue;
+            }
+            // Backslashes only escape when a quote follows them
+            quoted.append(character == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+            backslashes = 0;
+            quoted += character;
+        }
+        quoted.append(backslashes * 2, L'\\');
+        quoted += L'"';
+        return quoted;
+    }
+}
+
+uint64_t PeakMemoryUsage()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+}
+
+struct ChildProcess::State
+{
+    HANDLE process = NULL;
+    HANDLE job = NULL;
+    HANDLE outputRead = NULL;
+    std::thread reader;
+    std::atomic<bool> readerDone{ false };
+};
+
+ChildProcess::ChildProcess()
+    : state(std::make_unique<State>())
+{
+}
+
+ChildProcess::~ChildProcess()
+{
+    Kill();
+    StopReader();
+    if (state->job) CloseHandle(state->job);
+}
+
+bool ChildProcess::Start(const std::string& program, const std::vector<std::string>& arguments, std::function<void(const std::string&)> onOutputLine, std::error_code& error)
+{
+    this->onOutputLine = std::move(onOutputLine);
+
+    SECURITY_ATTRIBUTES attributes{ sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE outputWrite = NULL;
+    if (!CreatePipe(&state->outputRead, &outputWrite, &attributes, 0))
+    {
+        error = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+        return false;
+    }
+    SetHandleInformation(state->outputRead, HANDLE_FLAG_INHERIT, 0);
+
+    std::wstring commandLine = QuoteArgument(fs::path(program).wstring());
+    for (const auto& argument : arguments)
+    {
+        commandLine += L' ';
+        commandLine += QuoteArgument(fs::path(argument).wstring());
+    }
+
+    STARTUPINFOW startupInfo{};
+    startupInfo.cb = sizeof(startupInfo);
+    startupInfo.dwFlags = STARTF_USESTDHANDLES;
+    startupInfo.hStdOutput = outputWrite;
+    startupInfo.hStdError = outputWrite;
+
+    PROCESS_INFORMATION processInfo{};
+    BOOL created = CreateProcessW(NULL, commandLine.data(), NULL, NULL, TRUE, CREATE_SUSPENDED | CREATE_NO_WINDOW, NULL, NULL, &startupInfo, &processInfo);
+    DWORD lastError = GetLastError();
+    CloseHandle(outputWrite);
+    if (!created)
+    {
+        error = std::error_code(static_cast<int>(lastError), std::system_category());
+        CloseHandle(state->outputRead);
+        state->outputRead = NULL;
+        return false;
+    }
+
+    // Everything the program starts joins its job, so the whole tree can be killed at once
+    state->job = CreateJobObjectW(NULL, NULL);
+    if (state->job)
+    {
+        AssignProcessToJobObject(state->job, processInfo.hProcess);
+    }
+    ResumeThread(processInfo.hThread);
+    CloseHandle(processInfo.hThread);
+
+    state->process = processInfo.hProcess;
+    state->reader = std::thread([this]() { ReadOutput(); });
+    error.clear();
+    return true;
+}
+
+void ChildProcess::ReadOutput()
+{
+    char buffer[4096];
+    DWORD bytesRead = 0;
+    while (ReadFile(state->outputRead, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead > 0)
+    {
+        DeliverOutput(buffer, bytesRead);
+    }
+    DeliverOutput(nullptr, 0);
+    state->readerDone = true;
+}
+
+bool ChildProcess::Wait(std::chrono::milliseconds timeout, int& exitCode)
+{
+    if (!state->process) return false;
+
+    DWORD milliseconds = timeout.count() >= INFINITE ? INFINITE - 1 : static_cast<DWORD>(timeout.count());
+    if (WaitForSingleObject(state->process, milliseconds) != WAIT_OBJECT_0)
+    {
+        return false;
+    }
+
+    DWORD code = 0;
+    GetExitCodeProcess(state->process, &code);
+    exitCode = static_cast<int>(code);
+    CloseHandle(state->process);
+    state->process = NULL;
+
+    StopReader();
+    return true;
+}
+
+void ChildProcess::Kill()
+{
+    if (!state->process) return;
+
+    if (!state->job || !TerminateJobObject(state->job, 1))
+    {
+        TerminateProcess(state->process, 1);
+    }
+    WaitForSingleObject(state->process, INFINITE);
+    CloseHandle(state->process);
+    state->process = NULL;
+
+    StopReader();
+}
+
+void ChildProcess::StopReader()
+{
+    if (!state->reader.joinable()) return;
+
+    // Processes the program left running can hold the pipe open, so a read still blocked
+    // half a second after the program exited is cancelled
+    for (int attempt = 0; attempt < 50 && !state->readerDone; ++attempt)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    while (!state->readerDone)
+    {
+        CancelSynchronousIo(state->reader.native_handle());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    state->reader.join();
+
+    CloseHandle(state->outputRead);
+    state->outputRead = NULL;
+}
+
+#else
+
+void SetConsoleColour(ConsoleColour colour)
+{
+    // Escapes would end up as garbage in redirected logs
+    static const bool isTerminal = isatty(STDOUT_FILENO) && isatty(STDERR_FILENO);
+    if (!isTerminal) return;
+
+    const char* escape = "\033[0m";
+    switch (colour)
+    {
+    case 6:  escape = "\033[33m"; break;  // Orange (dark yellow)
+    case 10: escape = "\033[92m"; break;  // Green
+    case 12: escape = "\033[91m"; break;  // Red
+    default: break;
+    }
+    std::cout << escape << std::flush;
+}
+
+void WaitForKeyPress()
+{
+    std::cout << std::flush;
+
+    termios original{};
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &original) != 0)
+    {
+        std::getchar();
+        return;
+    }
+
+    // Read one key without line buffering or echo, then put the terminal back
+    termios raw = original;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+    char key;
+    (void)read(STDIN_FILENO, &key, 1);
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &original);
+}
+
+std::tm ToLocalTime(std::time_t time)
+{
+    std::tm localTime{};
+    localtime_r(&time, &localTime);
+    return localTime;
+}
+
+bool RenamePath(const fs::path& from, const fs::path& to, std::error_code& error)
+{
+    if (std::rename(from.c_str(), to.c_str()) == 0)
+    {
+        error.clear();
+        return true;
+    }
+
+    error = std::error_code(errno, std::generic_category());
+    return false;
+}
+
+bool WriteFileAtomically(const fs::path& path, std::string_view content, std::error_code& error)
+{
+    fs::path tempPath = path;
+    tempPath += AtomicWriteSuffix;
+
+    // Keep the permissions of the file being replaced
+    struct stat original;
+    mode_t mode = stat(path.c_str(), &original) == 0 ? (original.st_mode & 07777) : 0644;
+
+    int file = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+    if (file < 0)
+    {
+        error = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    fchmod(file, mode);
+
+    size_t offset = 0;
+    while (offset < content.size())
+    {
+        ssize_t written = write(file, content.data() + offset, content.size() - offset);
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+
+    bool flushed = offset == content.size() && fsync(file) == 0;
+    TraceAdd(TraceCounter::SystemCalls, 6);
+    TraceAdd(TraceCounter::BytesWritten, offset);
+    if (!flushed)
+    {
+        error = std::error_code(errno, std::generic_category());
+    }
+    close(file);
+
+    if (flushed && std::rename(tempPath.c_str(), path.c_str()) == 0)
+    {
+        error.clear();
+        return true;
+    }
+
+    if (flushed)
+    {
+        error = std::error_code(errno, std::generic_category());
+    }
+    unlink(tempPath.c_str());
+    return false;
+}
+
+bool AppendFile::Open(const fs::path& path)
+{
+    Close();
+    int file = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (file < 0) return false;
+    handle = file;
+    return true;
+}
+
+bool AppendFile::Append(std::string_view text)
+{
+    if (handle == -1) return false;
+    size_t offset = 0;
+    while (offset < text.size())
+    {
+        ssize_t written = write(static_cast<int>(handle), text.data() + offset, text.size() - offset);
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    TraceAdd(TraceCounter::SystemCalls, 1);
+    return true;
+}
+
+bool AppendFile::Sync()
+{
+    if (handle == -1) return false;
+    TraceAdd(TraceCounter::SystemCalls, 1);
+    return fsync(static_cast<int>(handle)) == 0;
+}
+
+void AppendFile::Close()
+{
+    if (handle == -1) return;
+    close(static_cast<int>(handle));
+    handle = -1;
+}
+
+bool ReadFileStamp(const fs::path& path, uint64_t& size, int64_t& modified)
+{
+    struct stat status;
+    TraceAdd(TraceCounter::SystemCalls, 1);
+    if (stat(path.c_str(), &status) != 0) return false;
+    size = static_cast<uint64_t>(status.st_size);
+
+#ifdef __APPLE__
+    const timespec& writeTime = status.st_mtimespec;
+#else
+    const timespec& writeTime = status.st_mtim;
+#endif
+    auto sinceEpoch = std::chrono::sys_time<std::chrono::nanoseconds>(std::chrono::seconds(writeTime.tv_sec) + std::chrono::nanoseconds(writeTime.tv_nsec));
+    fs::file_time_type fileTime = std::chrono::time_point_cast<fs::file_time_type::duration>(std::chrono::file_clock::from_sys(sinceEpoch));
+    modified = static_cast<int64_t>(fileTime.time_since_epoch().count());
+    return true;
+}
+
+bool ReadFileStamp(const fs::directory_entry& entry, uint64_t& size, int64_t& modified)
+{
+    return ReadFileStamp(entry.path(), size, modified);
+}
+
+bool IsAccessDenied(const std::error_code& error)
+{
+    return error == std::errc::permission_denied
+        || error == std::errc::operation_not_permitted
+        || error == std::errc::device_or_resource_busy
+        || error == std::errc::text_file_busy;
+}
+
+std::string ExecutableName(const std::string& name)
+{
+    return name;
+}
+
+std::string EnvironmentVariable(const std::string& name)
+{
+    const char* value = std::getenv(name.c_str());
+    return value ? std::string(value) : std::string();
+}
+
+namespace
+{
+    // An XDG base directory, or its default below the home folder
+    fs::path BaseDirectory(const char* variable, const char* homeFallback)
+    {
+        std::string directory = EnvironmentVariable(variable);
+        if (!directory.empty()) return directory;
+        return fs::path(EnvironmentVariable("HOME")) / homeFallback;
+    }
+}
+
+fs::path UserConfigDirectory()
+{
+#ifdef __APPLE__
+    return fs::path(EnvironmentVariable("HOME")) / "Library" / "Application Support";
+#else
+    return BaseDirectory("XDG_CONFIG_HOME", ".config");
+#endif
+}
+
+fs::path UserCacheDirectory()
+{
+#ifdef __APPLE__
+    return fs::path(EnvironmentVariable("HOME")) / "Library" / "Caches";
+#else
+    return BaseDirectory("XDG_CACHE_HOME", ".cache");
+#endif
+}
+
+fs::path SharedConfigDirectory()
+{
+    return UserConfigDirectory();
+}
+
+std::vector<std::pair<std::string, std::string>> ReadRegistryStrings(bool, const std::string&)
+{
+    return {};
+}
+
+
+uint64_t PeakMemoryUsage()
+{
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+struct ChildProcess::State
+{
+    pid_t pid = -1;
+    int outputRead = -1;
+    std::thread reader;
+    std::atomic<bool> stopReading{ false };
+};
+
+ChildProcess::ChildProcess()
+    : state(std::make_unique<State>())
+{
+}
+
+ChildProcess::~ChildProcess()
+{
+    Kill();
+    StopReader();
+}
+
+bool ChildProcess::Start(const std::string& program, const std::vector<std::string>& arguments, std::function<void(const std::string&)> onOutputLine, std::error_code& error)
+{
+    this->onOutputLine = std::move(onOutputLine);
+
+    int pipeEnds[2];
+    if (pipe(pipeEnds) != 0)
+    {
+        error = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    fcntl(pipeEnds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipeEnds[1], F_SETFD, FD_CLOEXEC);
+
+    // Everything the child needs is prepared before fork, it may only make async-signal-safe calls
+    std::vector<std::string> argumentStrings = { program };
+    argumentStrings.insert(argumentStrings.end(), arguments.begin(), arguments.end());
+    std::vector<char*> argv;
+    for (auto& argument : argumentStrings)
+    {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        error = std::error_code(errno, std::generic_category());
+        close(pipeEnds[0]);
+        close(pipeEnds[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        // A process group of its own, so the program and everything it starts can be killed at once
+        setpgid(0, 0);
+        dup2(pipeEnds[1], STDOUT_FILENO);
+        dup2(pipeEnds[1], STDERR_FILENO);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    // Set the group from both sides, so a Kill right after Start cannot miss it
+    setpgid(pid, pid);
+    close(pipeEnds[1]);
+
+    state->pid = pid;
+    state->outputRead = pipeEnds[0];
+    state->stopReading = false;
+    state->reader = std::thread([this]() { ReadOutput(); });
+    error.clear();
+    return true;
+}
+
+void ChildProcess::ReadOutput()
+{
+    char buffer[4096];
+    while (true)
+    {
+        // Processes the program left running can hold the pipe open, so once it exited
+        // reading stops as soon as no more output is waiting
+        pollfd descriptor{ state->outputRead, POLLIN, 0 };
+        int ready = poll(&descriptor, 1, 100);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready == 0)
+        {
+            if (state->stopReading) break;
+            continue;
+        }
+
+        ssize_t bytesRead = read(state->outputRead, buffer, sizeof(buffer));
+        if (bytesRead < 0 && errno == EINTR) continue;
+        if (bytesRead <= 0) break;
+        DeliverOutput(buffer, static_cast<size_t>(bytesRead));
+    }
+    DeliverOutput(nullptr, 0);
+}
+
+bool ChildProcess::Wait(std::chrono::milliseconds timeout, int& exitCode)
+{
+    if (state->pid < 0) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        int status = 0;
+        pid_t result = waitpid(state->pid, &status, WNOHANG);
+        if (result == state->pid || (result < 0 && errno != EINTR))
+        {
+            exitCode = result == state->pid && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            state->pid = -1;
+            StopReader();
+            return true;
+        }
+        if (std::chrono::steady_clock::now() - start >= timeout)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+void ChildProcess::Kill()
+{
+    if (state->pid < 0) return;
+
+    kill(-state->pid, SIGKILL);
+    int status = 0;
+    while (waitpid(state->pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+    state->pid = -1;
+
+    StopReader();
+}
+
+void ChildProcess::StopReader()
+{
+    if (!state->reader.joinable()) return;
+
+    state->stopReading = true;
+    state->reader.join();
+
+    close(state->outputRead);
+    state->outputRead = -1;
+}
+
+#endif
+
+bool RenamePathWithRetry(const fs::path& from, const fs::path& to, unsigned retries, std::chrono::milliseconds retryDelay, std::error_code& error)
+{
+    for (unsigned attempt = 0; ; ++attempt)
+    {
+        if (RenamePath(from, to, error)) return true;
+        if (attempt >= retries || !IsAccessDenied(error)) return false;
+
+        std::this_thread::sleep_for(retryDelay);
+    }
+}
+
+void ChildProcess::DeliverOutput(const char* data, size_t size)
+{
+    // No data marks the end of the output, which may lack a final newline
+    if (size == 0)
+    {
+        if (!partialLine.empty())
+        {
+            onOutputLine(partialLine);
+            partialLine.clear();
+        }
+        return;
+    }
+
+    partialLine.append(data, size);
+    size_t start = 0;
+    size_t end;
+    while ((end = partialLine.find('\n', start)) != std::string::npos)
+    {
+        size_t length = end > start && partialLine[end - 1] == '\r' ? end - start - 1 : end - start;
+        onOutputLine(partialLine.substr(start, length));
+        start = end + 1;
+    }
+    partialLine.erase(0, start);
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// Thin layer over the few operating system calls the renamer needs, so the rename
+// engine itself builds unchanged on Windows and on POSIX systems (Linux, macOS).
+
+// Console text colour. Values are Windows console attributes; POSIX terminals get the matching ANSI escape.
+using ConsoleColour = unsigned short;
+
+// Set console text colour
+void SetConsoleColour(ConsoleColour colour);
+
+// Block until a single key is pressed, without waiting for Enter
+void WaitForKeyPress();
+
+// Thread-safe conversion of a point in time to local calendar time
+std::tm ToLocalTime(std::time_t time);
+
+// Rename a file or folder, replacing an existing file at the target
+bool RenamePath(const std::filesystem::path& from, const std::filesystem::path& to, std::error_code& error);
+
+// Rename a file or folder, retrying up to `retries` times, `retryDelay` apart, while another
+// process (Explorer, an editor, antivirus) keeps the path open. Other failures are not retried.
+bool RenamePathWithRetry(const std::filesystem::path& from, const std::filesystem::path& to, unsigned retries, std::chrono::milliseconds retryDelay, std::error_code& error);
+
+// Suffix of the temporary file WriteFileAtomically writes next to its target
+constexpr const char* AtomicWriteSuffix = ".uepr-tmp";
+
+// Replace a file's content all at once: the content goes to a temporary file next to it, is flushed
+// to disk and then renamed over the original, so a crash or full disk never leaves a half-written file
+bool WriteFileAtomically(const std::filesystem::path& path, std::string_view content, std::error_code& error);
+
+// A file that is only ever appended to, such as the journal of a run. Append hands the text to the
+// operating system; Sync flushes everything appended so far to disk, so a record can be made durable
+// before the change it describes.
+class AppendFile
+{
+public:
+    AppendFile() = default;
+    ~AppendFile() { Close(); }
+
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+
+    // Open the file for appending, creating it if needed
+    bool Open(const std::filesystem::path& path);
+    bool IsOpen() const { return handle != -1; }
+    bool Append(std::string_view text);
+    bool Sync();
+    void Close();
+
+private:
+    // HANDLE on Windows, file descriptor elsewhere
+    std::intptr_t handle = -1;
+};
+
+// Size and modification time of a file, the time as the count of a std::filesystem::file_time_type.
+// One stat, where file_size and last_write_time take one each. A directory entry on Windows already
+// holds both, so reading them from it costs no system call there.
+bool ReadFileStamp(const std::filesystem::path& path, uint64_t& size, int64_t& modified);
+bool ReadFileStamp(const std::filesystem::directory_entry& entry, uint64_t& size, int64_t& modified);
+
+// Whether a failed rename was caused by the path being in use or not accessible
+bool IsAccessDenied(const std::error_code& error);
+
+// File name of a program on this platform, e.g. "UnrealBuildTool.exe" on Windows and "UnrealBuildTool" elsewhere
+std::string ExecutableName(const std::string& name);
+
+// A program running alongside the renamer. Its standard output and error are read on a background
+// thread and handed over line by line. The program and everything it started are killed when it is
+// cancelled with Kill() or the object goes away while it still runs.
+class ChildProcess
+{
+public:
+    ChildProcess();
+    ~ChildProcess();
+
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    // Start a program with every argument passed as is. onOutputLine is called from the reader thread.
+    bool Start(const std::string& program, const std::vector<std::string>& arguments, std::function<void(const std::string&)> onOutputLine, std::error_code& error);
+
+    // Wait until the program exits, and all its output is handed over, or the timeout passes.
+    // Returns false on timeout and leaves the program running.
+    bool Wait(std::chrono::milliseconds timeout, int& exitCode);
+
+    // Kill the program and every process it started
+    void Kill();
+
+private:
+    struct State;
+
+    void ReadOutput();
+    void DeliverOutput(const char* data, size_t size);
+    void StopReader();
+
+    std::unique_ptr<State> state;
+    std::function<void(const std::string&)> onOutputLine;
+    std::string partialLine;
+};
+
+// Separator between the folders of a search path list, like PATH
+#ifdef _WIN32
+constexpr char PathListSeparator = ';';
+#else
+constexpr char PathListSeparator = ':';
+#endif
+
+// Whether paths differing only in case name the same file, as on Windows. macOS volumes usually
+// ignore case too, but not always, so paths there are compared exactly.
+#ifdef _WIN32
+constexpr bool PathsIgnoreCase = true;
+#else
+constexpr bool PathsIgnoreCase = false;
+#endif
+
+// Value of an environment variable, or an empty string if it is not set
+std::string EnvironmentVariable(const std::string& name);
+
+// Per user settings folder: %APPDATA%, ~/Library/Application Support or $XDG_CONFIG_HOME (~/.config)
+std::filesystem::path UserConfigDirectory();
+
+// Per user cache folder: %LOCALAPPDATA%, ~/Library/Caches or $XDG_CACHE_HOME (~/.cache)
+std::filesystem::path UserCacheDirectory();
+
+// Machine wide application data: %ProgramData% on Windows, the user settings folder elsewhere
+std::filesystem::path SharedConfigDirectory();
+
+// Every string value of a registry key under HKEY_LOCAL_MACHINE or HKEY_CURRENT_USER as name/value
+// pairs. There is no registry outside Windows, so the list is always empty there.
+std::vector<std::pair<std::string, std::string>> ReadRegistryStrings(bool localMachine, const std::string& subKey);
+
+// Largest amount of memory the process has had resident at once, in bytes
+uint64_t PeakMemoryUsage();
@@ -0,0 +1,309 @@
+#include "ProgressLedger.h"
+#include "MappedFile.h"
+#include "Sha256.h"
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Written on the first line, so a ledger from an incompatible version is never resumed
+    const char* LedgerHeader = "UEPR progress 1";
+
+    // Ledger paths are stored relative to the project root as generic UTF-8, like the journal
+    std::string ToLedgerPath(const fs::path& path)
+    {
+        std::u8string text = path.generic_u8string();
+        return std::string(text.begin(), text.end());
+    }
+
+    fs::path FromLedgerPath(const std::string& text)
+    {
+        return fs::path(std::u8string(text.begin(), text.end()));
+    }
+
+    std::vector<std::string> SplitFields(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+
+    // Whether the path lies inside the folder, or is the folder
+    bool IsWithin(const std::string& path, const std::string& folder)
+    {
+        return path == folder || (path.size() > folder.size() && path.compare(0, folder.size(), folder) == 0 && path[folder.size()] == '/');
+    }
+}
+
+ProgressLedger::ProgressLedger(const fs::path& projectRoot, const fs::path& runDirectory)
+    : projectRoot(projectRoot), ledgerFile(runDirectory / LedgerFileName)
+{
+    std::ifstream existing(ledgerFile, std::ios::binary);
+    std::string line;
+    if (std::getline(existing, line) && line == LedgerHeader)
+    {
+        // project <old name> <new name> <primary module>, module <old> <new> <folder>, then edit <before> <after> <path>,
+        // written <size> <modified> <path> and rename <from> <to> lines in the order they happened
+        while (std::getline(existing, line))
+        {
+            std::vector<std::string> fields = SplitFields(line);
+            if (fields.empty()) continue;
+
+            const std::string& kind = fields[0];
+            if (kind == "project" && fields.size() == 4)
+            {
+                info.oldProjectName = fields[1];
+                info.newProjectName = fields[2];
+                info.primaryModule = fields[3];
+                resumed = true;
+            }
+            else if (kind == "module" && fields.size() == 4)
+            {
+                info.modules.push_back({ fields[1], fields[2], projectRoot / FromLedgerPath(fields[3]) });
+            }
+            else if (kind == "edit" && fields.size() == 4)
+            {
+                Edit& edit = edits[fields[3]];
+                edit = Edit();
+                edit.afterHash = fields[2];
+            }
+            else if (kind == "written" && fields.size() == 4)
+            {
+                auto edit = edits.find(fields[3]);
+                if (edit == edits.end()) continue;
+                try
+                {
+                    edit->second.size = std::stoull(fields[1]);
+                    edit->second.modified = std::stoll(fields[2]);
+                    edit->second.written = true;
+                }
+                catch (const std::exception&)
+                {
+                    // A torn last line leaves the edit to be checked by hash
+                }
+            }
+            else if (kind == "rename" && fields.size() == 3)
+            {
+                ApplyRename(fields[1], fields[2]);
+                renames.emplace_back(fields[1], fields[2]);
+            }
+        }
+    }
+    existing.close();
+
+    file.Open(ledgerFile);
+}
+
+bool ProgressLedger::Begin(const RunInfo& runInfo)
+{
+    info = runInfo;
+
+    std::string lines = LedgerHeader;
+    lines += "\nproject\t" + info.oldProjectName + '\t' + info.newProjectName + '\t' + info.primaryModule + '\n';
+    for (const auto& module : info.modules)
+    {
+        lines += "module\t" + module.oldName + '\t' + module.newName + '\t';
+        lines += KeyOf(module.directory);
+        lines += '\n';
+    }
+    lines.pop_back();
+    return AppendLine(lines, true);
+}
+
+bool ProgressLedger::RecordEdit(const fs::path& filePath, const std::string& beforeHash, std::string_view after)
+{
+    std::string key = KeyOf(filePath);
+    std::string afterHash = Sha256::HashHex(after);
+    std::string line = "edit\t" + beforeHash + '\t' + afterHash + '\t' + key;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Edit& edit = edits[key];
+        edit = Edit();
+        edit.afterHash = afterHash;
+    }
+    return AppendLine(line, false);
+}
+
+bool ProgressLedger::Sync()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file.Sync();
+}
+
+void ProgressLedger::RecordWritten(const fs::path& filePath)
+{
+    uint64_t size = 0;
+    int64_t modified = 0;
+    if (!ReadFileStamp(filePath, size, modified)) return;
+
+    std::string key = KeyOf(filePath);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Edit& edit = edits[key];
+        edit.size = size;
+        edit.modified = modified;
+        edit.written = true;
+    }
+    AppendLine("written\t" + std::to_string(size) + '\t' + std::to_string(modified) + '\t' + key, false);
+}
+
+bool ProgressLedger::RecordRename(const fs::path& from, const fs::path& to)
+{
+    std::string fromKey = KeyOf(from);
+    std::string toKey = KeyOf(to);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ApplyRename(fromKey, toKey);
+        renames.emplace_back(fromKey, toKey);
+    }
+    return AppendLine("rename\t" + fromKey + '\t' + toKey, true);
+}
+
+bool ProgressLedger::IsEditDone(const fs::path& filePath) const
+{
+    Edit edit;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = edits.find(KeyOf(filePath));
+        if (found == edits.end()) return false;
+        edit = found->second;
+    }
+
+    uint64_t size = 0;
+    int64_t modified = 0;
+    if (!ReadFileStamp(filePath, size, modified)) return false;
+    if (edit.written && edit.size == size && edit.modified == modified) return true;
+
+    // Written but not stamped, or touched since: only the content tells
+    MappedFile file(filePath);
+    return file.IsOpen() && Sha256::HashHex(file.View()) == edit.afterHash;
+}
+
+bool ProgressLedger::IsRenameDone(const fs::path& from, const fs::path& to) const
+{
+    std::string fromKey = KeyOf(from);
+    std::string toKey = KeyOf(to);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& rename : renames)
+    {
+        if (rename.first == fromKey && rename.second == toKey) return true;
+    }
+    return false;
+}
+
+fs::path ProgressLedger::CurrentPath(const fs::path& path) const
+{
+    std::string key = KeyOf(path);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [from, to] : renames)
+    {
+        if (IsWithin(key, from))
+        {
+            key = to + key.substr(from.size());
+        }
+    }
+    return projectRoot / FromLedgerPath(key);
+}
+
+void ProgressLedger::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    file.Close();
+}
+
+void ProgressLedger::MarkFinished(const fs::path& runDirectory)
+{
+    std::ofstream ledger(runDirectory / LedgerFileName, std::ios::binary | std::ios::app);
+    ledger << "finished\n";
+}
+
+void ProgressLedger::MarkRolledBack(const fs::path& runDirectory)
+{
+    // Runs from before the ledger existed have none, and get none
+    std::error_code error;
+    if (!fs::exists(runDirectory / LedgerFileName, error)) return;
+
+    std::ofstream ledger(runDirectory / LedgerFileName, std::ios::binary | std::ios::app);
+    ledger << "rollback\n";
+}
+
+fs::path ProgressLedger::FindUnfinishedRun(const fs::path& storeDirectory, std::string& newProjectName)
+{
+    fs::path unfinishedRun;
+
+    std::error_code error;
+    for (fs::directory_iterator it(storeDirectory, error), end; !error && it != end; it.increment(error))
+    {
+        std::ifstream ledger(it->path() / LedgerFileName, std::ios::binary);
+        std::string line;
+        if (!std::getline(ledger, line) || line != LedgerHeader) continue;
+
+        std::string runName;
+        bool finished = false;
+        while (std::getline(ledger, line))
+        {
+            if (line.compare(0, 8, "project\t") == 0)
+            {
+                std::vector<std::string> fields = SplitFields(line);
+                runName = fields.size() > 2 ? fields[2] : std::string();
+            }
+            else if (line == "finished" || line == "rollback")
+            {
+                finished = true;
+            }
+        }
+
+        // Run folders are named after the time they started, so the newest sorts last
+        if (!finished && !runName.empty() && (unfinishedRun.empty() || unfinishedRun.filename() < it->path().filename()))
+        {
+            unfinishedRun = it->path();
+            newProjectName = runName;
+        }
+    }
+    return unfinishedRun;
+}
+
+bool ProgressLedger::AppendLine(const std::string& line, bool sync)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file.Append(line + '\n') && (!sync || file.Sync());
+}
+
+void ProgressLedger::ApplyRename(const std::string& from, const std::string& to)
+{
+    // Edits are kept sorted by path, so a renamed file or everything inside a renamed folder is one range
+    std::vector<std::pair<std::string, Edit>> moved;
+    auto file = edits.find(from);
+    if (file != edits.end())
+    {
+        moved.emplace_back(to, std::move(file->second));
+        edits.erase(file);
+    }
+
+    std::string folder = from + '/';
+    auto it = edits.lower_bound(folder);
+    while (it != edits.end() && it->first.compare(0, folder.size(), folder) == 0)
+    {
+        moved.emplace_back(to + it->first.substr(from.size()), std::move(it->second));
+        it = edits.erase(it);
+    }
+
+    for (auto& [key, edit] : moved)
+    {
+        edits[key] = std::move(edit);
+    }
+}
+
+std::string ProgressLedger::KeyOf(const fs::path& path) const
+{
+    return ToLedgerPath(path.lexically_relative(projectRoot));
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Platform.h"
+#include "ProjectDescriptor.h"
+
+// Progress of one rename run, kept next to its journal so an interrupted run can be resumed.
+// The names the run renames are recorded first, since the descriptors they were read from may be
+// renamed already when it is resumed. Every edit is recorded with the content hashes before and
+// after it, and stamped with the file's size and modification time once written; every rename once
+// made. A resumed run skips each completed file with one lookup and one stat, instead of reading,
+// backing up and rewriting it again, which could apply a replacement twice.
+class ProgressLedger
+{
+public:
+    // What the run renames
+    struct RunInfo
+    {
+        std::string oldProjectName;
+        std::string newProjectName;
+        std::string primaryModule;
+        std::vector<ModuleRename> modules;
+    };
+
+    // Opens the ledger of a run folder, reading the progress recorded by an earlier attempt of the same run
+    ProgressLedger(const std::filesystem::path& projectRoot, const std::filesystem::path& runDirectory);
+
+    // Whether an earlier attempt of the run recorded what it renames, which is then in Info()
+    bool IsResumed() const { return resumed; }
+    const RunInfo& Info() const { return info; }
+
+    // Record what a new run renames. Returns false if the ledger could not be written.
+    bool Begin(const RunInfo& runInfo);
+
+    // Record an edit about to be made, by the hash of the content it replaces and the new content.
+    // Returns false if the ledger could not be written, in which case the edit must not go ahead.
+    // Like the journal's, edits are only on disk once Sync has returned.
+    bool RecordEdit(const std::filesystem::path& filePath, const std::string& beforeHash, std::string_view after);
+    bool Sync();
+
+    // Stamp an edit once its content is written. A missing stamp only costs a hash check when resuming.
+    void RecordWritten(const std::filesystem::path& filePath);
+
+    // Record a rename that was made. Edited files follow their file or folder.
+    bool RecordRename(const std::filesystem::path& from, const std::filesystem::path& to);
+
+    // Whether the run already rewrote a file and it still holds the content written. A file whose size
+    // or modification time differs from the stamp is read and compared by hash, so a crash between
+    // the write and its stamp does not lead to a second rewrite.
+    bool IsEditDone(const std::filesystem::path& filePath) const;
+
+    // Whether the run already made a rename
+    bool IsRenameDone(const std::filesystem::path& from, const std::filesystem::path& to) const;
+
+    // Where a path of the project is now, following every rename made by the run
+    std::filesystem::path CurrentPath(const std::filesystem::path& path) const;
+
+    // Close the ledger, so nothing inside the project is held open when the project folder is renamed
+    void Close();
+
+    // Mark a run as finished, or as undone with --rollback, so it is never resumed
+    static void MarkFinished(const std::filesystem::path& runDirectory);
+    static void MarkRolledBack(const std::filesystem::path& runDirectory);
+
+    // The newest run folder of a store that did not finish. `newProjectName` is set to the name it renames to.
+    static std::filesystem::path FindUnfinishedRun(const std::filesystem::path& storeDirectory, std::string& newProjectName);
+
+    static constexpr const char* LedgerFileName = "progress.txt";
+
+private:
+    struct Edit
+    {
+        std::string afterHash;
+        bool written = false;
+        uint64_t size = 0;
+        int64_t modified = 0;
+    };
+
+    bool AppendLine(const std::string& line, bool sync);
+    void ApplyRename(const std::string& from, const std::string& to);
+    std::string KeyOf(const std::filesystem::path& path) const;
+
+    std::filesystem::path projectRoot;
+    std::filesystem::path ledgerFile;
+    bool resumed = false;
+    RunInfo info;
+
+    mutable std::mutex mutex;
+    std::map<std::string, Edit> edits;
+    std::vector<std::pair<std::string, std::string>> renames;
+    AppendFile file;
+};
@@ -0,0 +1,177 @@
+#include "ProjectDescriptor.h"
+#include "Json.h"
+#include <algorithm>
+#include <cctype>
+#include <set>
+
+namespace fs = std::filesystem;
+
+bool ProjectDescriptor::Parse(std::string_view content, std::string& error)
+{
+    modules.clear();
+    references.clear();
+
+    JsonValue root;
+    if (!ParseJson(content, root, error))
+    {
+        return false;
+    }
+    if (!root.IsObject())
+    {
+        error = "the descriptor is not a JSON object";
+        return false;
+    }
+
+    // Content-only projects and plugins have no "Modules" at all
+    const JsonValue* moduleList = root.Find("Modules");
+    if (!moduleList)
+    {
+        return true;
+    }
+    if (!moduleList->IsArray())
+    {
+        error = "\"Modules\" is not a list";
+        return false;
+    }
+
+    for (const auto& entry : moduleList->items)
+    {
+        const JsonValue* name = entry.IsObject() ? entry.Find("Name") : nullptr;
+        if (!name || !name->IsString() || name->text.empty())
+        {
+            error = "a module has no \"Name\"";
+            return false;
+        }
+
+        const JsonValue* type = entry.Find("Type");
+        modules.push_back({ name->text, type && type->IsString() ? type->text : std::string() });
+        references.push_back({ name->offset, name->length, name->text });
+
+        // Modules loaded before this one, listed by name
+        const JsonValue* dependencies = entry.Find("AdditionalDependencies");
+        if (dependencies && dependencies->IsArray())
+        {
+            for (const auto& dependency : dependencies->items)
+            {
+                if (dependency.IsString())
+                {
+                    references.push_back({ dependency.offset, dependency.length, dependency.text });
+                }
+            }
+        }
+    }
+
+    std::sort(references.begin(), references.end(), [](const NameReference& a, const NameReference& b) { return a.offset < b.offset; });
+    return true;
+}
+
+size_t ProjectDescriptor::RenameModules(std::string_view content, const std::map<std::string, std::string>& renames, std::string& output) const
+{
+    output.clear();
+    output.reserve(content.size());
+
+    size_t replaced = 0;
+    size_t copied = 0;
+    for (const auto& reference : references)
+    {
+        auto rename = renames.find(reference.name);
+        if (rename == renames.end() || rename->second == reference.name)
+        {
+            continue;
+        }
+
+        output.append(content, copied, reference.offset - copied);
+        output += QuoteJson(rename->second);
+        copied = reference.offset + reference.length;
+        ++replaced;
+    }
+    output.append(content, copied, std::string_view::npos);
+    return replaced;
+}
+
+std::string RenamedModuleName(const std::string& moduleName, const std::vector<std::string>& oldNames, const std::string& newName)
+{
+    // The longest old name wins, so MyGameCore is not read as MyGame + Core when both are old names
+    const std::string* bestMatch = nullptr;
+    for (const auto& oldName : oldNames)
+    {
+        if (oldName.empty() || moduleName.compare(0, oldName.size(), oldName) != 0)
+        {
+            continue;
+        }
+
+        if (moduleName.size() > oldName.size())
+        {
+            unsigned char next = static_cast<unsigned char>(moduleName[oldName.size()]);
+            if (!std::isupper(next) && !std::isdigit(next) && next != '_')
+            {
+                continue;
+            }
+        }
+
+        if (!bestMatch || oldName.size() > bestMatch->size())
+        {
+            bestMatch = &oldName;
+        }
+    }
+
+    if (!bestMatch)
+    {
+        return moduleName;
+    }
+    return newName + moduleName.substr(bestMatch->size());
+}
+
+std::vector<fs::path> FindPluginDescriptors(const ProjectSnapshot& snapshot, const fs::path& projectRoot)
+{
+    fs::path pluginsDirectory = projectRoot / "Plugins";
+    std::vector<fs::path> candidates;
+    std::set<fs::path> pluginFolders;
+    for (const auto& entry : snapshot.ListRecursive(pluginsDirectory))
+    {
+        if (!entry.isDirectory && entry.path.extension() == ".uplugin" && entry.path.parent_path() != pluginsDirectory)
+        {
+            candidates.push_back(entry.path);
+            pluginFolders.insert(entry.path.parent_path());
+        }
+    }
+
+    // A plugin folder holds exactly one .uplugin, and nothing below it is searched
+    std::vector<fs::path> descriptors;
+    std::set<fs::path> takenFolders;
+    for (const auto& candidate : candidates)
+    {
+        bool insidePlugin = false;
+        for (fs::path folder = candidate.parent_path().parent_path(); folder != pluginsDirectory && folder.has_relative_path(); folder = folder.parent_path())
+        {
+            if (pluginFolders.count(folder) > 0)
+            {
+                insidePlugin = true;
+                break;
+            }
+        }
+        if (!insidePlugin && takenFolders.insert(candidate.parent_path()).second)
+        {
+            descriptors.push_back(candidate);
+        }
+    }
+
+    // Listing order differs between file systems; a stable order keeps the output reproducible
+    std::sort(descriptors.begin(), descriptors.end());
+    return descriptors;
+}
+
+void FindBuildFiles(const ProjectSnapshot& snapshot, const fs::path& sourceDirectory, std::map<std::string, fs::path>& buildFiles)
+{
+    static const std::string buildFileSuffix = ".Build.cs";
+
+    for (const auto& entry : snapshot.ListRecursive(sourceDirectory))
+    {
+        std::string filename = entry.path.filename().string();
+        if (!entry.isDirectory && filename.size() > buildFileSuffix.size()
+            && filename.compare(filename.size() - buildFileSuffix.size(), buildFileSuffix.size(), buildFileSuffix) == 0)
+        {
+            buildFiles.emplace(filename.substr(0, filename.size() - buildFileSuffix.size()), entry.path);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ProjectSnapshot.h"
+
+// The modules a .uproject or .uplugin file declares, read through its JSON. Every place the file
+// names a module, the module's "Name" and its "AdditionalDependencies", is kept with its byte range,
+// so renaming modules rewrites exactly those strings and leaves the rest of the file untouched.
+class ProjectDescriptor
+{
+public:
+    struct Module
+    {
+        std::string name;
+        std::string type; // Runtime, Editor, UncookedOnly, ...
+    };
+
+    // Parse the content of a descriptor file. Returns false with a description of the problem if
+    // the file is not valid JSON or its "Modules" are malformed.
+    bool Parse(std::string_view content, std::string& error);
+
+    const std::vector<Module>& Modules() const { return modules; }
+
+    // The content with every module name found in `renames` replaced. Returns the number of names replaced.
+    size_t RenameModules(std::string_view content, const std::map<std::string, std::string>& renames, std::string& output) const;
+
+private:
+    struct NameReference
+    {
+        size_t offset;
+        size_t length;
+        std::string name;
+    };
+
+    std::vector<Module> modules;
+    std::vector<NameReference> references;
+};
+
+// A module renamed along with the project, and the folder holding its <Name>.Build.cs
+struct ModuleRename
+{
+    std::string oldName;
+    std::string newName;
+    std::filesystem::path directory;
+};
+
+// The new name of a module or target. A name that starts with one of the old names keeps what follows,
+// so MyGameEditor becomes NewNameEditor when MyGame is renamed to NewName. The rest has to start a new
+// word (an upper case letter, a digit or '_') so Game never claims Gameplay. Other names are returned as they are.
+std::string RenamedModuleName(const std::string& moduleName, const std::vector<std::string>& oldNames, const std::string& newName);
+
+// The .uplugin files of the project plugins. Like UnrealBuildTool, folders below Plugins are searched
+// until a .uplugin file is found, so plugins can be grouped in subfolders.
+std::vector<std::filesystem::path> FindPluginDescriptors(const ProjectSnapshot& snapshot, const std::filesystem::path& projectRoot);
+
+// Every <Module>.Build.cs below a Source folder, keyed by module name
+void FindBuildFiles(const ProjectSnapshot& snapshot, const std::filesystem::path& sourceDirectory, std::map<std::string, std::filesystem::path>& buildFiles);
@@ -0,0 +1,153 @@
+#include "ProjectFiles.h"
+#include "SubstringSearch.h"
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Paths in Visual Studio files always use backslashes
+    std::string ToSolutionPath(const fs::path& path)
+    {
+        std::string text = path.lexically_normal().string();
+        for (char& c : text)
+        {
+            if (c == '/') c = '\\';
+        }
+        return text;
+    }
+
+    // Apply one folder or file rename to a path that may lie inside it
+    std::string ApplyRename(const std::string& path, const std::string& from, const std::string& to)
+    {
+        if (path == from)
+        {
+            return to;
+        }
+        if (path.size() > from.size() && path.compare(0, from.size(), from) == 0 && path[from.size()] == '\\')
+        {
+            return to + path.substr(from.size());
+        }
+        return path;
+    }
+
+    // The target, module or project name of a renamed file, or an empty string
+    std::string NameOf(const fs::path& path)
+    {
+        static const std::string suffixes[] = { ".uproject", ".Target.cs", ".Build.cs" };
+        std::string filename = path.filename().string();
+        for (const auto& suffix : suffixes)
+        {
+            if (filename.size() > suffix.size() && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0)
+            {
+                return filename.substr(0, filename.size() - suffix.size());
+            }
+        }
+        return std::string();
+    }
+}
+
+bool FindProjectFiles(const fs::path& projectRoot, const std::string& oldProjectName, ProjectFileSet& files)
+{
+    files.solution = projectRoot / (oldProjectName + ".sln");
+    fs::path projectFilesDirectory = projectRoot / "Intermediate" / "ProjectFiles";
+    fs::path projectFile = projectFilesDirectory / (oldProjectName + ".vcxproj");
+
+    std::error_code error;
+    if (!fs::is_regular_file(files.solution, error) || !fs::is_regular_file(projectFile, error))
+    {
+        return false;
+    }
+
+    // Only a solution that really refers to this project file can be rewritten safely
+    std::ifstream solution(files.solution, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(solution)), std::istreambuf_iterator<char>());
+    if (FindSubstring(content, "ProjectFiles\\" + oldProjectName + ".vcxproj\"") == std::string_view::npos)
+    {
+        return false;
+    }
+
+    files.projectFiles.clear();
+    for (const char* extension : { ".vcxproj", ".vcxproj.filters", ".vcxproj.user" })
+    {
+        fs::path path = projectFilesDirectory / (oldProjectName + extension);
+        if (fs::is_regular_file(path, error))
+        {
+            files.projectFiles.push_back(path);
+        }
+    }
+    return true;
+}
+
+std::vector<std::pair<fs::path, fs::path>> PlanProjectFileRenames(const ProjectFileSet& files, const std::string& oldProjectName, const std::string& newProjectName)
+{
+    std::vector<std::pair<fs::path, fs::path>> renames;
+    renames.emplace_back(files.solution, files.solution.parent_path() / (newProjectName + ".sln"));
+    for (const auto& projectFile : files.projectFiles)
+    {
+        // <OldName>.vcxproj.filters becomes <NewName>.vcxproj.filters
+        std::string filename = projectFile.filename().string();
+        renames.emplace_back(projectFile, projectFile.parent_path() / (newProjectName + filename.substr(oldProjectName.size())));
+    }
+    return renames;
+}
+
+MultiReplacer BuildProjectFileReplacer(const fs::path& projectRoot, const fs::path& newProjectRoot, const std::vector<std::pair<fs::path, fs::path>>& renames)
+{
+    MultiReplacer replacer;
+
+    // Absolute paths, written before the project folder itself is renamed
+    replacer.Add(ToSolutionPath(projectRoot) + '\\', ToSolutionPath(newProjectRoot) + '\\');
+
+    std::vector<std::pair<std::string, std::string>> relativeRenames;
+    for (const auto& [from, to] : renames)
+    {
+        relativeRenames.emplace_back(ToSolutionPath(from.lexically_relative(projectRoot)), ToSolutionPath(to.lexically_relative(projectRoot)));
+    }
+
+    for (size_t i = 0; i < relativeRenames.size(); ++i)
+    {
+        // A file renamed before its folder was renamed ends up inside the new folder
+        std::string finalPath = relativeRenames[i].second;
+        for (size_t j = i + 1; j < relativeRenames.size(); ++j)
+        {
+            finalPath = ApplyRename(finalPath, relativeRenames[j].first, relativeRenames[j].second);
+        }
+
+        const std::string& fromPath = relativeRenames[i].first;
+        if (renames[i].first.has_extension())
+        {
+            replacer.Add(fromPath, finalPath);
+        }
+        else
+        {
+            // Folder names must end where the folder does, so Source\Game never matches Source\GameTests
+            for (char terminator : { '\\', ';', '"', '<' })
+            {
+                replacer.Add(fromPath + terminator, finalPath + terminator);
+            }
+        }
+
+        std::string oldName = NameOf(renames[i].first);
+        std::string newName = NameOf(renames[i].second);
+        if (oldName.empty() || newName.empty() || oldName == newName)
+        {
+            continue;
+        }
+
+        // Names appear as build command arguments (Build.bat <Target> Win64 ...), quoted solution project
+        // names, element values, UE_TARGET_NAME=<Target>; defines, binary names like <Target>-Win64-Shipping.exe,
+        // intermediate folders like Inc\<Module>\UHT and Definitions.<Module>.h
+        static const std::pair<const char*, const char*> decorations[] = {
+            { " ", " " }, { "\"", "\"" }, { ">", "<" }, { "=", ";" }, { "\\", ".exe" }, { "\\", "-" }, { "-", "." },
+            { "\\", "\\" }, { ".", ".h" } };
+        for (const auto& [prefix, suffix] : decorations)
+        {
+            replacer.Add(prefix + oldName + suffix, prefix + newName + suffix);
+        }
+    }
+
+    replacer.Compile();
+    return replacer;
+}
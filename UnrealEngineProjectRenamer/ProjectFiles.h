@@ -0,0 +1,30 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ReplaceEngine.h"
+
+// The Visual Studio files UnrealBuildTool generated for a project: the .sln in the project
+// folder and the project's .vcxproj, .vcxproj.filters and .vcxproj.user in Intermediate/ProjectFiles.
+// They only refer to the project by file paths and by its target, module and project names, so a
+// rename can rewrite them directly instead of regenerating them with UnrealBuildTool.
+// Project GUIDs do not change, so every GUID keyed entry of the .sln stays valid.
+struct ProjectFileSet
+{
+    std::filesystem::path solution;
+    std::vector<std::filesystem::path> projectFiles;
+};
+
+// Find the files generated for `oldProjectName`. Returns false if the .sln or the .vcxproj it
+// refers to is missing, for example after the Intermediate folder was deleted.
+bool FindProjectFiles(const std::filesystem::path& projectRoot, const std::string& oldProjectName, ProjectFileSet& files);
+
+// Where each project file ends up once renamed after `newProjectName`
+std::vector<std::pair<std::filesystem::path, std::filesystem::path>> PlanProjectFileRenames(const ProjectFileSet& files, const std::string& oldProjectName, const std::string& newProjectName);
+
+// Build one replacer for every spelling of the run's renames found in these files.
+// `renames` are the file and folder renames of the run in the order they were made, `newProjectRoot`
+// is where the project folder itself ends up. Names come from the renamed .uproject, .Target.cs and
+// .Build.cs files, and paths are matched in the backslash form used by Visual Studio.
+MultiReplacer BuildProjectFileReplacer(const std::filesystem::path& projectRoot, const std::filesystem::path& newProjectRoot, const std::vector<std::pair<std::filesystem::path, std::filesystem::path>>& renames);
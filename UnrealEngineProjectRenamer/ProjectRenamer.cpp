@@ -0,0 +1,2485 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include "ProjectRenamer.h"
+#include "globals.h"
+#include "BackupStore.h"
+#include "ChangePlan.h"
+#include "EngineLocator.h"
+#include "FileIo.h"
+#include "Journal.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "PackageScanner.h"
+#include "Platform.h"
+#include "ProgressLedger.h"
+#include "ProjectDescriptor.h"
+#include "ProjectFiles.h"
+#include "ReferenceIndex.h"
+#include "ReplaceEngine.h"
+#include "Sha256.h"
+#include "Trace.h"
+#include "TrashCollector.h"
+
+// Collects the console output of one file operation so parallel workers never interleave lines.
+// The lines are handed to the logger thread in one batch. Errors count towards the project's error
+// total, and lines are tagged with the project when several projects are renamed at once.
+class LogBuffer
+{
+public:
+    explicit LogBuffer(ProjectContext& project)
+        : errorCount(project.errorCount)
+    {
+        if (isManifestMode)
+        {
+            projectName = project.newProjectName;
+        }
+    }
+
+    ~LogBuffer()
+    {
+        Flush();
+    }
+
+    // The level follows the colour: red lines are errors, orange lines warnings
+    template <typename... Args>
+    void Write(ConsoleColour colour, const Args&... args)
+    {
+        Append(LevelOfColour(colour), colour, args...);
+    }
+
+    template <typename... Args>
+    void WriteError(ConsoleColour colour, const Args&... args)
+    {
+        errorCount++;
+        Append(LogLevel::Error, colour, args...);
+    }
+
+    // Details only printed with --verbose
+    template <typename... Args>
+    void WriteVerbose(ConsoleColour colour, const Args&... args)
+    {
+        Append(LogLevel::Verbose, colour, args...);
+    }
+
+    // Queue all collected lines as one block
+    void Flush()
+    {
+        SubmitLog(std::move(lines));
+        lines.clear();
+    }
+
+private:
+    template <typename... Args>
+    void Append(LogLevel level, ConsoleColour colour, const Args&... args)
+    {
+        if (!IsLogged(level)) return;
+
+        std::ostringstream message;
+        (message << ... << args);
+        lines.push_back({ level, colour, projectName, message.str() });
+    }
+
+    std::atomic<unsigned>& errorCount;
+    std::string projectName;
+    std::vector<LogLine> lines;
+};
+
+// Print a single message of a step through the logger
+template <typename... Args>
+void LogMessage(ProjectContext& project, ConsoleColour colour, const Args&... args)
+{
+    LogBuffer log(project);
+    log.Write(colour, args...);
+}
+
+
+// Report the outcome of storing a file in the backup store
+void LogBackupResult(ProjectContext& project, BackupStore::Result result, const fs::path& filePath, const fs::path& relativePath, const std::string& error, LogBuffer& log)
+{
+    switch (result)
+    {
+    case BackupStore::Result::Stored:
+        log.Write(COLOUR_GREEN, "\nSuccessfully backed up file: ", project.backupDirectory / relativePath);
+        break;
+    case BackupStore::Result::AlreadyStored:
+        log.WriteVerbose(COLOUR_WHITE, "\nAlready backed up file: ", filePath);
+        break;
+    case BackupStore::Result::Failed:
+        log.WriteError(COLOUR_RED, "\nERROR: Failed to back up file ", filePath, ": ", error);
+        break;
+    }
+}
+
+// Function to backup a file
+void BackupFile(ProjectContext& project, const fs::path& filePath, LogBuffer& log)
+{
+    // A dry run changes nothing, so there is nothing to back up
+    if (project.changePlan) return;
+
+    // A file this run already rewrote was backed up before it was interrupted
+    if (project.progress && project.progress->IsEditDone(filePath)) return;
+
+    TraceSpan span("BackupFile", "backup");
+    span.SetDetail(filePath);
+
+    if (fs::exists(filePath))
+    {
+        // Get the relative path of the file with respect to the project root directory
+        fs::path relativePath = fs::relative(filePath, project.projectRootDirectory);
+
+        // The store keeps the first copy taken during this run, it holds the original content
+        std::string error;
+        BackupStore::Result result = project.backupStore->StoreFile(filePath, relativePath, error);
+        LogBackupResult(project, result, filePath, relativePath, error, log);
+    }
+    else
+    {
+        log.WriteError(COLOUR_RED, "\nERROR: File ", filePath, " does not exist.");
+    }
+}
+
+// Backup content that has already been read for a rewrite, so the file is only read once
+void BackupFileContent(ProjectContext& project, const fs::path& filePath, std::string_view content, LogBuffer& log)
+{
+    if (project.changePlan) return;
+
+    TraceSpan span("BackupFile", "backup");
+    span.SetDetail(filePath);
+
+    fs::path relativePath = fs::relative(filePath, project.projectRootDirectory);
+
+    std::string error;
+    BackupStore::Result result = project.backupStore->StoreContent(content, relativePath, error);
+    LogBackupResult(project, result, filePath, relativePath, error, log);
+}
+
+void BackupFile(ProjectContext& project, const fs::path& filePath)
+{
+    LogBuffer log(project);
+    BackupFile(project, filePath, log);
+    log.Flush();
+}
+
+void MakeFileWritable(const std::filesystem::path& filePath, LogBuffer& log)
+{
+    try
+    {
+        auto perms = std::filesystem::status(filePath).permissions();
+        if ((perms & std::filesystem::perms::owner_write) == std::filesystem::perms::none)
+        {
+            // Add write permission
+            std::filesystem::permissions(filePath,
+                perms | std::filesystem::perms::owner_write,
+                std::filesystem::perm_options::add);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log.WriteError(COLOUR_RED, "\nFailed to modify file permissions: ", e.what());
+    }
+}
+
+void MakeFileWritable(ProjectContext& project, const std::filesystem::path& filePath)
+{
+    if (project.changePlan) return;
+
+    LogBuffer log(project);
+    MakeFileWritable(filePath, log);
+    log.Flush();
+}
+
+// Read a whole file through a memory mapping, copying it only once
+bool ReadFileContent(const fs::path& filePath, std::string& content)
+{
+    MappedFile file(filePath);
+    if (!file.IsOpen()) return false;
+
+    content.assign(file.View());
+    return true;
+}
+
+// The hash the progress ledger records for the content an edit replaces, only taken when there is a ledger
+std::string ContentHash(const ProjectContext& project, std::string_view content)
+{
+    return project.progress ? Sha256::HashHex(content) : std::string();
+}
+
+// Journal an edit before its new content is written, so an interrupted run can always be rolled back
+bool RecordFileEdit(ProjectContext& project, const fs::path& filePath, const std::string& originalHash, std::string_view content)
+{
+    if (project.journal && !project.journal->RecordEdit(filePath)) return false;
+    if (project.progress && !project.progress->RecordEdit(filePath, originalHash, content)) return false;
+    return true;
+}
+
+// Flush the edits recorded so far to disk, so none of them is written before its record
+bool SyncFileEdits(ProjectContext& project)
+{
+    if (project.journal && !project.journal->Sync()) return false;
+    if (project.progress && !project.progress->Sync()) return false;
+    return true;
+}
+
+// Replace the content of a project file byte for byte. The edit is journaled first and the
+// new content committed through a temporary file, so an interrupted run can always be rolled back.
+// The progress ledger stamps the file once written, so a resumed run does not rewrite it again.
+bool WriteFileContent(ProjectContext& project, const fs::path& filePath, const std::string& originalHash, std::string_view content)
+{
+    if (!RecordFileEdit(project, filePath, originalHash, content) || !SyncFileEdits(project)) return false;
+
+    std::error_code error;
+    if (!WriteFileAtomically(filePath, content, error)) return false;
+
+    if (project.progress) project.progress->RecordWritten(filePath);
+    return true;
+}
+
+// Read a project file as the rename left it so far. In a dry run nothing is written,
+// so a file edited by an earlier step is read back from the change plan.
+bool ReadProjectFile(ProjectContext& project, const fs::path& filePath, std::string& content)
+{
+    if (project.changePlan && project.changePlan->PlannedContent(filePath, content)) return true;
+    return ReadFileContent(filePath, content);
+}
+
+// Replace the content of a project file, or only record the edit in a dry run
+bool WriteProjectFile(ProjectContext& project, const fs::path& filePath, std::string_view originalContent, std::string_view content)
+{
+    if (project.changePlan)
+    {
+        project.changePlan->RecordEdit(filePath, originalContent, content);
+        return true;
+    }
+    return WriteFileContent(project, filePath, ContentHash(project, originalContent), content);
+}
+
+// Rename a file or folder, or only record the rename in a dry run. Throws fs::filesystem_error like fs::rename.
+// A rename the interrupted run being resumed already made is not made again, but generated files still follow it.
+void MoveProjectPath(ProjectContext& project, const fs::path& from, const fs::path& to)
+{
+    if (project.changePlan)
+    {
+        project.changePlan->RecordRename(from, to);
+        std::lock_guard<std::mutex> lock(project.renamedPathsMutex);
+        project.renamedPaths.emplace_back(from, to);
+        return;
+    }
+    if (project.progress && project.progress->IsRenameDone(from, to))
+    {
+        std::lock_guard<std::mutex> lock(project.renamedPathsMutex);
+        project.renamedPaths.emplace_back(from, to);
+        return;
+    }
+    if (project.journal && !project.journal->RecordRename(from, to))
+    {
+        throw fs::filesystem_error("Could not write the rename journal", from, to, std::make_error_code(std::errc::io_error));
+    }
+    TraceSpan span("Rename", "file");
+    span.SetDetail(from);
+    span.Add(TraceCounter::SystemCalls, 1);
+    fs::rename(from, to);
+    project.snapshot->Rename(from, to);
+    if (project.progress && !project.progress->RecordRename(from, to))
+    {
+        throw fs::filesystem_error("Could not write the progress ledger", from, to, std::make_error_code(std::errc::io_error));
+    }
+    std::lock_guard<std::mutex> lock(project.renamedPathsMutex);
+    project.renamedPaths.emplace_back(from, to);
+}
+
+// Delete a file or a whole folder, or only record the deletion in a dry run. Throws fs::filesystem_error.
+void DeleteProjectPath(ProjectContext& project, const fs::path& path)
+{
+    if (project.changePlan)
+    {
+        project.changePlan->RecordDelete(path);
+        return;
+    }
+    if (project.journal && !project.journal->RecordDelete(path))
+    {
+        throw fs::filesystem_error("Could not write the rename journal", path, std::make_error_code(std::errc::io_error));
+    }
+    TraceSpan span("DeleteTree", "delete");
+    span.SetDetail(path);
+    span.Add(TraceCounter::SystemCalls, fs::remove_all(path));
+    project.snapshot->Remove(path);
+}
+
+// Delete a large folder such as Intermediate off the critical path: it is renamed into the trash
+// and unlinked in the background, or deleted in place if it cannot be moved. Throws fs::filesystem_error.
+// Returns true if the folder went to the trash.
+bool TrashProjectDirectory(ProjectContext& project, const fs::path& path)
+{
+    if (project.changePlan || !project.trash)
+    {
+        DeleteProjectPath(project, path);
+        return false;
+    }
+    if (project.journal && !project.journal->RecordDelete(path))
+    {
+        throw fs::filesystem_error("Could not write the rename journal", path, std::make_error_code(std::errc::io_error));
+    }
+
+    TraceSpan span("MoveToTrash", "delete");
+    span.SetDetail(path);
+
+    std::error_code error;
+    bool trashed = project.trash->MoveToTrash(path, error);
+    if (!trashed)
+    {
+        span.Add(TraceCounter::SystemCalls, fs::remove_all(path));
+    }
+    project.snapshot->Remove(path);
+    return trashed;
+}
+
+// Replace the names in the content of a file and return the number of replacements made. Files
+// without a match are left alone. With backupFirst the original content is backed up first. In a
+// dry run the edit is only recorded; otherwise it is journaled and newContent is left to be written.
+size_t ReplaceFileContent(ProjectContext& project, const fs::path& filePath, std::string_view content, const MultiReplacer& replacer, LogBuffer& log, bool backupFirst, std::string& newContent)
+{
+    std::vector<ReplaceMatch> matches = replacer.FindMatches(content);
+    TraceAdd(TraceCounter::Matches, matches.size());
+    if (matches.empty())
+    {
+        log.WriteVerbose(COLOUR_WHITE, "\nNo names to replace in ", filePath);
+        return 0;
+    }
+
+    if (backupFirst)
+    {
+        BackupFileContent(project, filePath, content, log);
+    }
+
+    size_t replacements = replacer.Apply(content, matches, newContent);
+
+    if (project.changePlan)
+    {
+        // The matches are the exact byte ranges the rewrite replaces
+        std::vector<ChangePlan::TextEdit> edits;
+        edits.reserve(matches.size());
+        for (const auto& match : matches)
+        {
+            edits.push_back({ match.position, replacer.From(match.pattern).size(), replacer.To(match.pattern) });
+        }
+        project.changePlan->RecordEdit(filePath, content, newContent, std::move(edits));
+        return replacements;
+    }
+
+    std::string originalHash = ContentHash(project, content);
+    MakeFileWritable(filePath, log);
+
+    if (!RecordFileEdit(project, filePath, originalHash, newContent))
+    {
+        log.WriteError(COLOUR_RED, "\nERROR: Failed to write file ", filePath);
+        return 0;
+    }
+    return replacements;
+}
+
+// Rewrite a file through a replacer and return the number of replacements made.
+// The file is scanned in place through a memory mapping; files without a match are never
+// copied, backed up or opened for writing, so their timestamps stay untouched.
+// With backupFirst the original is backed up straight from the same mapping.
+size_t RewriteFile(ProjectContext& project, const fs::path& filePath, const MultiReplacer& replacer, LogBuffer& log, bool backupFirst = false)
+{
+    // Rewriting a file the interrupted run already rewrote could apply a replacement twice
+    if (project.progress && project.progress->IsEditDone(filePath)) return 0;
+
+    TraceSpan span("RewriteFile", "file");
+    span.SetDetail(filePath);
+
+    std::string fileContent;
+    size_t replacements = 0;
+    {
+        MappedFile file(filePath);
+        if (!file.IsOpen())
+        {
+            log.WriteError(COLOUR_RED, "\nERROR: Failed to open file ", filePath);
+            return 0;
+        }
+        replacements = ReplaceFileContent(project, filePath, file.View(), replacer, log, backupFirst, fileContent);
+    }
+    if (replacements == 0 || project.changePlan) return replacements;
+
+    std::error_code error;
+    if (!SyncFileEdits(project) || !WriteFileAtomically(filePath, fileContent, error))
+    {
+        log.WriteError(COLOUR_RED, "\nERROR: Failed to write file ", filePath);
+        return 0;
+    }
+    if (project.progress) project.progress->RecordWritten(filePath);
+    return replacements;
+}
+
+// A file the planning pass found to contain at least one rename token
+struct PlannedEdit
+{
+    fs::path filePath;
+    std::vector<ReplaceMatch> matches; // Byte ranges that will change
+};
+
+// Leave out the files the interrupted run being resumed already rewrote, at one lookup and one stat each
+std::vector<fs::path> WithoutCompletedFiles(ProjectContext& project, const std::vector<fs::path>& files, const std::string& description)
+{
+    if (!project.progress || !project.progress->IsResumed()) return files;
+
+    std::vector<fs::path> remaining;
+    for (const auto& filePath : files)
+    {
+        if (!project.progress->IsEditDone(filePath))
+        {
+            remaining.push_back(filePath);
+        }
+    }
+
+    if (remaining.size() < files.size())
+    {
+        LogMessage(project, COLOUR_GREEN, "\nSkipping ", files.size() - remaining.size(), " ", description, "s already updated before the run was interrupted");
+    }
+    return remaining;
+}
+
+// Scan files in parallel without modifying anything and return only those that will change.
+// The files are read through the I/O backend and scanned on the pool as they come in.
+std::vector<PlannedEdit> PlanRewrites(const std::vector<fs::path>& files, const MultiReplacer& replacer)
+{
+    std::vector<PlannedEdit> plan(files.size());
+
+    fileIo->ReadFiles(files, [&files, &replacer, &plan](size_t i, std::string_view content, bool isRead)
+        {
+            TraceSpan span("ScanFile", "file");
+            span.SetDetail(files[i]);
+            if (isRead)
+            {
+                plan[i].matches = replacer.FindMatches(content);
+                span.Add(TraceCounter::Matches, plan[i].matches.size());
+            }
+            plan[i].filePath = files[i];
+        });
+
+    plan.erase(std::remove_if(plan.begin(), plan.end(), [](const PlannedEdit& edit) { return edit.matches.empty(); }), plan.end());
+    return plan;
+}
+
+// Files rewritten together; their new content stays in memory until the whole batch is written
+constexpr size_t RewriteBatchSize = 256;
+
+// Back up and rewrite every planned file. Each batch is read through the I/O backend, replaced, backed
+// up and journaled on the pool as the files come in, and then written back through the backend at once.
+void ApplyPlannedEdits(ProjectContext& project, const std::vector<PlannedEdit>& plan, const MultiReplacer& replacer, const std::string& description)
+{
+    size_t firstChange = project.changePlan ? project.changePlan->Size() : 0;
+
+    for (size_t batchStart = 0; batchStart < plan.size(); batchStart += RewriteBatchSize)
+    {
+        size_t batchSize = std::min(RewriteBatchSize, plan.size() - batchStart);
+        std::vector<fs::path> files;
+        std::deque<LogBuffer> logs;
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            files.push_back(plan[batchStart + i].filePath);
+            logs.emplace_back(project);
+        }
+
+        std::vector<std::string> contents(batchSize);
+        std::vector<size_t> replacements(batchSize, 0);
+        fileIo->ReadFiles(files, [&](size_t i, std::string_view content, bool isRead)
+            {
+                // Rewriting a file the interrupted run already rewrote could apply a replacement twice
+                if (project.progress && project.progress->IsEditDone(files[i])) return;
+
+                TraceSpan span("RewriteFile", "file");
+                span.SetDetail(files[i]);
+                if (!isRead)
+                {
+                    logs[i].WriteError(COLOUR_RED, "\nERROR: Failed to open file ", files[i]);
+                    return;
+                }
+                replacements[i] = ReplaceFileContent(project, files[i], content, replacer, logs[i], true, contents[i]);
+            });
+
+        if (!project.changePlan)
+        {
+            std::vector<FileWrite> writes;
+            std::vector<size_t> writtenFiles;
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                if (replacements[i] > 0)
+                {
+                    writes.push_back({ files[i], contents[i] });
+                    writtenFiles.push_back(i);
+                }
+            }
+
+            // The records of the whole batch go to disk at once, before any of its files
+            if (!writes.empty() && !SyncFileEdits(project))
+            {
+                for (size_t i : writtenFiles)
+                {
+                    logs[i].WriteError(COLOUR_RED, "\nERROR: Failed to write file ", files[i]);
+                    replacements[i] = 0;
+                }
+                writes.clear();
+            }
+
+            std::vector<std::error_code> errors;
+            fileIo->WriteFiles(writes, errors);
+            for (size_t w = 0; w < writes.size(); ++w)
+            {
+                size_t i = writtenFiles[w];
+                if (errors[w])
+                {
+                    logs[i].WriteError(COLOUR_RED, "\nERROR: Failed to write file ", files[i]);
+                    replacements[i] = 0;
+                }
+                else if (project.progress)
+                {
+                    project.progress->RecordWritten(files[i]);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            if (replacements[i] > 0)
+            {
+                logs[i].Write(COLOUR_GREEN, project.changePlan ? "\nWould update " : "\nSuccessfully updated ", description, ": ", files[i]);
+            }
+            logs[i].Flush();
+        }
+    }
+
+    // Keep the dry run output in a stable order however the workers finished
+    if (project.changePlan)
+    {
+        project.changePlan->SortSince(firstChange);
+    }
+}
+
+// Print how much of a scanned set of files the plan will touch
+void LogPlanSummary(ProjectContext& project, const std::vector<PlannedEdit>& plan, size_t scannedFiles, const std::string& description)
+{
+    size_t replacements = 0;
+    for (const auto& edit : plan)
+    {
+        replacements += edit.matches.size();
+    }
+
+    LogMessage(project, COLOUR_GREEN, "\nPlanned ", replacements, " replacements in ", plan.size(), " of ", scannedFiles, " ", description, "s");
+}
+
+
+// Backup / issue warning
+bool DisplayWarningAndGetConfirmation()
+{
+    std::string userInput;
+
+    // Nothing is changed in a dry run, so there is nothing to warn about
+    if (isDryRun)
+    {
+        return true;
+    }
+
+    // Unattended runs accept the warning through --yes
+    if (assumeYes)
+    {
+        if (consoleLogLevel > LogLevel::Info) return true;
+        FlushLog();
+        SetConsoleColour(COLOUR_GREEN);
+        std::cout << "\nBackup warning accepted with --yes. Proceeding with the operation..." << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+        return true;
+    }
+
+    if (isBatchMode)
+    {
+        FlushLog();
+        SetConsoleColour(COLOUR_RED);
+        std::cerr << "\nERROR: Unattended runs must pass --yes to accept that a manual backup is recommended." << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+        return false;
+    }
+
+    while (true)
+    {
+        FlushLog();
+        SetConsoleColour(COLOUR_ORANGE);
+        std::cout << "\nINFO: While this software does automatically create a backup of all changed files, it's still recommended to make a manual backup yourself." << std::endl;
+        std::cout << "\nTo declare you have made a backup and or that you accept the consequences, type 'YES': ";
+        std::getline(std::cin, userInput);
+
+        if (userInput == "YES")
+        {
+            SetConsoleColour(COLOUR_GREEN);
+            std::cout << "Successfully accepted. Proceeding with the operation..." << std::endl;
+            SetConsoleColour(COLOUR_WHITE);
+            return true;
+        }
+        else
+        {
+            SetConsoleColour(COLOUR_RED);
+            std::cout << "ERROR: Invalid input. Please type 'YES' to confirm you have made a backup and accept the consequences." << std::endl;
+            SetConsoleColour(COLOUR_WHITE);
+        }
+    }
+}
+
+bool SelectProjectPath(ProjectContext& project)
+{
+    bool isValidDirectory = false;
+    bool foundUprojectFile = false;
+    bool attempted = false;
+
+    while (!isValidDirectory || !foundUprojectFile)
+    {
+        if (isBatchMode)
+        {
+            // The path given with --project is only validated once
+            if (attempted) return false;
+            attempted = true;
+        }
+        else
+        {
+            FlushLog();
+            SetConsoleColour(COLOUR_WHITE);
+            std::cout << "\nPlease enter the project root directory: ";
+            std::getline(std::cin, project.projectRootDirectory);
+        }
+
+        // Check if the directory exists
+        if (fs::exists(project.projectRootDirectory) && fs::is_directory(project.projectRootDirectory))
+        {
+            isValidDirectory = true;
+            LogMessage(project, COLOUR_GREEN, "\nSuccessfully located directory");
+
+            // Every later step looks at the project through this one listing of it
+            project.snapshot = std::make_unique<ProjectSnapshot>(project.projectRootDirectory);
+            project.snapshot->Walk(*threadPool);
+
+            // Look for a .uproject file in the directory
+            foundUprojectFile = false;
+            for (const auto& entry : project.snapshot->List(project.projectRootDirectory))
+            {
+                if (!entry.isDirectory && entry.path.extension() == ".uproject")
+                {
+                    project.oldUprojectFilePath = entry.path;
+                    foundUprojectFile = true;
+                    LogMessage(project, COLOUR_GREEN, "Successfully validated that directory is an Unreal engine project");
+                    break;
+                }
+            }
+
+            if (!foundUprojectFile)
+            {
+                LogMessage(project, COLOUR_RED, "\nERROR: No .uproject file found in the directory. Please try again.");
+            }
+        }
+        else
+        {
+            LogMessage(project, COLOUR_RED, "\nERROR: The provided path is not a valid directory. Please try again.");
+            isValidDirectory = false;
+        }
+    }
+    return true;
+}
+
+void CreateBackupFolder(ProjectContext& project)
+{
+    // Create the backup directory path
+    project.backupDirectory = fs::path(project.projectRootDirectory) / "UEPR_Backups";
+
+    if (project.changePlan)
+    {
+        LogMessage(project, COLOUR_GREEN, "\nDry run: no backup folder is created and no files are changed.");
+        return;
+    }
+
+    // Create the UEPR_Backups directory if it doesn't exist
+    if (!project.snapshot->IsDirectory(project.backupDirectory))
+    {
+        fs::create_directory(project.backupDirectory);
+        LogMessage(project, COLOUR_GREEN, "\nCreated backup directory: ", project.backupDirectory);
+    }
+
+    // An interrupted rename to the same name is resumed in its own run folder, so nothing is done twice
+    std::string unfinishedName;
+    fs::path unfinishedRun = ProgressLedger::FindUnfinishedRun(project.backupDirectory, unfinishedName);
+    if (!unfinishedRun.empty() && unfinishedName == project.newProjectName)
+    {
+        project.backupFolderName = unfinishedRun.filename().string();
+        LogMessage(project, COLOUR_GREEN, "\nResuming the interrupted rename to ", unfinishedName, " from backup folder: ", unfinishedRun);
+    }
+    else
+    {
+        if (!unfinishedRun.empty())
+        {
+            LogMessage(project, COLOUR_ORANGE, "\nWARNING: A rename to ", unfinishedName, " was interrupted. Run again with that name to finish it, or undo it with --rollback ", unfinishedRun);
+        }
+
+        // Get current date and time
+        auto now = std::chrono::system_clock::now();
+        std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+        std::tm now_tm = ToLocalTime(now_time);
+
+        // Format the date and time as "YYYY-MM-DD_HH-MM-SS"
+        std::stringstream ss;
+        ss << std::put_time(&now_tm, "%Y-%m-%d_%H-%M-%S");
+        project.backupFolderName = ss.str();
+    }
+
+    // Create the date-time named folder inside UEPR_Backups
+    fs::path storeDirectory = project.backupDirectory;
+    project.backupDirectory /= project.backupFolderName;
+    if (!fs::exists(project.backupDirectory))
+    {
+        fs::create_directory(project.backupDirectory);
+        LogMessage(project, COLOUR_GREEN, "\nCreated date-time backup folder: ", project.backupDirectory);
+    }
+
+    // File contents are shared between runs through UEPR_Backups/Objects
+    project.backupStore = std::make_unique<BackupStore>(storeDirectory, project.backupDirectory);
+
+    // Every change of the run is journaled next to the backups, for --rollback
+    project.journal = std::make_unique<Journal>(project.projectRootDirectory, project.backupDirectory);
+
+    // What the run has finished is recorded as it goes, so it can be resumed if it is interrupted
+    project.progress = std::make_unique<ProgressLedger>(project.projectRootDirectory, project.backupDirectory);
+}
+
+void CheckIfCPPProject(ProjectContext& project)
+{
+    fs::path sourcePath = fs::path(project.projectRootDirectory) / "Source";
+
+    if (project.snapshot->IsDirectory(sourcePath))
+    {
+        project.isCPPProject = true;
+        LogMessage(project, COLOUR_GREEN, "\nCPP Project Detected");
+    }
+    else
+    {
+        project.isCPPProject = false;
+        LogMessage(project, COLOUR_GREEN, "\nBlueprint Only Project Detected");
+    }
+}
+
+
+// Set new project name
+bool SetNewProjectName(ProjectContext& project)
+{
+    const std::string invalidChars = "\\/:*?\"<>|";
+    bool attempted = false;
+
+    while (true)
+    {
+        if (isBatchMode)
+        {
+            // The name given with --name is only validated once
+            if (attempted) return false;
+            attempted = true;
+        }
+        else
+        {
+            // Set new project name
+            FlushLog();
+            SetConsoleColour(COLOUR_WHITE);
+            std::cout << "\nPlease enter the new desired project name: ";
+            std::getline(std::cin, project.newProjectName);
+        }
+
+        if (project.newProjectName.empty())
+        {
+            LogMessage(project, COLOUR_RED, "ERROR: Project name cannot be empty. Please try again.");
+            continue;
+        }
+
+        if (project.newProjectName.length() > 255)
+        {
+            LogMessage(project, COLOUR_RED, "ERROR: Project name is too long. Please use a name with 255 characters or fewer.");
+            continue;
+        }
+
+        bool isValid = true;
+        for (char c : project.newProjectName)
+        {
+            if (invalidChars.find(c) != std::string::npos)
+            {
+                LogMessage(project, COLOUR_RED, "ERROR: Project name contains invalid characters. Avoid using: \\ / : * ? \" < > |");
+                isValid = false;
+                break;
+            }
+        }
+
+        if (isValid)
+        {
+            return true;
+        }
+    }
+}
+
+
+// Read a .uproject or .uplugin file as the rename left it so far
+bool ReadDescriptor(ProjectContext& project, const fs::path& filePath, ProjectDescriptor& descriptor, std::string& content)
+{
+    std::string error;
+    if (!ReadProjectFile(project, filePath, content))
+    {
+        error = "the file could not be opened";
+    }
+    else if (descriptor.Parse(content, error))
+    {
+        return true;
+    }
+
+    LogMessage(project, COLOUR_RED, "\nERROR: Could not read the modules of ", filePath, ": ", error);
+    return false;
+}
+
+// Modules live in the project's Source folder and in the Source folder of each project plugin
+void FindModuleSourceDirectories(ProjectContext& project)
+{
+    project.pluginDescriptors = FindPluginDescriptors(*project.snapshot, project.projectRootDirectory);
+    project.moduleSourceDirectories = { fs::path(project.projectRootDirectory) / "Source" };
+    for (const auto& pluginDescriptor : project.pluginDescriptors)
+    {
+        project.moduleSourceDirectories.push_back(pluginDescriptor.parent_path() / "Source");
+    }
+}
+
+// Find every module of the project and of its plugins and decide its new name. The primary module,
+// --module or the first module of the .uproject, takes the new project name; modules named after it
+// or after the project keep their suffix, so MyGameEditor becomes <NewName>Editor. Nothing is changed yet.
+bool FindProjectModules(ProjectContext& project)
+{
+    ProjectDescriptor uproject;
+    std::string content;
+    if (!ReadDescriptor(project, project.oldUprojectFilePath, uproject, content))
+    {
+        return false;
+    }
+
+    std::vector<std::string> declaredModules;
+    for (const auto& module : uproject.Modules())
+    {
+        declaredModules.push_back(module.name);
+    }
+    if (project.userCPPSourceName.empty() && !declaredModules.empty())
+    {
+        project.userCPPSourceName = declaredModules.front();
+    }
+
+    FindModuleSourceDirectories(project);
+    for (const auto& pluginDescriptor : project.pluginDescriptors)
+    {
+        ProjectDescriptor plugin;
+        if (!ReadDescriptor(project, pluginDescriptor, plugin, content))
+        {
+            return false;
+        }
+        for (const auto& module : plugin.Modules())
+        {
+            declaredModules.push_back(module.name);
+        }
+    }
+
+    std::map<std::string, fs::path> buildFiles;
+    for (const auto& sourceDirectory : project.moduleSourceDirectories)
+    {
+        FindBuildFiles(*project.snapshot, sourceDirectory, buildFiles);
+    }
+
+    if (project.isCPPProject && project.userCPPSourceName.empty())
+    {
+        LogMessage(project, COLOUR_RED, "\nERROR: Could not find the module name in the .uproject file. Use --module to name it.");
+        return false;
+    }
+    if (!project.userCPPSourceName.empty() && buildFiles.find(project.userCPPSourceName) == buildFiles.end())
+    {
+        LogMessage(project, COLOUR_RED, "\nERROR: No ", project.userCPPSourceName, ".Build.cs file found for module ", project.userCPPSourceName, " in the Source directory.");
+        return false;
+    }
+
+    // Modules without a .Build.cs, such as those of binary-only plugins, are still declared by name
+    std::set<std::string> moduleNames(declaredModules.begin(), declaredModules.end());
+    for (const auto& [name, buildFile] : buildFiles)
+    {
+        moduleNames.insert(name);
+    }
+
+    std::vector<std::string> oldNames = { project.userCPPSourceName, project.oldUprojectFilePath.stem().string() };
+    project.moduleRenames.clear();
+    for (const auto& name : moduleNames)
+    {
+        std::string newName = name == project.userCPPSourceName ? project.newProjectName : RenamedModuleName(name, oldNames, project.newProjectName);
+        if (newName == name)
+        {
+            continue;
+        }
+
+        auto buildFile = buildFiles.find(name);
+        if (buildFile == buildFiles.end())
+        {
+            LogMessage(project, COLOUR_ORANGE, "\nWARNING: Module ", name, " has no source in the project and keeps its name.");
+            continue;
+        }
+        if (moduleNames.count(newName) > 0)
+        {
+            LogMessage(project, COLOUR_RED, "\nERROR: Module ", name, " cannot be renamed to ", newName, ", a module with that name already exists.");
+            return false;
+        }
+        project.moduleRenames.push_back({ name, newName, buildFile->second.parent_path() });
+    }
+
+    LogBuffer log(project);
+    log.Write(COLOUR_GREEN, "\nFound ", moduleNames.size(), " modules in the project and its ", project.pluginDescriptors.size(), " plugins, renaming ", project.moduleRenames.size(), ":");
+    for (const auto& module : project.moduleRenames)
+    {
+        log.Write(COLOUR_GREEN, "  ", module.oldName, " -> ", module.newName);
+    }
+    return true;
+}
+
+// Decide what the run renames and record it in the progress ledger. A resumed run takes the modules
+// from the ledger instead, since the descriptors may name the new modules already.
+bool PrepareModuleRenames(ProjectContext& project)
+{
+    if (!project.progress)
+    {
+        return FindProjectModules(project);
+    }
+
+    if (project.progress->IsResumed())
+    {
+        const ProgressLedger::RunInfo& info = project.progress->Info();
+        project.oldUprojectFilePath = fs::path(project.projectRootDirectory) / (info.oldProjectName + ".uproject");
+        project.userCPPSourceName = info.primaryModule;
+        project.moduleRenames = info.modules;
+        FindModuleSourceDirectories(project);
+
+        LogBuffer log(project);
+        log.Write(COLOUR_GREEN, "\nResuming the rename of ", info.oldProjectName, ", renaming ", project.moduleRenames.size(), " modules:");
+        for (const auto& module : project.moduleRenames)
+        {
+            log.Write(COLOUR_GREEN, "  ", module.oldName, " -> ", module.newName);
+        }
+        return true;
+    }
+
+    if (!FindProjectModules(project))
+    {
+        return false;
+    }
+    if (!project.progress->Begin({ project.oldUprojectFilePath.stem().string(), project.newProjectName, project.userCPPSourceName, project.moduleRenames }))
+    {
+        LogMessage(project, COLOUR_RED, "\nERROR: Could not write the progress ledger, nothing was changed.");
+        return false;
+    }
+    return true;
+}
+
+// Rename the modules listed in the .uproject file and in the .uplugin files of the project plugins
+void EditModuleDescriptors(ProjectContext& project)
+{
+    std::map<std::string, std::string> renames;
+    for (const auto& module : project.moduleRenames)
+    {
+        renames[module.oldName] = module.newName;
+    }
+
+    std::vector<fs::path> descriptorFiles = { project.oldUprojectFilePath };
+    descriptorFiles.insert(descriptorFiles.end(), project.pluginDescriptors.begin(), project.pluginDescriptors.end());
+    for (const auto& descriptorFile : descriptorFiles)
+    {
+        // The .uproject may have been renamed too before the run was interrupted
+        if (project.progress && project.progress->IsEditDone(project.progress->CurrentPath(descriptorFile)))
+        {
+            continue;
+        }
+
+        ProjectDescriptor descriptor;
+        std::string originalContent;
+        if (!ReadDescriptor(project, descriptorFile, descriptor, originalContent))
+        {
+            project.errorCount++;
+            continue;
+        }
+
+        std::string fileContent;
+        if (descriptor.RenameModules(originalContent, renames, fileContent) == 0)
+        {
+            continue;
+        }
+
+        MakeFileWritable(project, descriptorFile);
+        BackupFile(project, descriptorFile);
+        if (!WriteProjectFile(project, descriptorFile, originalContent, fileContent))
+        {
+            project.errorCount++;
+            LogMessage(project, COLOUR_RED, "\nERROR: Error writing to ", descriptorFile);
+            continue;
+        }
+        LogMessage(project, COLOUR_GREEN, "\nSuccessfully renamed the modules of ", descriptorFile);
+    }
+
+    if (!project.isCPPProject)
+    {
+        LogMessage(project, COLOUR_GREEN, "\nNo module name detected in the .uproject file as project is blueprint only.");
+    }
+}
+
+
+// Rename .uproject file
+void RenameUprojectFile(ProjectContext& project)
+{
+    project.newUprojectFilePath = project.oldUprojectFilePath.parent_path() / (project.newProjectName + ".uproject");
+
+    try
+    {
+        MoveProjectPath(project, project.oldUprojectFilePath, project.newUprojectFilePath);
+        LogMessage(project, COLOUR_GREEN, "\nSuccessfully renamed project file to: ", project.newUprojectFilePath);
+    }
+    catch (const fs::filesystem_error& e)
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: Error renaming project file: ", e.what());
+    }
+}
+
+
+// Whether an occurrence is on an #include line, such as "MyGame.h" or "MyGame/Public/Thing.h"
+bool IsIncludeDirective(std::string_view text, size_t position, size_t)
+{
+    size_t lineStart = text.rfind('\n', position);
+    lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+    size_t hash = text.find_first_not_of(" \t", lineStart);
+    if (hash >= position || text[hash] != '#') return false;
+    size_t directive = text.find_first_not_of(" \t", hash + 1);
+    return directive < position && text.substr(directive, 7) == "include";
+}
+
+// Whether an occurrence is a whole argument of an IMPLEMENT_..._MODULE macro after its first, like
+// MyGame in IMPLEMENT_MODULE(FMyGameModule, MyGame) or in IMPLEMENT_PRIMARY_GAME_MODULE(..., MyGame, "MyGame")
+bool IsModuleMacroArgument(std::string_view text, size_t position, size_t length)
+{
+    auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+
+    size_t end = position + length;
+    while (end < text.size() && isSpace(text[end])) end++;
+    if (end == text.size() || (text[end] != ',' && text[end] != ')')) return false;
+
+    size_t start = position;
+    while (start > 0 && isSpace(text[start - 1])) start--;
+    if (start == 0 || text[start - 1] != ',') return false;
+
+    // The earlier arguments are plain names, so the macro's parenthesis is the last one before them
+    size_t open = text.rfind('(', start - 1);
+    if (open == std::string_view::npos || text.find_first_of(");", open) < start) return false;
+
+    size_t nameEnd = open;
+    while (nameEnd > 0 && isSpace(text[nameEnd - 1])) nameEnd--;
+    size_t nameStart = nameEnd;
+    while (nameStart > 0 && (std::isalnum(static_cast<unsigned char>(text[nameStart - 1])) || text[nameStart - 1] == '_')) nameStart--;
+    std::string_view macro = text.substr(nameStart, nameEnd - nameStart);
+    return macro.starts_with("IMPLEMENT_") && macro.ends_with("MODULE");
+}
+
+// How module names are spelled where they are referenced, and where that spelling counts. C# rules
+// name a module as its class and constructor and as a quoted dependency. In C++ sources only include
+// directives and the IMPLEMENT_MODULE macros and friends are rewritten, besides <MODULE>_API, so
+// strings and arguments that merely equal a module name are left alone.
+struct NameDecoration
+{
+    const char* prefix;
+    const char* suffix;
+    MultiReplacer::MatchFilter accept = nullptr;
+};
+
+const NameDecoration RulesNameDecorations[] = {
+    { "\"", "\"" }, { "class ", " " }, { "class ", ":" }, { "public ", "(" } };
+const NameDecoration SourceNameDecorations[] = {
+    { "\"", ".h\"", IsIncludeDirective }, { "/", ".h\"", IsIncludeDirective }, { "\"", "/", IsIncludeDirective },
+    { "<", ".h>", IsIncludeDirective }, { "/", ".h>", IsIncludeDirective }, { "<", "/", IsIncludeDirective },
+    { "", "", IsModuleMacroArgument }, { "\"", "\"", IsModuleMacroArgument } };
+
+template <size_t Count>
+void AddModuleRenames(MultiReplacer& replacer, const ProjectContext& project, const NameDecoration (&decorations)[Count])
+{
+    for (const auto& module : project.moduleRenames)
+    {
+        for (const auto& decoration : decorations)
+        {
+            replacer.Add(decoration.prefix + module.oldName + decoration.suffix, decoration.prefix + module.newName + decoration.suffix, decoration.accept);
+        }
+    }
+}
+
+std::string ApiMacroName(const std::string& moduleName)
+{
+    std::string macroName = moduleName + "_API";
+    std::transform(macroName.begin(), macroName.end(), macroName.begin(),
+        [](unsigned char c)
+        {
+            return std::toupper(c);
+        });
+    return macroName;
+}
+
+
+// Target rules name the target as a class and list the modules they build by name
+MultiReplacer TargetReplacer(const ProjectContext& project, const std::string& oldTargetName)
+{
+    MultiReplacer replacer;
+    AddModuleRenames(replacer, project, RulesNameDecorations);
+    replacer.Add(oldTargetName, project.newProjectName);
+    replacer.Compile();
+    return replacer;
+}
+
+// Locate target files
+void EditTargetFiles(ProjectContext& project)
+{
+    project.sourceDirectory = fs::path(project.projectRootDirectory) / "Source";
+
+    if (!project.snapshot->IsDirectory(project.sourceDirectory))
+    {
+        if (project.isCPPProject)
+        {
+            project.errorCount++;
+            LogMessage(project, COLOUR_RED, "\nERROR: Source directory does not exist.");
+        }
+        else
+        {
+            LogMessage(project, COLOUR_GREEN, "\nNo source directory detected as project is blueprint only.");
+            
+        }
+        return;
+    }
+
+    bool targetFileFound = false;
+    bool editorTargetFileFound = false;
+
+    for (const auto& entry : project.snapshot->List(project.sourceDirectory))
+    {
+        if (!entry.isDirectory)
+        {
+            std::string filename = entry.path.filename().string();
+            std::string oldName = filename.substr(0, filename.find('.'));
+            fs::path newFilePath;
+
+            if (filename.size() > 16 && filename.substr(filename.size() - 16) == "Editor.Target.cs")
+            {
+                editorTargetFileFound = true;
+                oldName = filename.substr(0, filename.size() - 16);
+                newFilePath = project.sourceDirectory / (project.newProjectName + "Editor.Target.cs");
+
+                MakeFileWritable(project, entry.path);
+
+                // Backup the file
+                BackupFile(project, entry.path);
+
+                // Replace contents within the file
+                LogBuffer log(project);
+                RewriteFile(project, entry.path, TargetReplacer(project, oldName), log);
+                log.Flush();
+
+                // Rename the file
+                try
+                {
+                    MoveProjectPath(project, entry.path, newFilePath);
+                    LogMessage(project, COLOUR_GREEN, "\nSuccessfully renamed and updated Editor Target file to: ", newFilePath);
+                }
+                catch (const fs::filesystem_error& e)
+                {
+                    project.errorCount++;
+                    LogMessage(project, COLOUR_RED, "\nERROR: Error renaming Editor Target file ", entry.path, ": ", e.what());
+                }
+                continue;
+            }
+
+            if (filename.size() > 10 && filename.substr(filename.size() - 10) == ".Target.cs")
+            {
+                targetFileFound = true;
+                oldName = filename.substr(0, filename.size() - 10);
+                newFilePath = project.sourceDirectory / (project.newProjectName + ".Target.cs");
+
+                MakeFileWritable(project, entry.path);
+
+                // Backup the file
+                BackupFile(project, entry.path);
+
+                // Replace references within the file
+                LogBuffer log(project);
+                RewriteFile(project, entry.path, TargetReplacer(project, oldName), log);
+                log.Flush();
+
+                // Rename the file
+                try
+                {
+                    MoveProjectPath(project, entry.path, newFilePath);
+                    LogMessage(project, COLOUR_GREEN, "\nSuccessfully renamed and updated Target file to: ", newFilePath);
+                }
+                catch (const fs::filesystem_error& e)
+                {
+                    project.errorCount++;
+                    LogMessage(project, COLOUR_RED, "\nERROR: Error renaming Target file ", entry.path, ": ", e.what());
+                }
+            }
+        }
+    }
+
+    if (!targetFileFound)
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: No Target file found in the Source directory.");
+    }
+
+    if (!editorTargetFileFound)
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: No Editor Target file found in the Source directory.");
+    }
+}
+
+// The C++ sources and module rules of the project and its plugins
+void CollectModuleFiles(const ProjectContext& project, std::vector<fs::path>& sourceFiles, std::vector<fs::path>& rulesFiles)
+{
+    for (const auto& sourceDirectory : project.moduleSourceDirectories)
+    {
+        for (const auto& entry : project.snapshot->ListRecursive(sourceDirectory))
+        {
+            if (entry.isDirectory) continue;
+
+            std::string filename = entry.path.filename().string();
+            std::string extension = entry.path.extension().string();
+            if (extension == ".h" || extension == ".hpp" || extension == ".inl" || extension == ".cpp")
+            {
+                sourceFiles.push_back(entry.path);
+            }
+            else if (filename.size() > 9 && filename.compare(filename.size() - 9, 9, ".Build.cs") == 0)
+            {
+                rulesFiles.push_back(entry.path);
+            }
+        }
+    }
+}
+
+// Every file directly in the Config folder
+std::vector<fs::path> CollectConfigFiles(const ProjectContext& project)
+{
+    std::vector<fs::path> configFiles;
+    for (const auto& entry : project.snapshot->List(fs::path(project.projectRootDirectory) / "Config"))
+    {
+        if (!entry.isDirectory)
+        {
+            configFiles.push_back(entry.path);
+        }
+    }
+    return configFiles;
+}
+
+// Every file the reference index covers: module sources and rules, and the config files
+std::vector<fs::path> CollectIndexedFiles(const ProjectContext& project)
+{
+    std::vector<fs::path> files;
+    CollectModuleFiles(project, files, files);
+    std::vector<fs::path> configFiles = CollectConfigFiles(project);
+    files.insert(files.end(), configFiles.begin(), configFiles.end());
+    return files;
+}
+
+fs::path ReferenceIndexFile(const ProjectContext& project)
+{
+    return fs::path(project.projectRootDirectory) / "UEPR_Backups" / ReferenceIndex::IndexFileName;
+}
+
+// The old names of every renamed module and their API macros, which every rewrite pattern contains
+std::vector<std::string> OldModuleNames(const ProjectContext& project)
+{
+    std::vector<std::string> names;
+    for (const auto& module : project.moduleRenames)
+    {
+        names.push_back(module.oldName);
+        names.push_back(ApiMacroName(module.oldName));
+    }
+    return names;
+}
+
+// Load the reference index and bring it up to date for the old module names. The new names are
+// indexed too wherever a file is read, so a later rename or --where query can use them.
+void RefreshReferenceIndex(ProjectContext& project)
+{
+    if (project.moduleRenames.empty()) return;
+
+    std::vector<std::string> newNames;
+    for (const auto& module : project.moduleRenames)
+    {
+        newNames.push_back(module.newName);
+        newNames.push_back(ApiMacroName(module.newName));
+    }
+
+    std::vector<fs::path> files = CollectIndexedFiles(project);
+    project.referenceIndex = std::make_unique<ReferenceIndex>(project.projectRootDirectory, ReferenceIndexFile(project));
+    project.referenceIndex->Load();
+    size_t readFiles = project.referenceIndex->Refresh(files, OldModuleNames(project), newNames, *threadPool, project.snapshot.get());
+
+    LogMessage(project, COLOUR_GREEN, "\nReference index is up to date, read ", readFiles, " of ", files.size(), " source and config files");
+}
+
+// Leave out the files the reference index shows to mention no old module name
+std::vector<fs::path> FilesMentioningOldNames(const ProjectContext& project, const std::vector<fs::path>& files)
+{
+    if (!project.referenceIndex) return files;
+    return project.referenceIndex->FilesMentioning(files, OldModuleNames(project));
+}
+
+// Save the reference index with the run's renames applied. Edited files are searched again next
+// time, since their size or modification time changed.
+void SaveReferenceIndex(ProjectContext& project)
+{
+    if (!project.referenceIndex || project.changePlan) return;
+
+    project.referenceIndex->ApplyRenames(project.renamedPaths);
+
+    // The index only saves time, so failing to write it is not an error
+    std::string error;
+    if (!project.referenceIndex->Save(error))
+    {
+        LogMessage(project, COLOUR_ORANGE, "\nWARNING: Could not save the reference index: ", error);
+    }
+}
+
+// Rename the files of one module named after it: <Module>.Build.cs, <Module>.h and <Module>.cpp.
+// The module folder itself is renamed later, once every module's files are done.
+void RenameModuleFiles(ProjectContext& project, const ModuleRename& module, LogBuffer& log)
+{
+    std::vector<std::pair<fs::path, const char*>> files = { { module.directory / (module.oldName + ".Build.cs"), ".Build.cs" } };
+
+    for (const auto& entry : project.snapshot->ListRecursive(module.directory))
+    {
+        const fs::path& filePath = entry.path;
+        if (entry.isDirectory || filePath.stem() != module.oldName) continue;
+
+        if (filePath.extension() == ".h") files.emplace_back(filePath, ".h");
+        else if (filePath.extension() == ".cpp") files.emplace_back(filePath, ".cpp");
+    }
+
+    for (const auto& [filePath, extension] : files)
+    {
+        fs::path newFilePath = filePath.parent_path() / (module.newName + extension);
+        try
+        {
+            MakeFileWritable(filePath, log);
+            MoveProjectPath(project, filePath, newFilePath);
+            log.Write(COLOUR_GREEN, "\nSuccessfully renamed ", extension, " file to: ", newFilePath);
+        }
+        catch (const fs::filesystem_error& e)
+        {
+            log.WriteError(COLOUR_RED, "\nERROR: Error renaming ", filePath, ": ", e.what());
+        }
+    }
+}
+
+// Rename every module found by FindProjectModules. All C++ sources and module rules of the project
+// and its plugins are rewritten in one parallel pass, the files of each module are renamed on the
+// pool, and the module folders are renamed last, innermost first.
+void RenameModules(ProjectContext& project)
+{
+    if (project.moduleRenames.empty())
+    {
+        if (!project.isCPPProject)
+        {
+            LogMessage(project, COLOUR_GREEN, "\nNo source directory detected as project is blueprint only.");
+        }
+        return;
+    }
+
+    MultiReplacer sourceReplacer;
+    for (const auto& module : project.moduleRenames)
+    {
+        sourceReplacer.Add(ApiMacroName(module.oldName), ApiMacroName(module.newName));
+    }
+    AddModuleRenames(sourceReplacer, project, SourceNameDecorations);
+    sourceReplacer.Compile();
+
+    MultiReplacer rulesReplacer;
+    AddModuleRenames(rulesReplacer, project, RulesNameDecorations);
+    rulesReplacer.Compile();
+
+    // Modules that are not renamed can still include, export through or depend on one that is.
+    // Only files the reference index cannot rule out are read.
+    std::vector<fs::path> sourceFiles;
+    std::vector<fs::path> rulesFiles;
+    CollectModuleFiles(project, sourceFiles, rulesFiles);
+    sourceFiles = WithoutCompletedFiles(project, FilesMentioningOldNames(project, sourceFiles), "source file");
+    rulesFiles = WithoutCompletedFiles(project, FilesMentioningOldNames(project, rulesFiles), ".Build.cs file");
+
+    std::vector<PlannedEdit> rulesPlan = PlanRewrites(rulesFiles, rulesReplacer);
+    LogPlanSummary(project, rulesPlan, rulesFiles.size(), ".Build.cs file");
+    ApplyPlannedEdits(project, rulesPlan, rulesReplacer, ".Build.cs file");
+
+    std::vector<PlannedEdit> sourcePlan = PlanRewrites(sourceFiles, sourceReplacer);
+    LogPlanSummary(project, sourcePlan, sourceFiles.size(), "source file");
+    ApplyPlannedEdits(project, sourcePlan, sourceReplacer, "source file");
+
+    size_t firstChange = project.changePlan ? project.changePlan->Size() : 0;
+    TaskGroup group;
+    for (const auto& module : project.moduleRenames)
+    {
+        threadPool->Submit(group, [&project, &module]()
+            {
+                LogBuffer log(project);
+                RenameModuleFiles(project, module, log);
+                log.Flush();
+            });
+    }
+    threadPool->Wait(group);
+    if (project.changePlan)
+    {
+        project.changePlan->SortSince(firstChange);
+    }
+
+    // A module folder can hold another module's folder, so the deepest folders go first
+    std::vector<const ModuleRename*> folderRenames;
+    for (const auto& module : project.moduleRenames)
+    {
+        if (module.directory.filename() == module.oldName)
+        {
+            folderRenames.push_back(&module);
+        }
+    }
+    std::stable_sort(folderRenames.begin(), folderRenames.end(), [](const ModuleRename* a, const ModuleRename* b)
+        {
+            return std::distance(a->directory.begin(), a->directory.end()) > std::distance(b->directory.begin(), b->directory.end());
+        });
+
+    for (const ModuleRename* module : folderRenames)
+    {
+        fs::path newFolderPath = module->directory.parent_path() / module->newName;
+        try
+        {
+            MoveProjectPath(project, module->directory, newFolderPath);
+            LogMessage(project, COLOUR_GREEN, "\nSuccessfully renamed C++ source folder to: ", newFolderPath);
+        }
+        catch (const fs::filesystem_error& e)
+        {
+            project.errorCount++;
+            LogMessage(project, COLOUR_RED, "\nError: Error renaming C++ source folder: ", e.what());
+        }
+    }
+}
+
+// Function to edit config files
+void EditConfigFiles(ProjectContext& project)
+{
+    fs::path configDirectory = fs::path(project.projectRootDirectory) / "Config";
+    fs::path defaultEngineIniPath = configDirectory / "DefaultEngine.ini";
+
+    if (!project.snapshot->IsDirectory(configDirectory))
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: Config directory does not exist.");
+        return;
+    }
+
+    // Classes are referenced as /Script/<Module>.<Class>, for every renamed module
+    MultiReplacer configReplacer;
+    configReplacer.Add(project.userCPPSourceName, project.newProjectName);
+    for (const auto& module : project.moduleRenames)
+    {
+        configReplacer.Add("/Script/" + module.oldName, "/Script/" + module.newName);
+    }
+    configReplacer.Compile();
+
+    // Plan the config rewrites so only files that reference the module are backed up
+    std::vector<fs::path> configFiles = WithoutCompletedFiles(project, FilesMentioningOldNames(project, CollectConfigFiles(project)), "config file");
+
+    std::vector<PlannedEdit> configPlan = PlanRewrites(configFiles, configReplacer);
+    LogPlanSummary(project, configPlan, configFiles.size(), "config file");
+    ApplyPlannedEdits(project, configPlan, configReplacer, "config file");
+
+    // Specific logic for DefaultEngine.ini
+    if (project.snapshot->IsFile(defaultEngineIniPath))
+    {
+        std::string originalContent;
+        ReadProjectFile(project, defaultEngineIniPath, originalContent);
+        std::string fileContent = originalContent;
+
+        // Check for [URL] section
+        std::size_t urlPos = fileContent.find("[URL]");
+        if (urlPos == std::string::npos)
+        {
+            // Add [URL] section if it doesn't exist
+            fileContent += "\n[URL]\nGameName=" + project.newProjectName + "\n";
+        }
+        else
+        {
+            // Check for GameName= under [URL] section
+            std::size_t gameNamePos = fileContent.find("GameName=", urlPos);
+            std::size_t nextSectionPos = fileContent.find('[', urlPos + 1);
+            if (gameNamePos == std::string::npos || (nextSectionPos != std::string::npos && gameNamePos > nextSectionPos))
+            {
+                // Add GameName= under [URL] section if it doesn't exist
+                fileContent.insert(urlPos + 5, "\nGameName=" + project.newProjectName + "\n");
+            }
+            else
+            {
+                // Update GameName= value if it exists
+                std::size_t endOfLinePos = fileContent.find('\n', gameNamePos);
+                fileContent.replace(gameNamePos, endOfLinePos - gameNamePos, "GameName=" + project.newProjectName);
+            }
+        }
+
+        // Check for [/Script/Engine.Engine] section
+        std::size_t enginePos = fileContent.find("[/Script/Engine.Engine]");
+        if (enginePos == std::string::npos)
+        {
+            // Add [/Script/Engine.Engine] section if it doesn't exist
+            fileContent += "\n[/Script/Engine.Engine]\n+ActiveGameNameRedirects=(OldGameName=\"/Script/" + project.userCPPSourceName + "\", NewGameName=\"/Script/" + project.newProjectName + "\")";
+        }
+        else
+        {
+            // Check for +ActiveGameNameRedirects under [/Script/Engine.Engine]
+            std::size_t redirectsPos = fileContent.find("+ActiveGameNameRedirects=", enginePos);
+            std::size_t nextSectionPos = fileContent.find('[', enginePos + 1);
+
+            bool redirectFound = false;
+            std::set<std::string> oldGameNames;
+            std::size_t redirectsEndPos;
+            while (redirectsPos != std::string::npos && (nextSectionPos == std::string::npos || redirectsPos < nextSectionPos))
+            {
+                redirectsEndPos = fileContent.find('\n', redirectsPos);
+                const std::string oldGamePrefix = "OldGameName=\"/Script/";
+                const std::string newGamePrefix = "NewGameName=\"/Script/";
+
+                // Only redirects with both names on this line are read, others are left as they are
+                std::size_t oldGameNameStart = fileContent.find(oldGamePrefix, redirectsPos);
+                std::size_t newGameNameStart = fileContent.find(newGamePrefix, redirectsPos);
+                if (oldGameNameStart != std::string::npos && oldGameNameStart < redirectsEndPos &&
+                    newGameNameStart != std::string::npos && newGameNameStart < redirectsEndPos)
+                {
+                    oldGameNameStart += oldGamePrefix.length();
+                    newGameNameStart += newGamePrefix.length();
+                }
+                else
+                {
+                    oldGameNameStart = std::string::npos;
+                }
+                std::size_t oldGameNameEnd = fileContent.find('\"', oldGameNameStart);
+                std::size_t newGameNameEnd = fileContent.find('\"', newGameNameStart);
+
+                if (oldGameNameStart != std::string::npos && oldGameNameEnd != std::string::npos && newGameNameEnd != std::string::npos)
+                {
+                    std::string oldGameName = fileContent.substr(oldGameNameStart, oldGameNameEnd - oldGameNameStart);
+                    oldGameNames.insert(oldGameName);
+
+                    std::string newGameName = fileContent.substr(newGameNameStart, newGameNameEnd - newGameNameStart);
+                    if (newGameName != project.newProjectName)
+                    {
+                        fileContent.replace(newGameNameStart, newGameNameEnd - newGameNameStart, project.newProjectName);
+                    }
+
+                    redirectFound = true;
+                }
+
+                redirectsPos = fileContent.find("+ActiveGameNameRedirects=", redirectsEndPos);
+            }
+
+            // Ensure there is at least one +ActiveGameNameRedirects entry for the new project name
+            if (!redirectFound || oldGameNames.find(project.userCPPSourceName) == oldGameNames.end())
+            {
+                fileContent.insert(enginePos + std::string("[/Script/Engine.Engine]").length(), "\n+ActiveGameNameRedirects=(OldGameName=\"/Script/" + project.userCPPSourceName + "\", NewGameName=\"/Script/" + project.newProjectName + "\")");
+            }
+        }
+
+        // Assets keep referring to the classes of the other renamed modules by their old package
+        std::string packageRedirects;
+        for (const auto& module : project.moduleRenames)
+        {
+            std::string redirect = "+PackageRedirects=(OldName=\"/Script/" + module.oldName + "\",NewName=\"/Script/" + module.newName + "\")";
+            if (module.oldName != project.userCPPSourceName && fileContent.find(redirect) == std::string::npos)
+            {
+                packageRedirects += '\n';
+                packageRedirects += redirect;
+            }
+        }
+        if (!packageRedirects.empty())
+        {
+            std::size_t coreRedirectsPos = fileContent.find("[CoreRedirects]");
+            if (coreRedirectsPos == std::string::npos)
+            {
+                fileContent += "\n[CoreRedirects]" + packageRedirects + "\n";
+            }
+            else
+            {
+                fileContent.insert(coreRedirectsPos + std::string("[CoreRedirects]").length(), packageRedirects);
+            }
+        }
+
+        // Leave the file and its timestamp alone if the redirects were already in place
+        if (fileContent != originalContent)
+        {
+            MakeFileWritable(project, defaultEngineIniPath);
+            BackupFile(project, defaultEngineIniPath);
+
+            if (WriteProjectFile(project, defaultEngineIniPath, originalContent, fileContent))
+            {
+                LogMessage(project, COLOUR_GREEN, project.changePlan ? "\nWould update DefaultEngine.ini file: " : "\nSuccessfully updated DefaultEngine.ini file: ", defaultEngineIniPath);
+            }
+            else
+            {
+                project.errorCount++;
+                LogMessage(project, COLOUR_RED, "\nERROR: Error writing to DefaultEngine.ini file: ", defaultEngineIniPath);
+            }
+        }
+    }
+    else
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: DefaultEngine.ini file does not exist.");
+    }
+}
+
+// List the assets and maps that reference classes of the renamed modules by their old /Script/<Module>
+// package. Packages are binary and never rewritten; the redirects written to DefaultEngine.ini keep
+// them loading, until they are resaved in the editor. Only package headers are read, so this runs in
+// dry runs too, and while UnrealBuildTool generates the project files.
+void ReportPackageReferences(ProjectContext& project)
+{
+    if (project.moduleRenames.empty()) return;
+
+    std::vector<fs::path> contentDirectories = { fs::path(project.projectRootDirectory) / "Content" };
+    for (const auto& pluginDescriptor : project.pluginDescriptors)
+    {
+        contentDirectories.push_back(pluginDescriptor.parent_path() / "Content");
+    }
+    std::vector<fs::path> packageFiles = PackageScanner::FindPackageFiles(*project.snapshot, contentDirectories);
+    if (packageFiles.empty()) return;
+
+    std::vector<std::string> oldModuleNames;
+    for (const auto& module : project.moduleRenames)
+    {
+        oldModuleNames.push_back(module.oldName);
+    }
+    PackageScanner scanner(oldModuleNames);
+    std::vector<PackageScanner::Result> results = scanner.ScanAll(packageFiles, *threadPool);
+
+    LogBuffer log(project);
+    size_t referencingPackages = 0;
+    size_t unreadablePackages = 0;
+    for (const auto& result : results)
+    {
+        fs::path relativePath = result.packagePath.lexically_relative(project.projectRootDirectory);
+        if (!result.error.empty())
+        {
+            unreadablePackages++;
+            log.Write(COLOUR_ORANGE, "\nWARNING: Could not read package ", relativePath, ": ", result.error);
+            continue;
+        }
+
+        referencingPackages++;
+        log.Write(COLOUR_WHITE, "\n", relativePath, " references:");
+        for (const auto& import : result.imports)
+        {
+            log.Write(COLOUR_WHITE, "    ", import);
+        }
+        for (const auto& name : result.names)
+        {
+            log.Write(COLOUR_WHITE, "    ", name, " (name)");
+        }
+    }
+
+    if (referencingPackages == 0)
+    {
+        log.Write(COLOUR_GREEN, "\nScanned ", packageFiles.size(), " packages, none reference a renamed module");
+    }
+    else
+    {
+        log.Write(COLOUR_GREEN, "\nScanned ", packageFiles.size(), " packages, ", referencingPackages,
+            " reference renamed modules and load through the redirects in DefaultEngine.ini until they are resaved");
+    }
+    if (unreadablePackages > 0)
+    {
+        log.Write(COLOUR_ORANGE, "\n", unreadablePackages, " packages could not be read and may reference renamed modules too");
+    }
+}
+
+// The cache folders of a project. Only Intermediate and Binaries hold build products named after
+// the project and its modules; Saved keeps logs, editor settings, autosaves and shader debug info.
+struct CacheDirectory
+{
+    const char* name;
+    bool holdsBuildProducts;
+};
+
+const CacheDirectory CacheDirectories[] = { { "Saved", false }, { "Intermediate", true }, { "Binaries", true } };
+
+// Whether a build product is named after one of the old names, such as Build/Win64/MyGameEditor,
+// Inc/MyGame, UnrealEditor-MyGame.dll or MyGame.init.gen.cpp
+bool IsStaleCacheEntry(const std::string& filename, const std::vector<std::string>& oldNames)
+{
+    // Module manifests list every module of a binaries folder, and TargetInfo.json every target
+    if (fs::path(filename).extension() == ".modules" || filename == "TargetInfo.json")
+    {
+        return true;
+    }
+
+    // Binaries are named <Target>-<Module>[-<Platform>-<Configuration>], so compare each part before the first '.'
+    static const char* targetSuffixes[] = { "", "Editor", "Client", "Server", "Game", "ModuleRules" };
+    std::string baseName = filename.substr(0, filename.find('.'));
+    std::stringstream parts(baseName);
+    std::string part;
+    while (std::getline(parts, part, '-'))
+    {
+        for (const auto& oldName : oldNames)
+        {
+            for (const char* suffix : targetSuffixes)
+            {
+                if (part == oldName + suffix)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Delete one cache folder or file and report it. Folders go through the trash.
+void DeleteCacheEntry(ProjectContext& project, const fs::path& path, bool isDirectory)
+{
+    try
+    {
+        const char* message = "\nSuccessfully deleted file: ";
+        if (isDirectory)
+        {
+            bool trashed = TrashProjectDirectory(project, path);
+            message = trashed ? "\nMoved directory aside, deleting it in the background: " : "\nSuccessfully deleted directory: ";
+        }
+        else
+        {
+            DeleteProjectPath(project, path);
+        }
+        LogMessage(project, COLOUR_GREEN, message, path);
+    }
+    catch (const fs::filesystem_error& e)
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: Error deleting ", path, ": ", e.what());
+    }
+}
+
+// Delete only the build products named after the old project or module. Everything that does not depend
+// on the name, such as DerivedDataCache, ShaderAutogen and other modules' builds, stays in place.
+void DeleteStaleCacheEntries(ProjectContext& project)
+{
+    std::vector<std::string> oldNames = { project.oldUprojectFilePath.stem().string() };
+    for (const auto& module : project.moduleRenames)
+    {
+        oldNames.push_back(module.oldName);
+    }
+
+    // Collect first, since entries cannot be moved while their folder is being listed
+    std::vector<std::pair<fs::path, bool>> staleEntries;
+    for (const auto& cacheDirectory : CacheDirectories)
+    {
+        fs::path dirPath = fs::path(project.projectRootDirectory) / cacheDirectory.name;
+        if (!cacheDirectory.holdsBuildProducts || !project.snapshot->IsDirectory(dirPath))
+        {
+            continue;
+        }
+
+        std::error_code error;
+        for (fs::recursive_directory_iterator it(dirPath, error), end; !error && it != end; it.increment(error))
+        {
+            // The Visual Studio project files are renamed and rewritten in place instead
+            if (it.depth() == 0 && it->path().filename() == "ProjectFiles")
+            {
+                it.disable_recursion_pending();
+                continue;
+            }
+
+            if (!IsStaleCacheEntry(it->path().filename().string(), oldNames))
+            {
+                continue;
+            }
+
+            bool isDirectory = it->is_directory() && !it->is_symlink();
+            staleEntries.emplace_back(it->path(), isDirectory);
+            if (isDirectory)
+            {
+                // Everything inside goes with the folder
+                it.disable_recursion_pending();
+            }
+        }
+    }
+
+    for (const auto& [path, isDirectory] : staleEntries)
+    {
+        DeleteCacheEntry(project, path, isDirectory);
+    }
+
+    LogMessage(project, COLOUR_GREEN, "\nDeleted ", staleEntries.size(), " stale cache entries, all other cached data was kept.");
+}
+
+// Delete a whole cache folder. Intermediate keeps its ProjectFiles folder, whose Visual Studio project
+// files are renamed and rewritten in place afterwards, so only the rest of it is deleted.
+void DeleteCacheDirectory(ProjectContext& project, const fs::path& dirPath)
+{
+    fs::path projectFilesPath = dirPath / "ProjectFiles";
+    std::error_code error;
+    if (dirPath.filename() != "Intermediate" || !fs::is_directory(projectFilesPath, error))
+    {
+        DeleteCacheEntry(project, dirPath, true);
+        return;
+    }
+
+    // Collect first, since entries cannot be moved while their folder is being listed
+    std::vector<std::pair<fs::path, bool>> entries;
+    for (fs::directory_iterator it(dirPath, error), end; !error && it != end; it.increment(error))
+    {
+        if (it->path().filename() != "ProjectFiles")
+        {
+            entries.emplace_back(it->path(), it->is_directory() && !it->is_symlink());
+        }
+    }
+
+    for (const auto& [path, isDirectory] : entries)
+    {
+        DeleteCacheEntry(project, path, isDirectory);
+    }
+}
+
+void DeleteCachedProjectDirectories(ProjectContext& project)
+{
+    if (!project.changePlan)
+    {
+        // Unlinking is I/O bound, a few workers are enough to keep the disk busy
+        unsigned workerCount = jobCount < 4 ? jobCount : 4;
+        project.trash = std::make_unique<TrashCollector>(project.backupDirectory.parent_path() / "Trash", workerCount);
+
+        // Finish deleting whatever an earlier run left in the trash when it exited
+        size_t resumed = project.trash->ResumePending();
+        if (resumed > 0)
+        {
+            LogBuffer log(project);
+            log.Write(COLOUR_GREEN, "\nResuming deletion of ", resumed, " item(s) left in the trash by an earlier run");
+        }
+    }
+
+    std::string userInput;
+
+    while (true)
+    {
+        if (isBatchMode)
+        {
+            // Unattended runs only delete the caches when asked to with --clean-cache or --clean-stale-cache
+            userInput = cacheCleanup == CacheCleanup::All ? "Y" : cacheCleanup == CacheCleanup::Stale ? "S" : "N";
+        }
+        else
+        {
+            FlushLog();
+            SetConsoleColour(COLOUR_ORANGE);
+            std::cout << "\nThe 'Saved' 'Intermediate' and 'Binaries' folders in your project directory are not backed up automatically. However it is still highly recommended that they should be deleted to clean all cached data." << std::endl;
+            std::cout << "\nType 'S' to only delete the build products named after the old project or module, which keeps the shader and derived data caches warm." << std::endl;
+            std::cout << "\nWould you like this software to delete them for you? Please type 'Y', 'S' or 'N': ";
+            std::getline(std::cin, userInput);
+        }
+
+        if (userInput == "Y")
+        {
+            for (const auto& cacheDirectory : CacheDirectories)
+            {
+                fs::path dirPath = fs::path(project.projectRootDirectory) / cacheDirectory.name;
+                if (project.snapshot->IsDirectory(dirPath))
+                {
+                    DeleteCacheDirectory(project, dirPath);
+                }
+            }
+            break;
+        }
+        else if (userInput == "S")
+        {
+            DeleteStaleCacheEntries(project);
+            break;
+        }
+        else if (userInput == "N")
+        {
+            break;
+        }
+        else
+        {
+            LogMessage(project, COLOUR_RED, "ERROR: Invalid input. Please type 'Y', 'S' or 'N'.");
+        }
+    }
+}
+
+
+// Rename and rewrite the existing .sln and .vcxproj files, which takes milliseconds and needs no engine install.
+// Returns false if there are no usable project files, in which case they are regenerated with UnrealBuildTool.
+bool UpdateProjectFilesInPlace(ProjectContext& project)
+{
+    if (!project.isCPPProject)
+    {
+        return false;
+    }
+
+    std::string oldProjectName = project.oldUprojectFilePath.stem().string();
+    fs::path projectRoot = project.projectRootDirectory;
+
+    // The solution is renamed first, so once it is the interrupted run updated the project files already
+    if (project.progress && project.progress->IsRenameDone(projectRoot / (oldProjectName + ".sln"), projectRoot / (project.newProjectName + ".sln")))
+    {
+        LogMessage(project, COLOUR_GREEN, "\nThe Visual Studio project files were updated before the run was interrupted.");
+        return true;
+    }
+
+    ProjectFileSet files;
+    if (!FindProjectFiles(project.projectRootDirectory, oldProjectName, files))
+    {
+        LogMessage(project, COLOUR_ORANGE, "\nNo generated Visual Studio project files to update in place, they are regenerated instead.");
+        return false;
+    }
+
+    // The project files are renamed like everything else, so their own new names are part of the replacer
+    std::vector<std::pair<fs::path, fs::path>> fileRenames = PlanProjectFileRenames(files, oldProjectName, project.newProjectName);
+    std::vector<std::pair<fs::path, fs::path>> renames = project.renamedPaths;
+    renames.insert(renames.end(), fileRenames.begin(), fileRenames.end());
+
+    MultiReplacer replacer = BuildProjectFileReplacer(projectRoot, projectRoot.parent_path() / project.newProjectName, renames);
+
+    for (const auto& [from, to] : fileRenames)
+    {
+        MakeFileWritable(project, from);
+
+        LogBuffer log(project);
+        RewriteFile(project, from, replacer, log, true);
+        log.Flush();
+
+        try
+        {
+            MoveProjectPath(project, from, to);
+            LogMessage(project, COLOUR_GREEN, project.changePlan ? "\nWould update and rename Visual Studio file to: " : "\nSuccessfully updated and renamed Visual Studio file to: ", to);
+        }
+        catch (const fs::filesystem_error& e)
+        {
+            project.errorCount++;
+            LogMessage(project, COLOUR_RED, "\nERROR: Error renaming Visual Studio file ", from, ": ", e.what());
+        }
+    }
+    return true;
+}
+
+void DeleteSlnFiles(ProjectContext& project)
+{
+    if (project.isCPPProject)
+    {
+        for (const auto& entry : project.snapshot->List(project.projectRootDirectory))
+        {
+            if (!entry.isDirectory && entry.path.extension() == ".sln")
+            {
+                BackupFile(project, entry.path);
+
+                try
+                {
+                    DeleteProjectPath(project, entry.path);
+                    LogMessage(project, COLOUR_GREEN, "\nSuccessfully deleted .sln file: ", entry.path);
+                }
+                catch (const fs::filesystem_error& e)
+                {
+                    project.errorCount++;
+                    LogMessage(project, COLOUR_RED, "\nERROR: Error deleting .sln file ", entry.path, ": ", e.what());
+                }
+            }
+        }
+    }
+    else
+    {
+        LogMessage(project, COLOUR_GREEN, "\nNo .sln file as project is blueprint only.");
+    }
+}
+
+
+// Find the engine install of an EngineAssociation through the shared engine index
+void ResolveEngineDirectory(ProjectContext& project, const std::string& association)
+{
+    fs::path engineDirectory;
+    std::string source;
+
+    LogBuffer log(project);
+    if (engineLocator->Resolve(association, project.projectRootDirectory, engineDirectory, source))
+    {
+        project.unrealEngineDirectory = engineDirectory.string();
+        log.Write(COLOUR_GREEN, "\nFound Unreal Engine ", association, " at ", engineDirectory, " from ", source);
+    }
+    else
+    {
+        log.Write(COLOUR_ORANGE, "\nCould not find an installed Unreal Engine for EngineAssociation \"", association, "\"");
+    }
+}
+
+// Start generating Visual Studio project files with UnrealBuildTool, which is waited for by FinishProjectFileGeneration
+void StartProjectFileGeneration(ProjectContext& project)
+{
+    if (skipProjectFileGeneration)
+    {
+        LogMessage(project, COLOUR_GREEN, "\nSkipping Visual Studio project file generation as requested with --no-generate.");
+        return;
+    }
+
+    if (project.isCPPProject && project.changePlan)
+    {
+        // Finding the engine can prompt for it and updates the engine index, so a dry run stops here
+        project.changePlan->RecordCommand("UnrealBuildTool -projectfiles -project=\"" + project.newUprojectFilePath.string() + "\" -game -engine (the project files would be regenerated with UnrealBuildTool)");
+        return;
+    }
+
+    if (project.isCPPProject)
+    {
+        // Without --engine, find the engine the .uproject is associated with
+        std::string association;
+        std::string uprojectContent;
+        if (ReadProjectFile(project, project.newUprojectFilePath, uprojectContent))
+        {
+            association = EngineLocator::ReadEngineAssociation(uprojectContent);
+        }
+        if (project.unrealEngineDirectory.empty())
+        {
+            ResolveEngineDirectory(project, association);
+        }
+
+        std::string unrealBuildToolPath;
+        bool attempted = false;
+
+        while (true)
+        {
+            // The found or given directory is tried first, and only then is the user asked
+            if (attempted || project.unrealEngineDirectory.empty())
+            {
+                if (isBatchMode)
+                {
+                    project.errorCount++;
+                    LogMessage(project, COLOUR_RED, "\nERROR: Could not generate Visual Studio project files, pass a valid --engine directory or --no-generate.");
+                    return;
+                }
+
+                FlushLog();
+                SetConsoleColour(COLOUR_WHITE);
+                std::cout << "\nPlease enter the Unreal Engine directory (usually found inside C:\\Program Files\\Epic Games\\): ";
+                std::getline(std::cin, project.unrealEngineDirectory);
+            }
+            attempted = true;
+
+            if (fs::exists(project.unrealEngineDirectory) && fs::is_directory(project.unrealEngineDirectory))
+            {
+                // Probes the UE5 location before the UE4 one, so the major version never has to be asked
+                unrealBuildToolPath = FindUnrealBuildTool(project.unrealEngineDirectory).string();
+                if (!unrealBuildToolPath.empty())
+                {
+                    // Only a real run with a known association updates the engine index
+                    if (!project.changePlan && !association.empty())
+                    {
+                        engineLocator->Remember(association, project.unrealEngineDirectory);
+                    }
+                    break;
+                }
+
+                LogMessage(project, COLOUR_RED, "\nCannot find UnrealBuildTool in ", project.unrealEngineDirectory, ". Please try again.");
+            }
+            else
+            {
+                LogMessage(project, COLOUR_RED, "\nThe provided path is not a valid directory. Please try again.");
+            }
+        }
+
+
+        // Generate Visual Studio project files
+        std::vector<std::string> arguments = { "-projectfiles", "-project=" + project.newUprojectFilePath.string(), "-game", "-engine" };
+
+        // UnrealBuildTool runs in the background while the remaining steps carry on, its output is streamed as it comes
+        project.projectFileGenerator = std::make_unique<ChildProcess>();
+        project.projectFileGenerationStart = std::chrono::steady_clock::now();
+        std::error_code error;
+        bool started = project.projectFileGenerator->Start(unrealBuildToolPath, arguments, [&project](const std::string& line)
+            {
+                LogBuffer log(project);
+                log.Write(COLOUR_WHITE, "[UnrealBuildTool] ", line);
+            }, error);
+
+        if (started)
+        {
+            LogMessage(project, COLOUR_GREEN, "\nStarted UnrealBuildTool to generate Visual Studio project files in the background.");
+        }
+        else
+        {
+            project.projectFileGenerator.reset();
+            project.errorCount++;
+            LogMessage(project, COLOUR_RED, "\nERROR: Could not start UnrealBuildTool: ", error.message());
+        }
+    }
+    else
+    {
+        LogMessage(project, COLOUR_GREEN, "\nGenerating Visual Studio project files not required as project is blueprint only.");
+    }
+}
+
+// Wait for UnrealBuildTool, which must be done before the project folder is renamed
+void FinishProjectFileGeneration(ProjectContext& project)
+{
+    if (!project.projectFileGenerator)
+    {
+        return;
+    }
+
+    int exitCode = -1;
+    bool finished = project.projectFileGenerator->Wait(projectFileGenerationTimeout, exitCode);
+    if (!finished)
+    {
+        project.projectFileGenerator->Kill();
+    }
+    project.projectFileGenerator.reset();
+    TraceInterval("UnrealBuildTool", "process", project.projectFileGenerationStart, std::chrono::steady_clock::now(), project.newProjectName);
+
+    LogBuffer log(project);
+    if (!finished)
+    {
+        log.WriteError(COLOUR_RED, "\nERROR: UnrealBuildTool did not finish within ", projectFileGenerationTimeout.count(), " seconds and was stopped. Set a longer limit with --ubt-timeout.");
+    }
+    else if (exitCode != 0)
+    {
+        log.WriteError(COLOUR_RED, "\nError generating Visual Studio project files, UnrealBuildTool exited with code ", exitCode);
+    }
+    else
+    {
+        log.Write(COLOUR_GREEN, "\nVisual Studio project files generated successfully.");
+    }
+}
+
+// Restore every file recorded in a backup run folder to the project it was taken from
+int RestoreBackup()
+{
+    fs::path runDirectory = fs::absolute(restoreBackupPath);
+    std::vector<fs::path> restoredFiles;
+    std::string error;
+
+    bool restored = BackupStore::Restore(runDirectory, restoredFiles, error);
+
+    FlushLog();
+    SetConsoleColour(COLOUR_GREEN);
+    for (const auto& filePath : restoredFiles)
+    {
+        std::cout << "\nSuccessfully restored file: " << filePath << std::endl;
+    }
+
+    if (!restored)
+    {
+        SetConsoleColour(COLOUR_RED);
+        std::cerr << "\nERROR: Failed to restore backup " << runDirectory << ": " << error << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+        return 1;
+    }
+
+    std::cout << "\nSuccessfully restored " << restoredFiles.size() << " files from backup: " << runDirectory << std::endl;
+    SetConsoleColour(COLOUR_WHITE);
+    return 0;
+}
+
+// Undo every change journaled by a run, newest first, including renames and the project folder rename
+int RollbackRun()
+{
+    fs::path runDirectory = fs::absolute(rollbackRunPath);
+    std::vector<std::string> actions;
+    std::string error;
+
+    bool rolledBack = Journal::Rollback(runDirectory, actions, error);
+
+    FlushLog();
+    SetConsoleColour(COLOUR_GREEN);
+    for (const auto& action : actions)
+    {
+        std::cout << "\n" << action << std::endl;
+    }
+
+    if (!rolledBack)
+    {
+        SetConsoleColour(COLOUR_RED);
+        std::cerr << "\nERROR: Failed to roll back " << runDirectory << ": " << error << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+        return 1;
+    }
+
+    std::cout << "\nSuccessfully rolled back " << actions.size() << " changes of run: " << runDirectory << std::endl;
+    SetConsoleColour(COLOUR_WHITE);
+    return 0;
+}
+
+// Wait for the background deletion of the cache folders, which must be done before the project folder is renamed
+void FinishCacheDeletion(ProjectContext& project)
+{
+    if (!project.trash)
+    {
+        return;
+    }
+
+    std::string error;
+    bool deleted = project.trash->Join(error);
+    size_t deletedEntries = project.trash->DeletedEntries();
+    project.trash.reset();
+
+    LogBuffer log(project);
+    if (!deleted)
+    {
+        // The caches are already out of the project, so a leftover in the trash is not a failed rename
+        log.Write(COLOUR_ORANGE, "\nWARNING: ", error, "\nThe rest of the trash is deleted by the next run.");
+    }
+    else if (deletedEntries > 0)
+    {
+        log.Write(COLOUR_GREEN, "\nFinished deleting cached files in the background: ", deletedEntries, " entries");
+    }
+}
+
+void RenameProjectFolder(ProjectContext& project)
+{
+    // Set the current path as the old path
+    fs::path oldFolderPath = project.projectRootDirectory;
+
+    // Create the new path by combining the parent path with the new name
+    fs::path newFolderPath = oldFolderPath.parent_path() / project.newProjectName;
+
+    if (project.changePlan)
+    {
+        project.changePlan->RecordRename(oldFolderPath, newFolderPath);
+        return;
+    }
+
+    // Nothing inside the project may be held open while its folder is renamed
+    if (!project.journal->RecordProjectRename(oldFolderPath.filename().string(), newFolderPath.filename().string()))
+    {
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "\nERROR: Could not write the rename journal, the project folder was not renamed.");
+        return;
+    }
+    project.journal->Commit();
+    project.backupStore->Close();
+    project.progress->Close();
+
+    while (true)
+    {
+        std::error_code error;
+        bool renamed = false;
+
+        if (isBatchMode)
+        {
+            // Nobody can close Explorer windows during unattended runs, so wait and retry a few times
+            renamed = RenamePathWithRetry(oldFolderPath, newFolderPath, 10, std::chrono::seconds(1), error);
+        }
+        else
+        {
+            renamed = RenamePath(oldFolderPath, newFolderPath, error);
+        }
+
+        if (renamed)
+        {
+            // Every step is done, so the run is never resumed
+            ProgressLedger::MarkFinished(newFolderPath / "UEPR_Backups" / project.backupFolderName);
+
+            LogMessage(project, COLOUR_GREEN, "\nSuccessfully renamed folder from:\n", oldFolderPath, "\nTo:\n", newFolderPath);
+            return;
+        }
+
+        if (IsAccessDenied(error) && !isBatchMode)
+        {
+            FlushLog();
+            SetConsoleColour(COLOUR_RED);
+            std::cout << "Failed to rename folder. Error code: " << error.value() << " (" << error.message() << ")" << std::endl;
+            std::cout << "Please ensure all instances of this folder are closed (including File Explorer), and then press any key to retry..." << std::endl;
+            SetConsoleColour(COLOUR_WHITE);
+            // Wait for user to press a key to retry
+            WaitForKeyPress();
+            std::cout << "Retrying...\n";
+            continue;
+        }
+
+        project.errorCount++;
+        LogMessage(project, COLOUR_RED, "Failed to rename folder. Error code: ", error.value(), " (", error.message(), ")");
+        return;
+    }
+}
+
+int FindReferences()
+{
+    ProjectContext& project = commandLineProject;
+    if (!SelectProjectPath(project))
+    {
+        return EXIT_CODE_INVALID_PROJECT;
+    }
+    FindModuleSourceDirectories(project);
+
+    std::vector<fs::path> files = CollectIndexedFiles(project);
+    ReferenceIndex index(project.projectRootDirectory, ReferenceIndexFile(project));
+    index.Load();
+    size_t readFiles = index.Refresh(files, { referenceQuery }, {}, *threadPool, project.snapshot.get());
+
+    std::string error;
+    if (!index.Save(error))
+    {
+        LogMessage(project, COLOUR_ORANGE, "\nWARNING: Could not save the reference index: ", error);
+    }
+
+    // Offsets become line and column numbers, reading only the files that mention the name
+    std::vector<ReferenceIndex::Reference> references = index.Find(referenceQuery);
+    std::set<fs::path> referencingFiles;
+    std::cout << std::endl;
+    for (size_t i = 0; i < references.size();)
+    {
+        const fs::path& filePath = references[i].filePath;
+        referencingFiles.insert(filePath);
+        MappedFile file(filePath);
+        std::string_view text = file.View();
+
+        size_t line = 1;
+        size_t lineStart = 0;
+        size_t scanned = 0;
+        for (; i < references.size() && references[i].filePath == filePath; ++i)
+        {
+            size_t offset = std::min<size_t>(references[i].offset, text.size());
+            for (; scanned < offset; ++scanned)
+            {
+                if (text[scanned] == '\n')
+                {
+                    ++line;
+                    lineStart = scanned + 1;
+                }
+            }
+
+            size_t lineEnd = text.find('\n', lineStart);
+            std::string_view lineText = text.substr(lineStart, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - lineStart);
+            if (!lineText.empty() && lineText.back() == '\r') lineText.remove_suffix(1);
+            std::cout << fs::relative(filePath, project.projectRootDirectory).generic_string() << ':' << line << ':' << offset - lineStart + 1 << ": " << lineText << '\n';
+        }
+    }
+
+    LogMessage(project, COLOUR_GREEN, "\nFound ", references.size(), " references to ", referenceQuery, " in ", referencingFiles.size(), " files, read ", readFiles, " of ", files.size(), " source and config files");
+    return EXIT_CODE_SUCCESS;
+}
+
+// Print the outcome of a project's rename and return its exit code
+int ReportProjectResult(ProjectContext& project)
+{
+    LogBuffer log(project);
+    if (project.changePlan)
+    {
+        std::ostringstream plan;
+        project.changePlan->Write(plan);
+        std::string text = plan.str();
+        if (!text.empty() && text.back() == '\n') text.pop_back();
+        log.Write(COLOUR_WHITE, text);
+    }
+
+    if (project.errorCount > 0)
+    {
+        log.Write(COLOUR_RED, "\nUnreal Engine project rename completed with ", project.errorCount.load(), " error(s)");
+        if (project.journal)
+        {
+            log.Write(COLOUR_ORANGE, "\nINFO: Every change of this run can be undone with --rollback ", project.backupDirectory);
+        }
+        return EXIT_CODE_RENAME_FAILED;
+    }
+    log.Write(COLOUR_GREEN, project.changePlan ? "\nSuccessfully planned Unreal Engine project rename" : "\nSuccessfully completed Unreal Engine project rename");
+    return EXIT_CODE_SUCCESS;
+}
+
+// Stop timing the current step of the rename, if one is being timed
+void EndPhase(ProjectContext& project)
+{
+    project.phaseSpan.reset();
+    if (project.currentPhase.empty()) return;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - project.phaseStart;
+    project.phaseTimings.push_back({ project.currentPhase, elapsed.count() });
+    project.currentPhase.clear();
+}
+
+// Start timing the next step of the rename, ending the one before
+void BeginPhase(ProjectContext& project, const char* name)
+{
+    EndPhase(project);
+    project.currentPhase = name;
+    project.phaseStart = std::chrono::steady_clock::now();
+
+    if (IsTracing())
+    {
+        project.phaseSpan = std::make_unique<TraceSpan>(name, "phase");
+        project.phaseSpan->SetDetail(project.newProjectName);
+    }
+}
+
+// Run every rename step for one project and return its exit code
+int RenameProject(ProjectContext& project)
+{
+    BeginPhase(project, "Prepare");
+    if (!SelectProjectPath(project))
+    {
+        return EXIT_CODE_INVALID_PROJECT;
+    }
+    if (isDryRun)
+    {
+        project.changePlan = std::make_unique<ChangePlan>(project.projectRootDirectory);
+    }
+    CheckIfCPPProject(project);
+    if (!SetNewProjectName(project))
+    {
+        return EXIT_CODE_USAGE;
+    }
+    CreateBackupFolder(project);
+    if (!PrepareModuleRenames(project))
+    {
+        // Every step depends on the modules, so stop before anything is changed
+        project.errorCount++;
+        return ReportProjectResult(project);
+    }
+    BeginPhase(project, "RefreshReferenceIndex");
+    RefreshReferenceIndex(project);
+    BeginPhase(project, "EditModuleDescriptors");
+    EditModuleDescriptors(project);
+    RenameUprojectFile(project);
+    BeginPhase(project, "EditTargetFiles");
+    EditTargetFiles(project);
+    BeginPhase(project, "RenameModules");
+    RenameModules(project);
+
+    // The .uproject, Target and Build.cs files are final now. The caches are moved aside first, except
+    // Intermediate/ProjectFiles, which the in-place update reads next. Only when that update is not possible
+    // is the old .sln deleted before UnrealBuildTool writes new files, and the config files are edited meanwhile.
+    BeginPhase(project, "DeleteCachedProjectDirectories");
+    DeleteCachedProjectDirectories(project);
+    BeginPhase(project, "UpdateProjectFiles");
+    if (!UpdateProjectFilesInPlace(project))
+    {
+        // Fall back to regenerating the project files with UnrealBuildTool
+        DeleteSlnFiles(project);
+        StartProjectFileGeneration(project);
+    }
+    BeginPhase(project, "EditConfigFiles");
+    EditConfigFiles(project);
+    BeginPhase(project, "ReportPackageReferences");
+    ReportPackageReferences(project);
+    BeginPhase(project, "FinishProjectFileGeneration");
+    FinishProjectFileGeneration(project);
+    BeginPhase(project, "FinishCacheDeletion");
+    FinishCacheDeletion(project);
+    BeginPhase(project, "SaveReferenceIndex");
+    SaveReferenceIndex(project);
+    BeginPhase(project, "RenameProjectFolder");
+    RenameProjectFolder(project);
+    EndPhase(project);
+
+    return ReportProjectResult(project);
+}
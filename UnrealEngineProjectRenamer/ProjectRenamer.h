@@ -0,0 +1,20 @@
+#pragma once
+#include "globals.h"
+
+// The rename engine. Every step works on one ProjectContext, so the same code serves the
+// interactive tool, unattended runs and manifests of many projects.
+
+// Backup / issue warning, accepted up front for the whole run
+bool DisplayWarningAndGetConfirmation();
+
+// Run every rename step for one project and return its exit code
+int RenameProject(ProjectContext& project);
+
+// List every place the name given with --where appears in the project given with --project
+int FindReferences();
+
+// Restore every file recorded in the backup run folder given with --restore
+int RestoreBackup();
+
+// Undo every change journaled in the backup run folder given with --rollback
+int RollbackRun();
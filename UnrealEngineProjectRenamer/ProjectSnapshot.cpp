@@ -0,0 +1,209 @@
+#include "ProjectSnapshot.h"
+#include "Platform.h"
+#include "Trace.h"
+#include <algorithm>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Build products, caches and backups: the rename deletes or skips them, and they hold most of the files
+    const char* const UnwalkedFolders[] = { "Binaries", "Intermediate", "Saved", "DerivedDataCache", "UEPR_Backups" };
+
+    bool IsUnwalkedFolder(const fs::path& folder)
+    {
+        std::string name = folder.filename().string();
+        if (!name.empty() && name[0] == '.') return true;
+        return std::find(std::begin(UnwalkedFolders), std::end(UnwalkedFolders), name) != std::end(UnwalkedFolders);
+    }
+
+    // The first key past every key of the entries inside `key`, since '0' follows '/'
+    std::string SubtreeEnd(const std::string& key)
+    {
+        return key.empty() ? std::string(1, '\xff') : key + '0';
+    }
+
+    std::string SubtreeBegin(const std::string& key)
+    {
+        return key.empty() ? key : key + '/';
+    }
+}
+
+ProjectSnapshot::ProjectSnapshot(const fs::path& projectRoot)
+    : projectRoot(projectRoot), keyRoot(projectRoot.lexically_normal())
+{
+    if (!keyRoot.has_filename() && keyRoot.has_relative_path())
+    {
+        keyRoot = keyRoot.parent_path();
+    }
+}
+
+void ProjectSnapshot::Walk(ThreadPool& pool)
+{
+    std::vector<Entry> found;
+    std::mutex foundMutex;
+    TaskGroup group;
+
+    // Each folder is listed by its own task, which queues one task for each folder found in it
+    std::function<void(const fs::path&)> listFolder = [&](const fs::path& folder)
+        {
+            TraceSpan span("ListFolder", "file");
+            span.SetDetail(folder);
+
+            std::vector<Entry> listed;
+            std::error_code error;
+            for (fs::directory_iterator it(folder, error), end; !error && it != end; it.increment(error))
+            {
+                // Links are followed to what they point to, but linked folders are not walked into
+                std::error_code entryError;
+                fs::file_status status = it->symlink_status(entryError);
+                bool isLink = fs::is_symlink(status);
+                if (isLink) status = it->status(entryError);
+                if (entryError || (!fs::is_directory(status) && !fs::is_regular_file(status))) continue;
+
+                Entry entry;
+                entry.path = it->path();
+                entry.isDirectory = fs::is_directory(status);
+                if (entry.isDirectory)
+                {
+                    if (!isLink && !IsUnwalkedFolder(entry.path))
+                    {
+                        pool.Submit(group, [&listFolder, path = entry.path]() { listFolder(path); });
+                    }
+                }
+                else
+                {
+                    ReadFileStamp(*it, entry.size, entry.modified);
+                }
+                listed.push_back(std::move(entry));
+            }
+
+            std::lock_guard<std::mutex> lock(foundMutex);
+            found.insert(found.end(), std::make_move_iterator(listed.begin()), std::make_move_iterator(listed.end()));
+        };
+
+    pool.Submit(group, [&listFolder, this]() { listFolder(projectRoot); });
+    pool.Wait(group);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    for (auto& entry : found)
+    {
+        std::string key = KeyOf(entry.path);
+        entries.emplace(std::move(key), std::move(entry));
+    }
+}
+
+bool ProjectSnapshot::Find(const fs::path& path, Entry& entry) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(KeyOf(path));
+    if (found == entries.end()) return false;
+    entry = found->second;
+    return true;
+}
+
+bool ProjectSnapshot::IsDirectory(const fs::path& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string key = KeyOf(path);
+    if (key.empty()) return true;
+    auto found = entries.find(key);
+    return found != entries.end() && found->second.isDirectory;
+}
+
+bool ProjectSnapshot::IsFile(const fs::path& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(KeyOf(path));
+    return found != entries.end() && !found->second.isDirectory;
+}
+
+std::vector<ProjectSnapshot::Entry> ProjectSnapshot::List(const fs::path& directory) const
+{
+    std::vector<Entry> listed;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string prefix = SubtreeBegin(KeyOf(directory));
+    auto end = entries.lower_bound(SubtreeEnd(KeyOf(directory)));
+    for (auto it = entries.lower_bound(prefix); it != end;)
+    {
+        // The entries inside a subfolder follow it as one range, skip past them
+        size_t separator = it->first.find('/', prefix.size());
+        if (separator != std::string::npos)
+        {
+            it = entries.lower_bound(SubtreeEnd(it->first.substr(0, separator)));
+            continue;
+        }
+        listed.push_back(it->second);
+        ++it;
+    }
+    return listed;
+}
+
+std::vector<ProjectSnapshot::Entry> ProjectSnapshot::ListRecursive(const fs::path& directory) const
+{
+    std::vector<Entry> listed;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string key = KeyOf(directory);
+    auto end = entries.lower_bound(SubtreeEnd(key));
+    for (auto it = entries.lower_bound(SubtreeBegin(key)); it != end; ++it)
+    {
+        listed.push_back(it->second);
+    }
+    return listed;
+}
+
+void ProjectSnapshot::Rename(const fs::path& from, const fs::path& to)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string fromKey = KeyOf(from);
+    auto entry = entries.find(fromKey);
+    if (fromKey.empty() || entry == entries.end()) return;
+
+    // The entries inside a renamed folder keep their path relative to it
+    std::vector<Entry> moved = { std::move(entry->second) };
+    moved.front().path = to;
+    entries.erase(entry);
+
+    auto first = entries.lower_bound(SubtreeBegin(fromKey));
+    auto last = entries.lower_bound(SubtreeEnd(fromKey));
+    for (auto it = first; it != last; ++it)
+    {
+        Entry inside = std::move(it->second);
+        inside.path = to / inside.path.lexically_relative(from);
+        moved.push_back(std::move(inside));
+    }
+    entries.erase(first, last);
+
+    for (auto& movedEntry : moved)
+    {
+        std::string key = KeyOf(movedEntry.path);
+        entries[key] = std::move(movedEntry);
+    }
+}
+
+void ProjectSnapshot::Remove(const fs::path& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string key = KeyOf(path);
+    if (key.empty()) return;
+    entries.erase(key);
+    entries.erase(entries.lower_bound(SubtreeBegin(key)), entries.lower_bound(SubtreeEnd(key)));
+}
+
+// Project relative path with forward slashes, folded to lower case where the file system ignores case.
+// The project root itself is the empty key, and paths outside the project start with "..".
+std::string ProjectSnapshot::KeyOf(const fs::path& path) const
+{
+    fs::path relativePath = path.lexically_normal().lexically_relative(keyRoot);
+    if (relativePath.empty()) return "..";
+    std::u8string text = relativePath.generic_u8string();
+    std::string key(text.begin(), text.end());
+    if (key == ".") key.clear();
+    if (PathsIgnoreCase)
+    {
+        std::transform(key.begin(), key.end(), key.begin(), [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; });
+    }
+    return key;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+
+// Every file and folder of a project, listed once by a parallel walk when the project is opened. The
+// steps of a rename ask the snapshot instead of listing the same folders and checking the same paths
+// again, which is slow on network drives and under antivirus scanners. Folders of build products and
+// backups (Binaries, Intermediate, Saved, DerivedDataCache, UEPR_Backups) and hidden folders such as
+// .git are listed but not walked into.
+//
+// Renames and deletions made through the snapshot keep it in step with the disk. Sizes and modification
+// times are the ones seen by the walk; files rewritten since then are not looked at again.
+class ProjectSnapshot
+{
+public:
+    struct Entry
+    {
+        std::filesystem::path path;
+        bool isDirectory = false;
+        uint64_t size = 0;
+        int64_t modified = 0;  // Ticks of fs::file_time_type since its epoch
+    };
+
+    explicit ProjectSnapshot(const std::filesystem::path& projectRoot);
+
+    // List the project, one pool task per folder. Folders that cannot be listed are left empty.
+    void Walk(ThreadPool& pool);
+
+    // Look up a path below the project root. Returns false if it does not exist.
+    bool Find(const std::filesystem::path& path, Entry& entry) const;
+
+    bool IsDirectory(const std::filesystem::path& path) const;
+    bool IsFile(const std::filesystem::path& path) const;
+
+    // The files and folders directly in `directory`, in name order
+    std::vector<Entry> List(const std::filesystem::path& directory) const;
+
+    // Every file and folder below `directory`, in path order
+    std::vector<Entry> ListRecursive(const std::filesystem::path& directory) const;
+
+    // Follow a rename of a file or folder, with everything inside it
+    void Rename(const std::filesystem::path& from, const std::filesystem::path& to);
+
+    // Forget a deleted file or folder, with everything inside it
+    void Remove(const std::filesystem::path& path);
+
+private:
+    std::string KeyOf(const std::filesystem::path& path) const;
+
+    // Entries are listed from the root as given, keys are relative to its normal form
+    std::filesystem::path projectRoot;
+    std::filesystem::path keyRoot;
+
+    // Keyed by project relative path with forward slashes, so the entries below a folder are one range
+    std::map<std::string, Entry> entries;
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,397 @@
+#include "ReferenceIndex.h"
+#include "MappedFile.h"
+#include "Platform.h"
+#include "ReplaceEngine.h"
+#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Written on the first line, so an index from an incompatible version is ignored
+    const char* IndexHeader = "UEPR reference index 1";
+
+    // Files are checked and searched in chunks, one pool task per chunk
+    constexpr size_t FilesPerTask = 256;
+
+    // Index keys are project relative paths with forward slashes, stored as UTF-8
+    std::string ToKey(const fs::path& relativePath)
+    {
+        std::u8string text = relativePath.generic_u8string();
+        return std::string(text.begin(), text.end());
+    }
+
+    fs::path FromKey(const std::string& key)
+    {
+        return fs::path(std::u8string(key.begin(), key.end()));
+    }
+}
+
+ReferenceIndex::ReferenceIndex(const fs::path& projectRoot, const fs::path& indexFile)
+    : projectRoot(projectRoot), indexFile(indexFile)
+{
+}
+
+void ReferenceIndex::Load()
+{
+    names.clear();
+    entries.clear();
+
+    std::ifstream file(indexFile, std::ios::binary);
+    std::string line;
+    if (!std::getline(file, line) || line != IndexHeader)
+    {
+        return;
+    }
+
+    // N <complete> <name>, then F <size> <modified> <path> per file, followed by O <name> <offsets...> lines
+    Entry* entry = nullptr;
+    while (std::getline(file, line))
+    {
+        std::stringstream fields(line);
+        std::string kind;
+        std::getline(fields, kind, '\t');
+
+        bool valid = true;
+        if (kind == "N")
+        {
+            std::string complete;
+            Name name;
+            valid = std::getline(fields, complete, '\t') && std::getline(fields, name.text) && !name.text.empty();
+            name.complete = complete == "1";
+            names.push_back(std::move(name));
+        }
+        else if (kind == "F")
+        {
+            Entry fileEntry;
+            std::string key;
+            valid = static_cast<bool>(fields >> fileEntry.size >> fileEntry.modified) && fields.get() == '\t' && std::getline(fields, key) && !key.empty();
+            entry = valid ? &entries[key] : nullptr;
+            if (entry) *entry = std::move(fileEntry);
+        }
+        else if (kind == "O" && entry)
+        {
+            uint32_t name = 0;
+            valid = static_cast<bool>(fields >> name) && name < names.size();
+            for (uint64_t offset = 0; valid && fields >> offset;)
+            {
+                entry->occurrences.push_back({ name, offset });
+            }
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            // A damaged index is rebuilt rather than trusted
+            names.clear();
+            entries.clear();
+            return;
+        }
+    }
+}
+
+bool ReferenceIndex::Save(std::string& error) const
+{
+    std::string content = IndexHeader;
+    content += '\n';
+    for (const auto& name : names)
+    {
+        content += "N\t";
+        content += name.complete ? "1\t" : "0\t";
+        content += name.text;
+        content += '\n';
+    }
+
+    // Sorted, so saving an unchanged index writes the same file
+    std::vector<const std::pair<const std::string, Entry>*> sortedEntries;
+    sortedEntries.reserve(entries.size());
+    for (const auto& entry : entries)
+    {
+        sortedEntries.push_back(&entry);
+    }
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    for (const auto* entry : sortedEntries)
+    {
+        content += "F\t" + std::to_string(entry->second.size) + '\t' + std::to_string(entry->second.modified) + '\t';
+        content += entry->first;
+        content += '\n';
+
+        // Occurrences are kept in file order; one line per name lists all of its offsets
+        std::vector<Occurrence> occurrences = entry->second.occurrences;
+        std::stable_sort(occurrences.begin(), occurrences.end(), [](const Occurrence& a, const Occurrence& b) { return a.name < b.name; });
+        for (size_t i = 0; i < occurrences.size(); ++i)
+        {
+            if (i == 0 || occurrences[i].name != occurrences[i - 1].name)
+            {
+                if (i > 0) content += '\n';
+                content += "O\t" + std::to_string(occurrences[i].name);
+            }
+            content += ' ';
+            content += std::to_string(occurrences[i].offset);
+        }
+        if (!occurrences.empty()) content += '\n';
+    }
+
+    std::error_code errorCode;
+    fs::create_directories(indexFile.parent_path(), errorCode);
+    if (!WriteFileAtomically(indexFile, content, errorCode))
+    {
+        error = errorCode.message();
+        return false;
+    }
+    return true;
+}
+
+size_t ReferenceIndex::Refresh(const std::vector<fs::path>& files, const std::vector<std::string>& requestedNames, const std::vector<std::string>& laterNames, ThreadPool& pool, const ProjectSnapshot* snapshot)
+{
+    // Keep complete names for later queries, drop incomplete ones nobody asks for any more
+    auto isRequested = [&requestedNames, &laterNames](const std::string& text)
+        {
+            return std::find(requestedNames.begin(), requestedNames.end(), text) != requestedNames.end()
+                || std::find(laterNames.begin(), laterNames.end(), text) != laterNames.end();
+        };
+
+    std::vector<Name> updatedNames;
+    std::vector<int64_t> newIds(names.size(), -1);
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i].complete || isRequested(names[i].text))
+        {
+            newIds[i] = static_cast<int64_t>(updatedNames.size());
+            updatedNames.push_back(names[i]);
+        }
+    }
+    for (const auto* list : { &requestedNames, &laterNames })
+    {
+        for (const auto& text : *list)
+        {
+            bool known = std::any_of(updatedNames.begin(), updatedNames.end(), [&text](const Name& name) { return name.text == text; });
+            if (!text.empty() && !known)
+            {
+                updatedNames.push_back({ text, false });
+            }
+        }
+    }
+
+    for (auto& [key, entry] : entries)
+    {
+        std::vector<Occurrence> kept;
+        for (const auto& occurrence : entry.occurrences)
+        {
+            if (occurrence.name < newIds.size() && newIds[occurrence.name] >= 0)
+            {
+                kept.push_back({ static_cast<uint32_t>(newIds[occurrence.name]), occurrence.offset });
+            }
+        }
+        entry.occurrences.swap(kept);
+    }
+    names.swap(updatedNames);
+
+    bool searchAll = false;
+    for (const auto& name : names)
+    {
+        if (!name.complete && std::find(requestedNames.begin(), requestedNames.end(), name.text) != requestedNames.end())
+        {
+            searchAll = true;
+        }
+    }
+
+    // Names are unique and never empty, so each name's pattern number is its id
+    MultiReplacer scanner;
+    for (const auto& name : names)
+    {
+        scanner.Add(name.text, name.text);
+    }
+    scanner.Compile();
+
+    struct Result
+    {
+        bool exists = false;
+        bool searched = false;
+        Entry entry;
+    };
+    std::vector<Result> results(files.size());
+    std::vector<std::string> keys(files.size());
+
+    TaskGroup group;
+    for (size_t first = 0; first < files.size(); first += FilesPerTask)
+    {
+        pool.Submit(group, [this, &files, &results, &keys, &scanner, snapshot, searchAll, first]()
+            {
+                size_t last = std::min(first + FilesPerTask, files.size());
+                for (size_t i = first; i < last; ++i)
+                {
+                    keys[i] = KeyOf(files[i]);
+
+                    Result& result = results[i];
+                    ProjectSnapshot::Entry listed;
+                    if (snapshot && snapshot->Find(files[i], listed))
+                    {
+                        result.entry.size = listed.size;
+                        result.entry.modified = listed.modified;
+                    }
+                    else if (!ReadFileStamp(files[i], result.entry.size, result.entry.modified))
+                    {
+                        continue;
+                    }
+
+                    auto known = entries.find(keys[i]);
+                    if (!searchAll && known != entries.end()
+                        && known->second.size == result.entry.size && known->second.modified == result.entry.modified)
+                    {
+                        result.exists = true;
+                        continue;
+                    }
+
+                    TraceSpan span("IndexFile", "file");
+                    span.SetDetail(files[i]);
+                    MappedFile file(files[i]);
+                    if (!file.IsOpen()) continue;
+
+                    for (const auto& match : scanner.FindAllMatches(file.View()))
+                    {
+                        result.entry.occurrences.push_back({ static_cast<uint32_t>(match.pattern), match.position });
+                    }
+                    span.Add(TraceCounter::Matches, result.entry.occurrences.size());
+                    result.exists = true;
+                    result.searched = true;
+                }
+            });
+    }
+    pool.Wait(group);
+
+    // Files that could not be read are left out, so they are never ruled out
+    std::unordered_map<std::string, Entry> updatedEntries;
+    updatedEntries.reserve(files.size());
+    size_t searchedFiles = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (!results[i].exists) continue;
+
+        if (results[i].searched)
+        {
+            updatedEntries[keys[i]] = std::move(results[i].entry);
+            ++searchedFiles;
+        }
+        else
+        {
+            updatedEntries[keys[i]] = std::move(entries[keys[i]]);
+        }
+    }
+    entries.swap(updatedEntries);
+
+    if (searchAll)
+    {
+        for (auto& name : names)
+        {
+            name.complete = true;
+        }
+    }
+    return searchedFiles;
+}
+
+std::vector<fs::path> ReferenceIndex::FilesMentioning(const std::vector<fs::path>& files, const std::vector<std::string>& requestedNames) const
+{
+    std::vector<bool> wanted(names.size(), false);
+    for (const auto& text : requestedNames)
+    {
+        size_t id = NameId(text);
+        if (id == names.size() || !names[id].complete)
+        {
+            // Without a full search for the name no file can be ruled out
+            return files;
+        }
+        wanted[id] = true;
+    }
+
+    std::vector<fs::path> mentioning;
+    for (const auto& filePath : files)
+    {
+        auto entry = entries.find(KeyOf(filePath));
+        bool mentions = entry == entries.end() || std::any_of(entry->second.occurrences.begin(), entry->second.occurrences.end(),
+            [&wanted](const Occurrence& occurrence) { return wanted[occurrence.name]; });
+        if (mentions)
+        {
+            mentioning.push_back(filePath);
+        }
+    }
+    return mentioning;
+}
+
+std::vector<ReferenceIndex::Reference> ReferenceIndex::Find(const std::string& text) const
+{
+    std::vector<Reference> references;
+    size_t id = NameId(text);
+    if (id == names.size()) return references;
+
+    for (const auto& [key, entry] : entries)
+    {
+        for (const auto& occurrence : entry.occurrences)
+        {
+            if (occurrence.name == id)
+            {
+                references.push_back({ projectRoot / FromKey(key), occurrence.offset });
+            }
+        }
+    }
+
+    std::sort(references.begin(), references.end(), [](const Reference& a, const Reference& b)
+        {
+            if (a.filePath != b.filePath) return a.filePath < b.filePath;
+            return a.offset < b.offset;
+        });
+    return references;
+}
+
+void ReferenceIndex::ApplyRenames(const std::vector<std::pair<fs::path, fs::path>>& renames)
+{
+    if (renames.empty()) return;
+
+    std::vector<std::pair<std::string, std::string>> keyRenames;
+    for (const auto& [from, to] : renames)
+    {
+        keyRenames.emplace_back(KeyOf(from), KeyOf(to));
+    }
+
+    // Renames are applied in the order they were made, so a file follows its folder too
+    std::unordered_map<std::string, Entry> renamedEntries;
+    renamedEntries.reserve(entries.size());
+    for (auto& [key, entry] : entries)
+    {
+        std::string renamedKey = key;
+        for (const auto& [from, to] : keyRenames)
+        {
+            if (renamedKey == from)
+            {
+                renamedKey = to;
+            }
+            else if (renamedKey.size() > from.size() && renamedKey.compare(0, from.size(), from) == 0 && renamedKey[from.size()] == '/')
+            {
+                renamedKey = to + renamedKey.substr(from.size());
+            }
+        }
+        renamedEntries[renamedKey] = std::move(entry);
+    }
+    entries.swap(renamedEntries);
+}
+
+std::string ReferenceIndex::KeyOf(const fs::path& filePath) const
+{
+    return ToKey(filePath.lexically_relative(projectRoot));
+}
+
+size_t ReferenceIndex::NameId(const std::string& text) const
+{
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i].text == text) return i;
+    }
+    return names.size();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ProjectSnapshot.h"
+#include "ThreadPool.h"
+
+// Persistent inverted index of where the project's names appear: for every indexed file, the byte
+// offsets of each module, project and API macro name looked for so far. It is kept in UEPR_Backups
+// and checked against each file's size and modification time, so a later run only reads files that
+// changed, are new, or actually mention a name, instead of every source file of the project.
+//
+// A name is complete once every indexed file has been searched for it; only complete names are
+// trusted to rule files out. Asking for a name the index has not seen searches every file once.
+class ReferenceIndex
+{
+public:
+    // Where one name appears
+    struct Reference
+    {
+        std::filesystem::path filePath;
+        uint64_t offset;
+    };
+
+    ReferenceIndex(const std::filesystem::path& projectRoot, const std::filesystem::path& indexFile);
+
+    // Read the saved index. A missing, outdated or damaged index file leaves the index empty.
+    void Load();
+
+    // Write the index, all at once, through a temporary file
+    bool Save(std::string& error) const;
+
+    // Bring the index up to date for `files`, the full set of files it covers; entries of other files are
+    // dropped. New and changed files are searched again, every file is if one of `names` is not complete yet.
+    // `laterNames` are searched for in each file read, but never force a full search, since they only
+    // matter to later runs. Sizes and modification times come from `snapshot` where it has the file.
+    // Returns the number of files read.
+    size_t Refresh(const std::vector<std::filesystem::path>& files, const std::vector<std::string>& names, const std::vector<std::string>& laterNames, ThreadPool& pool, const ProjectSnapshot* snapshot = nullptr);
+
+    // The files among `files` that mention at least one of `names`. Files the index does not know are kept.
+    std::vector<std::filesystem::path> FilesMentioning(const std::vector<std::filesystem::path>& files, const std::vector<std::string>& names) const;
+
+    // Every place a name appears, by file and offset
+    std::vector<Reference> Find(const std::string& name) const;
+
+    // Follow files and folders renamed since the last refresh; a rename keeps content and modification time
+    void ApplyRenames(const std::vector<std::pair<std::filesystem::path, std::filesystem::path>>& renames);
+
+    static constexpr const char* IndexFileName = "references.txt";
+
+private:
+    struct Name
+    {
+        std::string text;
+        bool complete = false;
+    };
+
+    struct Occurrence
+    {
+        uint32_t name;
+        uint64_t offset;
+    };
+
+    struct Entry
+    {
+        uint64_t size = 0;
+        int64_t modified = 0;
+        std::vector<Occurrence> occurrences;
+    };
+
+    std::string KeyOf(const std::filesystem::path& filePath) const;
+    size_t NameId(const std::string& text) const;
+
+    std::filesystem::path projectRoot;
+    std::filesystem::path indexFile;
+    std::vector<Name> names;
+    std::unordered_map<std::string, Entry> entries;
+};
@@ -0,0 +1,201 @@
+#include "ReplaceEngine.h"
+#include <algorithm>
+
+MultiReplacer::MultiReplacer(std::initializer_list<std::pair<std::string, std::string>> pairs)
+{
+    for (const auto& pair : pairs)
+    {
+        Add(pair.first, pair.second);
+    }
+    Compile();
+}
+
+void MultiReplacer::Add(const std::string& from, const std::string& to, MatchFilter accept)
+{
+    if (from.empty()) return;
+
+    for (const auto& pattern : patterns)
+    {
+        if (pattern.first == from) return;
+    }
+
+    patterns.emplace_back(from, to);
+    matchFilters.push_back(accept);
+    compiled = false;
+}
+
+void MultiReplacer::Compile(SearchKernel kernel)
+{
+    nodes.clear();
+    nodes.emplace_back();
+    nodes[0].next.fill(-1);
+
+    // Build the trie of all 'from' strings
+    for (size_t p = 0; p < patterns.size(); ++p)
+    {
+        int32_t state = 0;
+        for (unsigned char c : patterns[p].first)
+        {
+            if (nodes[state].next[c] == -1)
+            {
+                nodes[state].next[c] = static_cast<int32_t>(nodes.size());
+                nodes.emplace_back();
+                nodes.back().next.fill(-1);
+            }
+            state = nodes[state].next[c];
+        }
+        nodes[state].output = static_cast<int32_t>(p);
+    }
+
+    // Breadth-first pass to fill failure links and turn the trie into a full transition table
+    std::vector<int32_t> queue;
+    queue.reserve(nodes.size());
+
+    for (int c = 0; c < 256; ++c)
+    {
+        int32_t child = nodes[0].next[c];
+        if (child == -1)
+        {
+            nodes[0].next[c] = 0;
+        }
+        else
+        {
+            nodes[child].fail = 0;
+            queue.push_back(child);
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        int32_t state = queue[head];
+        int32_t fail = nodes[state].fail;
+        nodes[state].dictLink = nodes[fail].output >= 0 ? fail : nodes[fail].dictLink;
+
+        for (int c = 0; c < 256; ++c)
+        {
+            int32_t child = nodes[state].next[c];
+            if (child == -1)
+            {
+                nodes[state].next[c] = nodes[fail].next[c];
+            }
+            else
+            {
+                nodes[child].fail = nodes[fail].next[c];
+                queue.push_back(child);
+            }
+        }
+    }
+
+    std::vector<std::string> fromStrings;
+    for (const auto& pattern : patterns)
+    {
+        fromStrings.push_back(pattern.first);
+    }
+    filter = CandidateFilter(fromStrings, kernel);
+
+    compiled = true;
+}
+
+std::vector<ReplaceMatch> MultiReplacer::FindAllMatches(std::string_view text) const
+{
+    std::vector<ReplaceMatch> matches;
+    if (!compiled || patterns.empty()) return matches;
+
+    int32_t state = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        // Outside a partial match nothing is lost by jumping to where the next pattern may start
+        if (state == 0 && filter.IsActive())
+        {
+            i = filter.Next(text, i);
+            if (i == text.size()) break;
+        }
+
+        state = nodes[state].next[static_cast<unsigned char>(text[i])];
+
+        int32_t hit = nodes[state].output >= 0 ? state : nodes[state].dictLink;
+        while (hit >= 0)
+        {
+            size_t pattern = static_cast<size_t>(nodes[hit].output);
+            matches.push_back({ i + 1 - patterns[pattern].first.size(), pattern });
+            hit = nodes[hit].dictLink;
+        }
+    }
+    return matches;
+}
+
+std::vector<ReplaceMatch> MultiReplacer::FindMatches(std::string_view text) const
+{
+    // Collect every occurrence, including overlapping ones
+    std::vector<ReplaceMatch> matches = FindAllMatches(text);
+    if (matches.empty()) return matches;
+
+    // Resolve overlaps: leftmost first, longest first on ties
+    std::sort(matches.begin(), matches.end(), [this](const ReplaceMatch& a, const ReplaceMatch& b)
+        {
+            if (a.position != b.position) return a.position < b.position;
+            return patterns[a.pattern].first.size() > patterns[b.pattern].first.size();
+        });
+
+    size_t kept = 0;
+    size_t end = 0;
+    for (const auto& match : matches)
+    {
+        MatchFilter accept = matchFilters[match.pattern];
+        if (match.position >= end && (accept == nullptr || accept(text, match.position, patterns[match.pattern].first.size())))
+        {
+            end = match.position + patterns[match.pattern].first.size();
+            matches[kept++] = match;
+        }
+    }
+    matches.resize(kept);
+
+    return matches;
+}
+
+size_t MultiReplacer::Apply(std::string_view text, std::string& output) const
+{
+    return Apply(text, FindMatches(text), output);
+}
+
+size_t MultiReplacer::Apply(std::string_view text, const std::vector<ReplaceMatch>& matches, std::string& output) const
+{
+    // Size the output exactly before copying anything
+    size_t outputSize = text.size();
+    for (const auto& match : matches)
+    {
+        outputSize = outputSize - patterns[match.pattern].first.size() + patterns[match.pattern].second.size();
+    }
+
+    output.clear();
+    output.reserve(outputSize);
+
+    size_t last = 0;
+    for (const auto& match : matches)
+    {
+        output.append(text.data() + last, match.position - last);
+        output.append(patterns[match.pattern].second);
+        last = match.position + patterns[match.pattern].first.size();
+    }
+    output.append(text.data() + last, text.size() - last);
+
+    return matches.size();
+}
+
+size_t MultiReplacer::ApplyInPlace(std::string& text) const
+{
+    std::string output;
+    size_t count = Apply(text, output);
+    if (count > 0)
+    {
+        text.swap(output);
+    }
+    return count;
+}
+
+void ReplaceAll(std::string& str, const std::string& from, const std::string& to)
+{
+    if (from.empty()) return;
+    MultiReplacer replacer({ { from, to } });
+    replacer.ApplyInPlace(str);
+}
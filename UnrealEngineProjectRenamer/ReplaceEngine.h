@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "SubstringSearch.h"
+
+// A single occurrence of a pattern inside a scanned buffer
+struct ReplaceMatch
+{
+    size_t position;
+    size_t pattern;
+};
+
+// Compiles any number of (from -> to) pairs into one Aho-Corasick automaton so a buffer
+// can be rewritten in a single scan, with the output built in one pre-sized allocation.
+// Overlapping matches are resolved leftmost-longest and replacements never rescan their output.
+// Between matches the scan jumps from one candidate position of the CandidateFilter to the next,
+// so the automaton only steps through the few bytes where a pattern may start.
+class MultiReplacer
+{
+public:
+    // Decides whether an occurrence of a pattern, `length` bytes at `position`, is replaced
+    using MatchFilter = bool (*)(std::string_view text, size_t position, size_t length);
+
+    MultiReplacer() = default;
+    MultiReplacer(std::initializer_list<std::pair<std::string, std::string>> pairs);
+
+    // Add a pair to be replaced. Empty or duplicate 'from' strings are ignored. With `accept` only the
+    // occurrences it accepts are replaced; a shorter pattern starting at the same place may still be.
+    void Add(const std::string& from, const std::string& to, MatchFilter accept = nullptr);
+
+    // Build the automaton. Must be called after the last Add and before scanning. The kernel that
+    // skips ahead between matches is the fastest the CPU supports unless another is given.
+    void Compile(SearchKernel kernel = DetectSearchKernel());
+
+    bool Empty() const { return patterns.empty(); }
+
+    // Find all non-overlapping matches that their filters accept, leftmost-longest, in ascending position order
+    std::vector<ReplaceMatch> FindMatches(std::string_view text) const;
+
+    // Find every occurrence of every pattern, overlapping ones included, in the order they end.
+    // Filters are not applied.
+    std::vector<ReplaceMatch> FindAllMatches(std::string_view text) const;
+
+    // Write the rewritten text to output and return the number of replacements made
+    size_t Apply(std::string_view text, std::string& output) const;
+
+    // Same as above, reusing matches already found by FindMatches on the same text
+    size_t Apply(std::string_view text, const std::vector<ReplaceMatch>& matches, std::string& output) const;
+
+    // Rewrite text in place and return the number of replacements made
+    size_t ApplyInPlace(std::string& text) const;
+
+    const std::string& From(size_t pattern) const { return patterns[pattern].first; }
+    const std::string& To(size_t pattern) const { return patterns[pattern].second; }
+
+private:
+    struct Node
+    {
+        std::array<int32_t, 256> next;
+        int32_t fail = 0;
+        int32_t output = -1;   // Pattern that ends exactly at this node
+        int32_t dictLink = -1; // Nearest suffix node that ends a pattern
+    };
+
+    std::vector<std::pair<std::string, std::string>> patterns;
+    std::vector<MatchFilter> matchFilters;
+    std::vector<Node> nodes;
+    CandidateFilter filter;
+    bool compiled = false;
+};
+
+// Replace all instances of a substring with another substring in a single pass
+void ReplaceAll(std::string& str, const std::string& from, const std::string& to);
@@ -0,0 +1,28 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Incremental SHA-256, used to content-address backed up files
+class Sha256
+{
+public:
+    Sha256();
+
+    void Update(const void* data, size_t length);
+    void Update(std::string_view data) { Update(data.data(), data.size()); }
+
+    // Finish the digest and return it as lowercase hex. The object must not be reused.
+    std::string FinalHex();
+
+    static std::string HashHex(std::string_view data);
+
+private:
+    void Transform(const uint8_t* block);
+
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, 64> buffer;
+    uint64_t totalLength = 0;
+    size_t bufferLength = 0;
+};
@@ -0,0 +1,268 @@
+#include "SubstringSearch.h"
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define UEPR_SEARCH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define UEPR_SEARCH_X86 0
+#endif
+
+// GCC and Clang only emit AVX instructions in functions marked for them, which keeps the rest of
+// the program runnable on any x86-64 CPU. MSVC emits any intrinsic it is given.
+#if UEPR_SEARCH_X86 && (defined(__GNUC__) || defined(__clang__))
+#define UEPR_TARGET(features) __attribute__((target(features)))
+#else
+#define UEPR_TARGET(features)
+#endif
+
+namespace
+{
+#if UEPR_SEARCH_X86
+    SearchKernel DetectKernel()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        int highestLeaf = info[0];
+
+        // AVX state must also be enabled by the operating system, which XCR0 tells
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (!osSavesAvx || highestLeaf < 7) return SearchKernel::SSE2;
+
+        __cpuidex(info, 7, 0);
+        bool hasAvx2 = (info[1] & (1 << 5)) != 0;
+        bool hasAvx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 && (_xgetbv(0) & 0xE6) == 0xE6;
+        if (hasAvx512) return SearchKernel::AVX512;
+        if (hasAvx2) return SearchKernel::AVX2;
+        return SearchKernel::SSE2;
+#else
+        // Both check that the operating system saves the AVX registers too
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512bw")) return SearchKernel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SearchKernel::AVX2;
+        return SearchKernel::SSE2;
+#endif
+    }
+#else
+    SearchKernel DetectKernel()
+    {
+        return SearchKernel::Scalar;
+    }
+#endif
+}
+
+SearchKernel DetectSearchKernel()
+{
+    static const SearchKernel detected = DetectKernel();
+    return detected;
+}
+
+bool IsSearchKernelSupported(SearchKernel kernel)
+{
+    return static_cast<int>(kernel) <= static_cast<int>(DetectSearchKernel());
+}
+
+const char* SearchKernelName(SearchKernel kernel)
+{
+    switch (kernel)
+    {
+    case SearchKernel::SSE2: return "SSE2";
+    case SearchKernel::AVX2: return "AVX2";
+    case SearchKernel::AVX512: return "AVX-512";
+    default: return "scalar";
+    }
+}
+
+CandidateFilter::CandidateFilter(const std::vector<std::string>& needles, SearchKernel kernel)
+    : kernel(IsSearchKernelSupported(kernel) ? kernel : SearchKernel::Scalar)
+{
+    size_t shortest = 0;
+    for (const auto& needle : needles)
+    {
+        if (!needle.empty() && (shortest == 0 || needle.size() < shortest)) shortest = needle.size();
+    }
+    if (shortest == 0) return;
+    offset = shortest - 1;
+
+    // Strings that share their first byte and the byte at the offset share one pair
+    for (const auto& needle : needles)
+    {
+        if (needle.empty()) continue;
+
+        unsigned char first = static_cast<unsigned char>(needle[0]);
+        unsigned char second = static_cast<unsigned char>(needle[offset]);
+        bool known = false;
+        for (size_t p = 0; p < pairCount && !known; ++p)
+        {
+            known = firstBytes[p] == first && secondBytes[p] == second;
+        }
+        if (known) continue;
+
+        if (pairCount == MaxPairs)
+        {
+            pairCount = 0;
+            return;
+        }
+        firstBytes[pairCount] = first;
+        secondBytes[pairCount] = second;
+        firstMask[first] |= static_cast<uint16_t>(1u << pairCount);
+        secondMask[second] |= static_cast<uint16_t>(1u << pairCount);
+        pairCount++;
+    }
+}
+
+size_t CandidateFilter::Next(std::string_view text, size_t from) const
+{
+    if (pairCount == 0) return from;
+
+    // No string fits in the last `offset` bytes
+    if (text.size() <= offset) return text.size();
+    size_t end = text.size() - offset;
+    if (from >= end) return text.size();
+
+    size_t found = end;
+    switch (kernel)
+    {
+    case SearchKernel::AVX512: found = NextAVX512(text.data(), from, end); break;
+    case SearchKernel::AVX2: found = NextAVX2(text.data(), from, end); break;
+    case SearchKernel::SSE2: found = NextSSE2(text.data(), from, end); break;
+    default: found = NextScalar(text.data(), from, end); break;
+    }
+    return found < end ? found : text.size();
+}
+
+// The kernels return the first candidate in [from, end), or end. Every one of them reads at most up
+// to end - 1 + offset, the last byte of the text.
+
+size_t CandidateFilter::NextScalar(const char* data, size_t from, size_t end) const
+{
+    for (size_t i = from; i < end; ++i)
+    {
+        if ((firstMask[static_cast<unsigned char>(data[i])] & secondMask[static_cast<unsigned char>(data[i + offset])]) != 0)
+        {
+            return i;
+        }
+    }
+    return end;
+}
+
+#if UEPR_SEARCH_X86
+
+size_t CandidateFilter::NextSSE2(const char* data, size_t from, size_t end) const
+{
+    __m128i firsts[MaxPairs];
+    __m128i seconds[MaxPairs];
+    for (size_t p = 0; p < pairCount; ++p)
+    {
+        firsts[p] = _mm_set1_epi8(static_cast<char>(firstBytes[p]));
+        seconds[p] = _mm_set1_epi8(static_cast<char>(secondBytes[p]));
+    }
+
+    size_t i = from;
+    for (; i + 16 <= end; i += 16)
+    {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + offset));
+        __m128i hits = _mm_setzero_si128();
+        for (size_t p = 0; p < pairCount; ++p)
+        {
+            hits = _mm_or_si128(hits, _mm_and_si128(_mm_cmpeq_epi8(first, firsts[p]), _mm_cmpeq_epi8(second, seconds[p])));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0) return i + static_cast<size_t>(std::countr_zero(mask));
+    }
+    return NextScalar(data, i, end);
+}
+
+UEPR_TARGET("avx2")
+size_t CandidateFilter::NextAVX2(const char* data, size_t from, size_t end) const
+{
+    __m256i firsts[MaxPairs];
+    __m256i seconds[MaxPairs];
+    for (size_t p = 0; p < pairCount; ++p)
+    {
+        firsts[p] = _mm256_set1_epi8(static_cast<char>(firstBytes[p]));
+        seconds[p] = _mm256_set1_epi8(static_cast<char>(secondBytes[p]));
+    }
+
+    size_t i = from;
+    for (; i + 32 <= end; i += 32)
+    {
+        __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + offset));
+        __m256i hits = _mm256_setzero_si256();
+        for (size_t p = 0; p < pairCount; ++p)
+        {
+            hits = _mm256_or_si256(hits, _mm256_and_si256(_mm256_cmpeq_epi8(first, firsts[p]), _mm256_cmpeq_epi8(second, seconds[p])));
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+        if (mask != 0) return i + static_cast<size_t>(std::countr_zero(mask));
+    }
+    return NextSSE2(data, i, end);
+}
+
+UEPR_TARGET("avx512f,avx512bw")
+size_t CandidateFilter::NextAVX512(const char* data, size_t from, size_t end) const
+{
+    __m512i firsts[MaxPairs];
+    __m512i seconds[MaxPairs];
+    for (size_t p = 0; p < pairCount; ++p)
+    {
+        firsts[p] = _mm512_set1_epi8(static_cast<char>(firstBytes[p]));
+        seconds[p] = _mm512_set1_epi8(static_cast<char>(secondBytes[p]));
+    }
+
+    size_t i = from;
+    for (; i + 64 <= end; i += 64)
+    {
+        __m512i first = _mm512_loadu_si512(data + i);
+        __m512i second = _mm512_loadu_si512(data + i + offset);
+        __mmask64 hits = 0;
+        for (size_t p = 0; p < pairCount; ++p)
+        {
+            hits |= _mm512_mask_cmpeq_epi8_mask(_mm512_cmpeq_epi8_mask(first, firsts[p]), second, seconds[p]);
+        }
+        if (hits != 0) return i + static_cast<size_t>(std::countr_zero(static_cast<uint64_t>(hits)));
+    }
+    return NextSSE2(data, i, end);
+}
+
+#else
+
+// Only the scalar kernel is ever selected on other architectures
+
+size_t CandidateFilter::NextSSE2(const char* data, size_t from, size_t end) const
+{
+    return NextScalar(data, from, end);
+}
+
+size_t CandidateFilter::NextAVX2(const char* data, size_t from, size_t end) const
+{
+    return NextScalar(data, from, end);
+}
+
+size_t CandidateFilter::NextAVX512(const char* data, size_t from, size_t end) const
+{
+    return NextScalar(data, from, end);
+}
+
+#endif
+
+size_t FindSubstring(std::string_view text, std::string_view needle, size_t from)
+{
+    if (from > text.size()) return std::string_view::npos;
+    if (needle.empty()) return from;
+
+    CandidateFilter filter({ std::string(needle) });
+    for (size_t i = filter.Next(text, from); i + needle.size() <= text.size(); i = filter.Next(text, i + 1))
+    {
+        if (std::memcmp(text.data() + i, needle.data(), needle.size()) == 0) return i;
+    }
+    return std::string_view::npos;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Instruction sets the search kernel has a path for, from slowest to fastest
+enum class SearchKernel
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// The fastest kernel this CPU and operating system support, detected once
+SearchKernel DetectSearchKernel();
+
+// Whether a kernel can run here
+bool IsSearchKernelSupported(SearchKernel kernel);
+
+// Name of a kernel, for reports
+const char* SearchKernelName(SearchKernel kernel);
+
+// Skips the parts of a text where none of a set of strings can start. A position is a candidate
+// when its byte is the first byte of one of the strings and the byte `offset` further on is that
+// string's byte at `offset`, where `offset` is one less than the length of the shortest string.
+// Both bytes are compared at 16, 32 or 64 positions at once, with SSE2, AVX2 or AVX-512BW as the
+// CPU allows. Candidates are only likely matches and must be verified by the caller.
+class CandidateFilter
+{
+public:
+    CandidateFilter() = default;
+    explicit CandidateFilter(const std::vector<std::string>& needles, SearchKernel kernel = DetectSearchKernel());
+
+    // Whether the filter skips anything. Strings with too many different byte pairs to compare at
+    // once pass every position instead, as filtering them costs more than it saves.
+    bool IsActive() const { return pairCount > 0; }
+
+    // First candidate position at or after `from`, or text.size() if no string can start there.
+    // Returns `from` unchanged when the filter is not active.
+    size_t Next(std::string_view text, size_t from) const;
+
+    // Byte pairs compared at once; more strings than this are only filtered if they share pairs
+    static constexpr size_t MaxPairs = 16;
+
+private:
+    size_t NextScalar(const char* data, size_t from, size_t end) const;
+    size_t NextSSE2(const char* data, size_t from, size_t end) const;
+    size_t NextAVX2(const char* data, size_t from, size_t end) const;
+    size_t NextAVX512(const char* data, size_t from, size_t end) const;
+
+    SearchKernel kernel = SearchKernel::Scalar;
+    size_t offset = 0;
+    size_t pairCount = 0;
+    unsigned char firstBytes[MaxPairs] = {};
+    unsigned char secondBytes[MaxPairs] = {};
+
+    // For the scalar path: which pairs each byte value starts or ends, one bit per pair
+    uint16_t firstMask[256] = {};
+    uint16_t secondMask[256] = {};
+};
+
+// Position of the first occurrence of `needle` in `text` at or after `from`, or std::string_view::npos
+size_t FindSubstring(std::string_view text, std::string_view needle, size_t from = 0);
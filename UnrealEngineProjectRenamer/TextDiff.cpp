@@ -0,0 +1,215 @@
+#include "TextDiff.h"
+#include <sstream>
+
+namespace
+{
+    struct Lines
+    {
+        std::vector<std::string_view> text;   // Each line including its '\n'
+        std::vector<size_t> offsets;          // Byte offset of each line, plus the total size at the end
+    };
+
+    Lines SplitLines(std::string_view text)
+    {
+        Lines lines;
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t end = text.find('\n', start);
+            end = end == std::string_view::npos ? text.size() : end + 1;
+            lines.text.push_back(text.substr(start, end - start));
+            lines.offsets.push_back(start);
+            start = end;
+        }
+        lines.offsets.push_back(text.size());
+        return lines;
+    }
+
+    // Mark which lines of a[first, first + n) are deleted and which of b[first, first + m) are inserted
+    void MyersDiff(const Lines& a, const Lines& b, size_t first, size_t n, size_t m, std::vector<bool>& deleted, std::vector<bool>& inserted)
+    {
+        const long long maxEdits = static_cast<long long>(n + m);
+        const long long offset = maxEdits + 1;
+        std::vector<long long> v(2 * offset + 1, 0);
+
+        // Furthest reaching x per diagonal before each edit count, kept for backtracking.
+        // Only diagonals -d..d are stored, so the trace costs O(D^2) rather than O(D(N+M)).
+        std::vector<std::vector<long long>> trace;
+
+        long long editCount = 0;
+        for (long long d = 0; d <= maxEdits; ++d)
+        {
+            trace.emplace_back(v.begin() + (offset - d), v.begin() + (offset + d + 1));
+
+            bool done = false;
+            for (long long k = -d; k <= d; k += 2)
+            {
+                long long x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+                long long y = x - k;
+                while (x < static_cast<long long>(n) && y < static_cast<long long>(m) && a.text[first + x] == b.text[first + y])
+                {
+                    ++x;
+                    ++y;
+                }
+                v[offset + k] = x;
+
+                if (x >= static_cast<long long>(n) && y >= static_cast<long long>(m))
+                {
+                    done = true;
+                    break;
+                }
+            }
+
+            if (done)
+            {
+                editCount = d;
+                break;
+            }
+        }
+
+        long long x = static_cast<long long>(n);
+        long long y = static_cast<long long>(m);
+        for (long long d = editCount; d > 0; --d)
+        {
+            const std::vector<long long>& previous = trace[d];
+            auto at = [&previous, d](long long k) { return previous[k + d]; };
+
+            long long k = x - y;
+            long long previousK = (k == -d || (k != d && at(k - 1) < at(k + 1))) ? k + 1 : k - 1;
+            long long previousX = at(previousK);
+            long long previousY = previousX - previousK;
+
+            // Walk back over the snake of equal lines, then take the single edit
+            while (x > previousX && y > previousY)
+            {
+                --x;
+                --y;
+            }
+            if (x == previousX)
+            {
+                inserted[first + previousY] = true;
+            }
+            else
+            {
+                deleted[first + previousX] = true;
+            }
+            x = previousX;
+            y = previousY;
+        }
+    }
+
+    std::vector<DiffBlock> DiffLines(const Lines& a, const Lines& b)
+    {
+        size_t n = a.text.size();
+        size_t m = b.text.size();
+
+        // Renames only touch a few lines, so most of a file is a common head and tail
+        size_t head = 0;
+        while (head < n && head < m && a.text[head] == b.text[head]) ++head;
+        size_t tail = 0;
+        while (tail < n - head && tail < m - head && a.text[n - 1 - tail] == b.text[m - 1 - tail]) ++tail;
+
+        std::vector<bool> deleted(n, false);
+        std::vector<bool> inserted(m, false);
+        MyersDiff(a, b, head, n - head - tail, m - head - tail, deleted, inserted);
+
+        std::vector<DiffBlock> blocks;
+        size_t i = head;
+        size_t j = head;
+        while (i < n || j < m)
+        {
+            if (i < n && j < m && !deleted[i] && !inserted[j])
+            {
+                ++i;
+                ++j;
+                continue;
+            }
+
+            DiffBlock block;
+            block.beforeLine = i;
+            block.afterLine = j;
+            while (i < n && deleted[i]) ++i;
+            while (j < m && inserted[j]) ++j;
+            block.beforeLineCount = i - block.beforeLine;
+            block.afterLineCount = j - block.afterLine;
+
+            block.beforeOffset = a.offsets[block.beforeLine];
+            block.beforeLength = a.offsets[i] - block.beforeOffset;
+            block.afterOffset = b.offsets[block.afterLine];
+            block.afterLength = b.offsets[j] - block.afterOffset;
+            blocks.push_back(block);
+        }
+        return blocks;
+    }
+
+    void WriteLine(std::ostringstream& out, char marker, std::string_view line)
+    {
+        out << marker << line;
+        if (line.empty() || line.back() != '\n')
+        {
+            out << "\n\\ No newline at end of file\n";
+        }
+    }
+
+    // Unified diff ranges start at the line before an empty range
+    std::string HunkRange(size_t start, size_t count)
+    {
+        std::ostringstream range;
+        range << (count == 0 ? start : start + 1);
+        if (count != 1) range << ',' << count;
+        return range.str();
+    }
+}
+
+std::vector<DiffBlock> DiffLines(std::string_view before, std::string_view after)
+{
+    return DiffLines(SplitLines(before), SplitLines(after));
+}
+
+std::string UnifiedDiff(std::string_view before, std::string_view after, const std::string& beforeName, const std::string& afterName, size_t contextLines)
+{
+    Lines a = SplitLines(before);
+    Lines b = SplitLines(after);
+    std::vector<DiffBlock> blocks = DiffLines(a, b);
+    if (blocks.empty()) return std::string();
+
+    std::ostringstream out;
+    out << "--- " << beforeName << "\n+++ " << afterName << "\n";
+
+    size_t first = 0;
+    while (first < blocks.size())
+    {
+        // Blocks whose context would touch are shown in one hunk
+        size_t last = first;
+        while (last + 1 < blocks.size()
+            && blocks[last + 1].beforeLine - (blocks[last].beforeLine + blocks[last].beforeLineCount) <= 2 * contextLines)
+        {
+            ++last;
+        }
+
+        size_t leading = blocks[first].beforeLine < contextLines ? blocks[first].beforeLine : contextLines;
+        size_t beforeStart = blocks[first].beforeLine - leading;
+        size_t afterStart = blocks[first].afterLine - leading;
+
+        size_t beforeEnd = blocks[last].beforeLine + blocks[last].beforeLineCount;
+        size_t trailing = a.text.size() - beforeEnd < contextLines ? a.text.size() - beforeEnd : contextLines;
+        beforeEnd += trailing;
+        size_t afterEnd = blocks[last].afterLine + blocks[last].afterLineCount + trailing;
+
+        out << "@@ -" << HunkRange(beforeStart, beforeEnd - beforeStart) << " +" << HunkRange(afterStart, afterEnd - afterStart) << " @@\n";
+
+        size_t line = beforeStart;
+        for (size_t index = first; index <= last; ++index)
+        {
+            const DiffBlock& block = blocks[index];
+            for (; line < block.beforeLine; ++line) WriteLine(out, ' ', a.text[line]);
+            for (size_t k = 0; k < block.beforeLineCount; ++k) WriteLine(out, '-', a.text[block.beforeLine + k]);
+            for (size_t k = 0; k < block.afterLineCount; ++k) WriteLine(out, '+', b.text[block.afterLine + k]);
+            line = block.beforeLine + block.beforeLineCount;
+        }
+        for (; line < beforeEnd; ++line) WriteLine(out, ' ', a.text[line]);
+
+        first = last + 1;
+    }
+    return out.str();
+}
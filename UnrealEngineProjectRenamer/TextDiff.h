@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A run of lines that differs between two texts. Lines are zero based and include their
+// line ending; offsets are byte positions, so a block also works as a byte-range edit.
+struct DiffBlock
+{
+    size_t beforeLine = 0;
+    size_t beforeLineCount = 0;
+    size_t afterLine = 0;
+    size_t afterLineCount = 0;
+
+    size_t beforeOffset = 0;
+    size_t beforeLength = 0;
+    size_t afterOffset = 0;
+    size_t afterLength = 0;
+};
+
+// Line diff of two texts (Myers' O(ND) algorithm after trimming the common head and tail),
+// returned as the blocks that changed in order
+std::vector<DiffBlock> DiffLines(std::string_view before, std::string_view after);
+
+// Unified diff of two texts with the usual ---/+++ header and @@ hunks, empty if they are equal
+std::string UnifiedDiff(std::string_view before, std::string_view after, const std::string& beforeName, const std::string& afterName, size_t contextLines = 3);
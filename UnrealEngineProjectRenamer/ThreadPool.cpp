@@ -0,0 +1,221 @@
+#include "ThreadPool.h"
+
+namespace
+{
+    // Lets Submit route work from a running task back to the same worker's queue
+    thread_local ThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    if (threadCount == 0) threadCount = 1;
+
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    size_t index = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+
+    unfinishedTasks++;
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++queuedTasks;
+    }
+    wakeCondition.notify_one();
+    idleCondition.notify_all();
+}
+
+void ThreadPool::Submit(TaskGroup& group, std::function<void()> task)
+{
+    group.pendingTasks++;
+    Submit([this, &group, task = std::move(task)]()
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(group.errorMutex);
+                if (!group.firstError)
+                {
+                    group.firstError = std::current_exception();
+                }
+            }
+            FinishGroupTask(group);
+        });
+}
+
+void ThreadPool::FinishGroupTask(TaskGroup& group)
+{
+    if (--group.pendingTasks == 0)
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        idleCondition.notify_all();
+    }
+}
+
+void ThreadPool::Wait()
+{
+    size_t self = currentPool == this ? currentWorker : 0;
+
+    while (unfinishedTasks > 0)
+    {
+        std::function<void()> task;
+        if (TrySteal(self, task))
+        {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        idleCondition.wait(lock, [this] { return unfinishedTasks == 0 || queuedTasks > 0; });
+    }
+
+    RethrowFirstError();
+}
+
+void ThreadPool::Wait(TaskGroup& group)
+{
+    size_t self = currentPool == this ? currentWorker : 0;
+
+    bool isWorker = currentPool == this;
+
+    while (!group.IsDone())
+    {
+        // A worker's own newest tasks are most likely the group's, so run those before stealing
+        std::function<void()> task;
+        if ((isWorker && TryPop(self, task)) || TrySteal(self, task))
+        {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        idleCondition.wait(lock, [this, &group] { return group.IsDone() || queuedTasks > 0; });
+    }
+
+    std::lock_guard<std::mutex> lock(group.errorMutex);
+    if (group.firstError)
+    {
+        std::exception_ptr error = group.firstError;
+        group.firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::RethrowFirstError()
+{
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (firstError)
+    {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::TryPop(size_t index, std::function<void()>& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        if (queues[index]->tasks.empty()) return false;
+
+        task = std::move(queues[index]->tasks.back());
+        queues[index]->tasks.pop_back();
+    }
+
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    --queuedTasks;
+    return true;
+}
+
+bool ThreadPool::TrySteal(size_t thief, std::function<void()>& task)
+{
+    for (size_t offset = 0; offset < queues.size(); ++offset)
+    {
+        size_t victim = (thief + offset) % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+            if (queues[victim]->tasks.empty()) continue;
+
+            task = std::move(queues[victim]->tasks.front());
+            queues[victim]->tasks.pop_front();
+        }
+
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        --queuedTasks;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::RunTask(std::function<void()>& task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!firstError)
+        {
+            firstError = std::current_exception();
+        }
+    }
+
+    if (--unfinishedTasks == 0)
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        idleCondition.notify_all();
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (TryPop(index, task) || TrySteal(index + 1, task))
+        {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this] { return stopping || queuedTasks > 0; });
+        if (stopping && queuedTasks == 0) return;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tracks a set of tasks so one caller can wait for just its own work,
+// even from inside another task running on the same pool
+class TaskGroup
+{
+public:
+    bool IsDone() const { return pendingTasks == 0; }
+
+private:
+    friend class ThreadPool;
+    std::atomic<size_t> pendingTasks{ 0 };
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+};
+
+// Work-stealing thread pool used to run per-file read/transform/write tasks in parallel.
+// Each worker owns a queue it pops from the back of; idle workers steal from the front
+// of the other queues so one slow directory never leaves the rest of the pool idle.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task. Tasks submitted from a worker go to that worker's own queue.
+    void Submit(std::function<void()> task);
+    void Submit(TaskGroup& group, std::function<void()> task);
+
+    // Block until every submitted task has finished, helping to run queued tasks meanwhile.
+    // Rethrows the first exception that escaped a task, if any. Must not be called from a task.
+    void Wait();
+
+    // Block until every task of the group has finished, helping to run queued tasks meanwhile.
+    // Safe to call from inside a task, which is how independent projects share one pool.
+    void Wait(TaskGroup& group);
+
+    unsigned Size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool TryPop(size_t index, std::function<void()>& task);
+    bool TrySteal(size_t thief, std::function<void()>& task);
+    void RunTask(std::function<void()>& task);
+    void FinishGroupTask(TaskGroup& group);
+    void RethrowFirstError();
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+    size_t queuedTasks = 0;
+    std::atomic<size_t> unfinishedTasks{ 0 };
+    std::atomic<size_t> nextQueue{ 0 };
+    bool stopping = false;
+
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+};
@@ -0,0 +1,225 @@
+#include "Trace.h"
+#include "Json.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> tracingEnabled{ false };
+
+namespace
+{
+    constexpr size_t CounterCount = static_cast<size_t>(TraceCounter::Count);
+
+    // Counter names in the trace file and the summary
+    const char* CounterNames[CounterCount] = { "bytesRead", "bytesWritten", "matches", "systemCalls" };
+
+    struct TraceEvent
+    {
+        const char* name;
+        const char* category;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+        std::string detail;
+        uint64_t counters[CounterCount];
+    };
+
+    // Each thread records into its own list, so spans never wait on each other. The lists are
+    // shared with the registry, so they outlive pool threads that end before the trace is written.
+    struct ThreadEvents
+    {
+        unsigned threadId = 0;
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadEvents>> registry;
+    std::chrono::steady_clock::time_point traceStart;
+
+    thread_local TraceSpan* openSpan = nullptr;
+
+    ThreadEvents& LocalEvents()
+    {
+        thread_local std::shared_ptr<ThreadEvents> local;
+        if (!local)
+        {
+            local = std::make_shared<ThreadEvents>();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            local->threadId = static_cast<unsigned>(registry.size()) + 1;
+            registry.push_back(local);
+        }
+        return *local;
+    }
+
+    void Record(TraceEvent&& event)
+    {
+        ThreadEvents& events = LocalEvents();
+        std::lock_guard<std::mutex> lock(events.mutex);
+        events.events.push_back(std::move(event));
+    }
+
+    double Microseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+}
+
+void StartTrace()
+{
+    traceStart = std::chrono::steady_clock::now();
+    tracingEnabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceAdd(TraceCounter counter, uint64_t value)
+{
+    if (!IsTracing() || openSpan == nullptr) return;
+    openSpan->counters[static_cast<size_t>(counter)] += value;
+}
+
+void TraceInterval(const char* name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, std::string_view detail)
+{
+    if (!IsTracing()) return;
+    Record({ name, category, start, end, std::string(detail), {} });
+}
+
+void TraceSpan::Begin(const char* spanName, const char* spanCategory)
+{
+    active = true;
+    name = spanName;
+    category = spanCategory;
+    parent = openSpan;
+    openSpan = this;
+    start = std::chrono::steady_clock::now();
+}
+
+void TraceSpan::End()
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    openSpan = parent;
+    if (parent != nullptr)
+    {
+        for (size_t i = 0; i < CounterCount; ++i)
+        {
+            parent->counters[i] += counters[i];
+        }
+    }
+
+    TraceEvent event{ name, category, start, end, std::move(detail), {} };
+    std::copy(std::begin(counters), std::end(counters), event.counters);
+    Record(std::move(event));
+}
+
+void TraceSpan::SetPathDetail(const std::filesystem::path& path)
+{
+    std::u8string text = path.generic_u8string();
+    detail.assign(text.begin(), text.end());
+}
+
+bool WriteTrace(const std::filesystem::path& traceFile, std::string& error)
+{
+    tracingEnabled.store(false, std::memory_order_relaxed);
+
+    std::ofstream output(traceFile, std::ios::binary | std::ios::trunc);
+    if (!output)
+    {
+        error = "Could not create " + traceFile.string();
+        return false;
+    }
+
+    // Complete events in microseconds since the trace started, and a name for every thread
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    for (const auto& thread : registry)
+    {
+        std::lock_guard<std::mutex> lock(thread->mutex);
+        output << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->threadId
+            << ",\"args\":{\"name\":\"" << (thread->threadId == 1 ? "main" : "thread " + std::to_string(thread->threadId)) << "\"}}";
+        first = false;
+
+        for (const auto& event : thread->events)
+        {
+            output << ",\n{\"name\":" << QuoteJson(event.name) << ",\"cat\":" << QuoteJson(event.category) << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId
+                << std::fixed << std::setprecision(1) << ",\"ts\":" << Microseconds(event.start - traceStart) << ",\"dur\":" << Microseconds(event.end - event.start)
+                << ",\"args\":{";
+            bool firstArgument = true;
+            if (!event.detail.empty())
+            {
+                output << "\"detail\":" << QuoteJson(event.detail);
+                firstArgument = false;
+            }
+            for (size_t i = 0; i < CounterCount; ++i)
+            {
+                if (event.counters[i] == 0) continue;
+                output << (firstArgument ? "" : ",") << '"' << CounterNames[i] << "\":" << event.counters[i];
+                firstArgument = false;
+            }
+            output << "}}";
+        }
+    }
+    output << "\n]}\n";
+
+    output.flush();
+    if (!output)
+    {
+        error = "Could not write " + traceFile.string();
+        return false;
+    }
+    return true;
+}
+
+void WriteTraceSummary(std::ostream& output)
+{
+    struct Totals
+    {
+        size_t count = 0;
+        double totalMilliseconds = 0.0;
+        double longestMilliseconds = 0.0;
+        uint64_t counters[CounterCount] = {};
+    };
+
+    std::map<std::string, Totals> totals;
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for (const auto& thread : registry)
+        {
+            std::lock_guard<std::mutex> lock(thread->mutex);
+            for (const auto& event : thread->events)
+            {
+                Totals& total = totals[event.name];
+                double milliseconds = Microseconds(event.end - event.start) / 1000.0;
+                total.count++;
+                total.totalMilliseconds += milliseconds;
+                total.longestMilliseconds = std::max(total.longestMilliseconds, milliseconds);
+                for (size_t i = 0; i < CounterCount; ++i)
+                {
+                    total.counters[i] += event.counters[i];
+                }
+            }
+        }
+    }
+
+    // Longest total first. Spans on worker threads overlap, so their totals can exceed the run time.
+    std::vector<std::pair<std::string, Totals>> rows(totals.begin(), totals.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.second.totalMilliseconds > b.second.totalMilliseconds; });
+
+    std::ios::fmtflags flags = output.flags();
+    std::streamsize precision = output.precision();
+    output << std::left << std::setw(32) << "Span" << std::right << std::setw(8) << "Count" << std::setw(12) << "Total ms" << std::setw(10) << "Max ms"
+        << std::setw(10) << "MB read" << std::setw(12) << "MB written" << std::setw(10) << "Matches" << std::setw(10) << "Syscalls" << std::endl;
+    for (const auto& [name, total] : rows)
+    {
+        output << std::left << std::setw(32) << name << std::right << std::setw(8) << total.count << std::fixed << std::setprecision(1)
+            << std::setw(12) << total.totalMilliseconds << std::setw(10) << total.longestMilliseconds
+            << std::setw(10) << total.counters[static_cast<size_t>(TraceCounter::BytesRead)] / 1048576.0
+            << std::setw(12) << total.counters[static_cast<size_t>(TraceCounter::BytesWritten)] / 1048576.0
+            << std::setw(10) << total.counters[static_cast<size_t>(TraceCounter::Matches)]
+            << std::setw(10) << total.counters[static_cast<size_t>(TraceCounter::SystemCalls)] << std::endl;
+    }
+    output.flags(flags);
+    output.precision(precision);
+}
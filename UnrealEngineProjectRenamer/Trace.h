@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Spans around the phases of a rename and the work done on each file, enabled with --trace. They
+// are written as a Chrome trace file, which chrome://tracing and ui.perfetto.dev open, and summed
+// up per span name in a table. While tracing is off a span costs one relaxed load and a branch,
+// so the spans stay in every build.
+
+// What a span counts besides its time
+enum class TraceCounter
+{
+    BytesRead,
+    BytesWritten,
+    Matches,
+    SystemCalls,
+    Count
+};
+
+extern std::atomic<bool> tracingEnabled;
+
+inline bool IsTracing()
+{
+    return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+// Start recording spans from every thread
+void StartTrace();
+
+// Stop recording and write every span recorded to a Chrome trace file
+bool WriteTrace(const std::filesystem::path& traceFile, std::string& error);
+
+// Print the count, total and longest time, and the counters of the spans of each name
+void WriteTraceSummary(std::ostream& output);
+
+// Add to a counter of the innermost span open on this thread, if any. Counters are added from deep
+// inside a step, such as the bytes of every file read, without passing the span down.
+void TraceAdd(TraceCounter counter, uint64_t value);
+
+// Record a span timed by the caller, for work that does not begin and end in one scope, such as a
+// child process started in one step and waited for in another
+void TraceInterval(const char* name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, std::string_view detail = {});
+
+// A span from its construction to its destruction, on the thread it was made on. Spans on one thread
+// nest, and the counters of a span are added to the span around it when it ends.
+class TraceSpan
+{
+public:
+    // `name` and `category` must be string literals, as only the pointers are kept
+    TraceSpan(const char* name, const char* category)
+    {
+        if (IsTracing()) Begin(name, category);
+    }
+
+    ~TraceSpan()
+    {
+        if (active) End();
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // What the span worked on, such as the file, shown with it in the trace
+    void SetDetail(std::string_view detail)
+    {
+        if (active) this->detail = detail;
+    }
+
+    void SetDetail(const std::string& detail)
+    {
+        if (active) this->detail = detail;
+    }
+
+    void SetDetail(const std::filesystem::path& path)
+    {
+        if (active) SetPathDetail(path);
+    }
+
+    void Add(TraceCounter counter, uint64_t value)
+    {
+        if (active) counters[static_cast<size_t>(counter)] += value;
+    }
+
+private:
+    friend void TraceAdd(TraceCounter counter, uint64_t value);
+
+    void Begin(const char* name, const char* category);
+    void End();
+    void SetPathDetail(const std::filesystem::path& path);
+
+    bool active = false;
+    const char* name = nullptr;
+    const char* category = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::string detail;
+    uint64_t counters[static_cast<size_t>(TraceCounter::Count)] = {};
+    TraceSpan* parent = nullptr;
+};
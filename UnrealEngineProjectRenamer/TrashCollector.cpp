@@ -0,0 +1,191 @@
+#include "TrashCollector.h"
+#include "Platform.h"
+#include "Trace.h"
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Files of one folder are deleted in chunks, so a folder with 100k files still spreads over every worker
+    const size_t FilesPerTask = 512;
+}
+
+// A folder being deleted. It is removed once its own listing, every chunk of its files and
+// every sub folder are done, which is tracked by `pending`; it then releases its parent.
+struct TrashCollector::Directory
+{
+    fs::path path;
+    std::shared_ptr<Directory> parent;
+    std::atomic<size_t> pending{ 1 };
+};
+
+TrashCollector::TrashCollector(const fs::path& trashDirectory, unsigned workerCount)
+    : trashDirectory(trashDirectory), pool(workerCount)
+{
+}
+
+TrashCollector::~TrashCollector()
+{
+    std::string ignored;
+    Join(ignored);
+}
+
+bool TrashCollector::MoveToTrash(const fs::path& path, std::error_code& error)
+{
+    fs::create_directories(trashDirectory, error);
+    if (error) return false;
+
+    // Keep the folder name visible in the trash and never collide with leftovers of earlier runs
+    fs::path trashPath = trashDirectory / path.filename();
+    for (unsigned suffix = 1; fs::exists(trashPath); ++suffix)
+    {
+        trashPath = trashDirectory / (path.filename().string() + "_" + std::to_string(suffix));
+    }
+
+    if (!RenamePath(path, trashPath, error)) return false;
+
+    Queue(trashPath);
+    return true;
+}
+
+size_t TrashCollector::ResumePending()
+{
+    std::error_code error;
+    if (!fs::is_directory(trashDirectory, error)) return 0;
+
+    size_t resumed = 0;
+    for (fs::directory_iterator it(trashDirectory, error), end; !error && it != end; it.increment(error))
+    {
+        Queue(it->path());
+        resumed++;
+    }
+    return resumed;
+}
+
+bool TrashCollector::Join(std::string& error)
+{
+    pool.Wait(group);
+
+    // Remove the trash folder itself once it is empty, a failed delete leaves it for the next run
+    std::error_code ignored;
+    fs::remove(trashDirectory, ignored);
+
+    std::lock_guard<std::mutex> lock(errorMutex);
+    error = firstError;
+    return failedEntries == 0;
+}
+
+void TrashCollector::Queue(const fs::path& path)
+{
+    auto directory = std::make_shared<Directory>();
+    directory->path = path;
+
+    std::error_code error;
+    if (!fs::is_directory(fs::symlink_status(path, error)))
+    {
+        // A stray file in the trash
+        pool.Submit(group, [this, path]() { RemoveEntry(path); });
+        return;
+    }
+
+    pool.Submit(group, [this, directory]() { DeleteDirectory(directory); });
+}
+
+void TrashCollector::DeleteDirectory(const std::shared_ptr<Directory>& directory)
+{
+    TraceSpan span("DeleteDirectory", "delete");
+    span.SetDetail(directory->path);
+
+    std::vector<fs::path> files;
+    std::vector<fs::path> subdirectories;
+
+    std::error_code error;
+    for (fs::directory_iterator it(directory->path, error), end; !error && it != end; it.increment(error))
+    {
+        // Links are removed, never followed
+        std::error_code statusError;
+        if (it->is_directory(statusError) && !it->is_symlink(statusError))
+        {
+            subdirectories.push_back(it->path());
+        }
+        else
+        {
+            files.push_back(it->path());
+        }
+    }
+
+    size_t chunks = files.size() > FilesPerTask ? (files.size() - 1) / FilesPerTask : 0;
+    directory->pending += subdirectories.size() + chunks;
+
+    // Hand out all but the first chunk of files, which this task deletes itself
+    for (size_t chunk = 1; chunk <= chunks; ++chunk)
+    {
+        size_t begin = chunk * FilesPerTask;
+        size_t end = begin + FilesPerTask < files.size() ? begin + FilesPerTask : files.size();
+        std::vector<fs::path> chunkFiles(std::make_move_iterator(files.begin() + begin), std::make_move_iterator(files.begin() + end));
+
+        pool.Submit(group, [this, directory, chunkFiles = std::move(chunkFiles)]()
+            {
+                TraceSpan span("DeleteFiles", "delete");
+                span.SetDetail(directory->path);
+                for (const auto& file : chunkFiles)
+                {
+                    RemoveEntry(file);
+                }
+                Release(directory);
+            });
+    }
+
+    for (const auto& subdirectoryPath : subdirectories)
+    {
+        auto subdirectory = std::make_shared<Directory>();
+        subdirectory->path = subdirectoryPath;
+        subdirectory->parent = directory;
+        pool.Submit(group, [this, subdirectory]() { DeleteDirectory(subdirectory); });
+    }
+
+    size_t firstChunkEnd = files.size() < FilesPerTask ? files.size() : FilesPerTask;
+    for (size_t i = 0; i < firstChunkEnd; ++i)
+    {
+        RemoveEntry(files[i]);
+    }
+    Release(directory);
+}
+
+void TrashCollector::Release(std::shared_ptr<Directory> directory)
+{
+    // The last piece of work in a folder removes it and then counts as done for its parent
+    while (directory && --directory->pending == 0)
+    {
+        RemoveEntry(directory->path);
+        directory = directory->parent;
+    }
+}
+
+void TrashCollector::RemoveEntry(const fs::path& path)
+{
+    TraceAdd(TraceCounter::SystemCalls, 1);
+
+    std::error_code error;
+    if (!fs::remove(path, error) && error)
+    {
+        // Read-only files cannot be deleted on Windows until they are made writable
+        std::error_code ignored;
+        fs::permissions(path, fs::perms::owner_write, fs::perm_options::add | fs::perm_options::nofollow, ignored);
+        error.clear();
+        fs::remove(path, error);
+    }
+
+    if (error)
+    {
+        failedEntries++;
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (firstError.empty())
+        {
+            firstError = "Could not delete " + path.string() + ": " + error.message();
+        }
+        return;
+    }
+    deletedEntries++;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include "ThreadPool.h"
+
+// Deletes cache folders off the critical path. A folder is first renamed into the trash folder,
+// which is a single metadata operation on the same volume, and its tree is then unlinked in the
+// background by a few workers of a private pool while the rename carries on. Anything still in the
+// trash when the process exits is picked up again by the next run.
+class TrashCollector
+{
+public:
+    TrashCollector(const std::filesystem::path& trashDirectory, unsigned workerCount);
+    ~TrashCollector();
+
+    TrashCollector(const TrashCollector&) = delete;
+    TrashCollector& operator=(const TrashCollector&) = delete;
+
+    // Move a folder into the trash and queue it for deletion. Fails if the folder cannot be
+    // renamed, for example when a file in it is still open on Windows.
+    bool MoveToTrash(const std::filesystem::path& path, std::error_code& error);
+
+    // Queue whatever an earlier run left in the trash, and return how many items were found
+    size_t ResumePending();
+
+    // Block until everything queued so far is deleted. Returns false if anything could not be deleted.
+    bool Join(std::string& firstError);
+
+    size_t DeletedEntries() const { return deletedEntries; }
+
+private:
+    struct Directory;
+
+    void Queue(const std::filesystem::path& path);
+    void DeleteDirectory(const std::shared_ptr<Directory>& directory);
+    void Release(std::shared_ptr<Directory> directory);
+    void RemoveEntry(const std::filesystem::path& path);
+
+    std::filesystem::path trashDirectory;
+    ThreadPool pool;
+    TaskGroup group;
+
+    std::atomic<size_t> deletedEntries{ 0 };
+    std::atomic<size_t> failedEntries{ 0 };
+    std::mutex errorMutex;
+    std::string firstError;
+};
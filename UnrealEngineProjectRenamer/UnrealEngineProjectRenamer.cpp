@@ -1,1119 +1,438 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <regex>
-#include <algorithm>
-#include <cstdlib>
-#include <conio.h>
-#include <windows.h>
-#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 #include "globals.h"
+#include "Platform.h"
+#include "ProjectRenamer.h"
+#include "Trace.h"
 
-// Set console text colour
-void SetConsoleColour(WORD colour)
+// Print command line usage
+void PrintUsage()
 {
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hConsole, colour);
+    std::cout << "\nUsage: UnrealEngineProjectRenamer [options]" << std::endl;
+    std::cout << "\nWithout --project or --manifest the tool runs interactively. Otherwise it runs unattended and never prompts:" << std::endl;
+    std::cout << "  --project <dir>     Project root directory containing the .uproject file" << std::endl;
+    std::cout << "  --name <name>       New project name (required with --project)" << std::endl;
+    std::cout << "  --module <name>     C++ module that takes the new name (defaults to the first module in the .uproject)" << std::endl;
+    std::cout << "  --engine <dir>      Unreal Engine directory used to generate project files (found from EngineAssociation if omitted)" << std::endl;
+    std::cout << "  --yes               Accept the backup warning" << std::endl;
+    std::cout << "  --clean-cache       Delete the Saved, Intermediate and Binaries folders" << std::endl;
+    std::cout << "  --clean-stale-cache Delete only build products named after the old project or module, keeping other caches" << std::endl;
+    std::cout << "  --engine-search <dirs> Extra folders holding engine installs, separated like PATH (also UEPR_ENGINE_SEARCH_PATH)" << std::endl;
+    std::cout << "  --no-generate       Do not generate Visual Studio project files" << std::endl;
+    std::cout << "  --ubt-timeout <s>   Stop UnrealBuildTool if generating project files takes longer (default 600)" << std::endl;
+    std::cout << "  --dry-run           Print every rename, deletion and edit with unified diffs without changing anything" << std::endl;
+    std::cout << "  --jobs <n>, -j <n>  Number of worker threads (defaults to the number of CPU threads)" << std::endl;
+    std::cout << "  --io <backend>      How files are read and rewritten: auto (default), io_uring (Linux) or threads" << std::endl;
+    std::cout << "  --manifest <file>   Rename every project listed as \"<project root>,<new name>[,<module>]\" lines" << std::endl;
+    std::cout << "  --where <name>      List every place a module name or API macro appears in the --project, from the reference index, and exit" << std::endl;
+    std::cout << "  --quiet             Only print warnings and errors" << std::endl;
+    std::cout << "  --verbose           Also print files that needed no change and backups already taken" << std::endl;
+    std::cout << "  --log-json <file>   Write every message, at every level, to a file as JSON lines" << std::endl;
+    std::cout << "  --trace <file>      Write a Chrome trace of every phase and file operation, and print a summary of it" << std::endl;
+    std::cout << "  --restore <dir>     Restore the files of a UEPR_Backups run folder and exit" << std::endl;
+    std::cout << "  --rollback <dir>    Undo every change journaled in a UEPR_Backups run folder, including renames, and exit" << std::endl;
+    std::cout << "\nExit codes: 0 success, 1 invalid arguments, 2 invalid project, 3 rename completed with errors" << std::endl;
 }
 
-
-// Function to replace all instances of a substring with another substring
-void ReplaceAll(std::string& str, const std::string& from, const std::string& to)
+// Add every folder of a PATH style list to the engine search path
+void AppendSearchPath(const std::string& folders)
 {
-    if (from.empty()) return;
-    size_t start_pos = 0;
-    while ((start_pos = str.find(from, start_pos)) != std::string::npos)
+    std::stringstream list(folders);
+    std::string folder;
+    while (std::getline(list, folder, PathListSeparator))
     {
-        str.replace(start_pos, from.length(), to);
-        start_pos += to.length();
+        if (!folder.empty())
+        {
+            engineSearchPath.push_back(folder);
+        }
     }
 }
 
-// Function to backup a file
-void BackupFile(const fs::path& filePath)
+// Parse command line options. Returns false if the arguments are invalid.
+bool ParseCommandLine(int argc, char* argv[])
 {
-    if (fs::exists(filePath))
+    for (int i = 1; i < argc; ++i)
     {
-        // Get the relative path of the file with respect to the project root directory
-        fs::path relativePath = fs::relative(filePath, projectRootDirectory);
-        fs::path backupFilePath = backupDirectory / relativePath;
-
-        // Create the necessary directories in the backup location
-        fs::create_directories(backupFilePath.parent_path());
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
 
-        try
+        if (argument == "--help" || argument == "-h")
         {
-            fs::copy_file(filePath, backupFilePath, fs::copy_options::overwrite_existing);
-            SetConsoleColour(COLOUR_GREEN);
-            std::cout << "\nSuccessfully backed up file: " << backupFilePath << std::endl;
+            PrintUsage();
+            std::exit(EXIT_CODE_SUCCESS);
         }
-        catch (const fs::filesystem_error& e)
+        else if (argument == "--yes")
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nERROR: Failed to back up file " << filePath << ": " << e.what() << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            assumeYes = true;
         }
-    }
-    else
-    {
-        SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: File " << filePath << " does not exist." << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-}
-
-void MakeFileWritable(const std::filesystem::path& filePath)
-{
-    try
-    {
-        auto perms = std::filesystem::status(filePath).permissions();
-        if ((perms & std::filesystem::perms::owner_write) == std::filesystem::perms::none)
+        else if (argument == "--clean-cache")
         {
-            // Add write permission
-            std::filesystem::permissions(filePath,
-                perms | std::filesystem::perms::owner_write,
-                std::filesystem::perm_options::add);
+            cacheCleanup = CacheCleanup::All;
         }
-    }
-    catch (const std::exception& e)
-    {
-        SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nFailed to modify file permissions: " << e.what() << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-}
-
-// Function to backup a folder
-void BackupFolder(const fs::path& folderPath)
-{
-    if (fs::exists(folderPath) && fs::is_directory(folderPath))
-    {
-        // Get the relative path of the folder with respect to the project root directory
-        fs::path relativePath = fs::relative(folderPath, projectRootDirectory);
-        fs::path backupFolderPath = backupDirectory / relativePath;
-
-        // Create the necessary directories in the backup location
-        fs::create_directories(backupFolderPath);
-
-        try
+        else if (argument == "--clean-stale-cache")
         {
-            fs::copy(folderPath, backupFolderPath, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
-            SetConsoleColour(COLOUR_GREEN);
-            std::cout << "\nSuccessfully backed up folder: " << backupFolderPath << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            cacheCleanup = CacheCleanup::Stale;
         }
-        catch (const fs::filesystem_error& e)
+        else if (argument == "--no-generate")
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nERROR: Failed to back up folder " << folderPath << ": " << e.what() << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            skipProjectFileGeneration = true;
         }
-    }
-    else
-    {
-        SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: Folder " << folderPath << " does not exist or is not a directory." << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-}
-
-
-// Backup / issue warning
-void DisplayWarningAndGetConfirmation()
-{
-    std::string userInput;
-
-    while (true)
-    {
-        SetConsoleColour(COLOUR_ORANGE);
-        std::cout << "\nINFO: While this software does automatically create a backup of all changed files, it's still recommended to make a manual backup yourself." << std::endl;
-        std::cout << "\nTo declare you have made a backup and or that you accept the consequences, type 'YES': ";
-        std::getline(std::cin, userInput);
-
-        if (userInput == "YES")
+        else if (argument == "--dry-run")
         {
-            SetConsoleColour(COLOUR_GREEN);
-            std::cout << "Successfully accepted. Proceeding with the operation..." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-            break;
+            isDryRun = true;
         }
-        else
+        else if (argument == "--project" && hasValue)
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cout << "ERROR: Invalid input. Please type 'YES' to confirm you have made a backup and accept the consequences." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            commandLineProject.projectRootDirectory = argv[++i];
+            isBatchMode = true;
         }
-    }
-}
-
-void SelectProjectPath()
-{
-    bool isValidDirectory = false;
-    bool foundUprojectFile = false;
-
-    while (!isValidDirectory || !foundUprojectFile)
-    {
-        SetConsoleColour(COLOUR_WHITE);
-        std::cout << "\nPlease enter the project root directory: ";
-        std::getline(std::cin, projectRootDirectory);
-
-        // Check if the directory exists
-        if (fs::exists(projectRootDirectory) && fs::is_directory(projectRootDirectory))
+        else if (argument == "--name" && hasValue)
         {
-            isValidDirectory = true;
-            SetConsoleColour(COLOUR_GREEN);
-            std::cout << "\nSuccessfully located directory";
-            SetConsoleColour(COLOUR_WHITE);
-
-            // Look for a .uproject file in the directory
-            foundUprojectFile = false;
-            for (const auto& entry : fs::directory_iterator(projectRootDirectory))
-            {
-                if (entry.is_regular_file() && entry.path().extension() == ".uproject")
-                {
-                    oldUprojectFilePath = entry.path();
-                    foundUprojectFile = true;
-                    SetConsoleColour(COLOUR_GREEN);
-                    std::cout << "\nSuccessfully validated that directory is an Unreal engine project";
-                    SetConsoleColour(COLOUR_WHITE);
-                    break;
-                }
-            }
-
-            if (!foundUprojectFile)
-            {
-                SetConsoleColour(COLOUR_RED);
-                std::cout << "\nERROR: No .uproject file found in the directory. Please try again." << std::endl;
-                SetConsoleColour(COLOUR_WHITE);
-            }
+            commandLineProject.newProjectName = argv[++i];
         }
-        else
+        else if (argument == "--module" && hasValue)
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cout << "\nERROR: The provided path is not a valid directory. Please try again." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-            isValidDirectory = false;
+            commandLineProject.userCPPSourceName = argv[++i];
         }
-    }
-}
-
-void CreateBackupFolder()
-{
-    // Create the backup directory path
-    backupDirectory = fs::path(projectRootDirectory) / "UEPR_Backups";
-
-    // Create the UEPR_Backups directory if it doesn't exist
-    if (!fs::exists(backupDirectory))
-    {
-        fs::create_directory(backupDirectory);
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nCreated backup directory: " << backupDirectory << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-
-    // Get current date and time
-    auto now = std::chrono::system_clock::now();
-    std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-    std::tm now_tm;
-    localtime_s(&now_tm, &now_time);
-
-    // Format the date and time as "YYYY-MM-DD_HH-MM-SS"
-    std::stringstream ss;
-    ss << std::put_time(&now_tm, "%Y-%m-%d_%H-%M-%S");
-    backupFolderName = ss.str();
-
-    // Create the date-time named folder inside UEPR_Backups
-    backupDirectory /= backupFolderName;
-    if (!fs::exists(backupDirectory))
-    {
-        fs::create_directory(backupDirectory);
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nCreated date-time backup folder: " << backupDirectory << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-}
-
-void CheckIfCPPProject()
-{
-    fs::path sourcePath = fs::path(projectRootDirectory) / "Source";
-
-    if (fs::exists(sourcePath) && fs::is_directory(sourcePath))
-    {
-        isCPPProject = true;
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nCPP Project Detected" << std::endl;
-    }
-    else
-    {
-        isCPPProject = false;
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nBlueprint Only Project Detected" << std::endl;
-    }
-    SetConsoleColour(COLOUR_WHITE);
-}
-
-
-// Set new project name
-void SetNewProjectName()
-{
-    const std::string invalidChars = "\\/:*?\"<>|";
-
-    while (true)
-    {
-        // Set new project name
-        SetConsoleColour(COLOUR_WHITE);
-        std::cout << "\nPlease enter the new desired project name: ";
-        std::getline(std::cin, newProjectName);
-
-        if (newProjectName.empty())
+        else if (argument == "--engine" && hasValue)
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cout << "ERROR: Project name cannot be empty. Please try again." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-            continue;
+            commandLineProject.unrealEngineDirectory = argv[++i];
         }
-
-        if (newProjectName.length() > 255)
+        else if (argument == "--engine-search" && hasValue)
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cout << "ERROR: Project name is too long. Please use a name with 255 characters or fewer." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-            continue;
+            AppendSearchPath(argv[++i]);
         }
-
-        bool isValid = true;
-        for (char c : newProjectName)
+        else if (argument == "--manifest" && hasValue)
         {
-            if (invalidChars.find(c) != std::string::npos)
-            {
-                SetConsoleColour(COLOUR_RED);
-                std::cout << "ERROR: Project name contains invalid characters. Avoid using: \\ / : * ? \" < > |" << std::endl;
-                SetConsoleColour(COLOUR_WHITE);
-                isValid = false;
-                break;
-            }
+            manifestPath = argv[++i];
+            isManifestMode = true;
+            isBatchMode = true;
         }
-
-        if (isValid)
+        else if (argument == "--where" && hasValue)
         {
-            break;
+            referenceQuery = argv[++i];
         }
-    }
-}
-
-
-// Set Uproject Module Name
-void SetUprojectModuleName()
-{
-    MakeFileWritable(oldUprojectFilePath);
-    BackupFile(oldUprojectFilePath);
-
-    if (isCPPProject)
-    {
-        // Read the content of the .uproject file
-        std::ifstream inputFile(oldUprojectFilePath);
-        if (!inputFile)
+        else if (argument == "--quiet")
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nERROR: Failed to open the .uproject file." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            consoleLogLevel = LogLevel::Warning;
         }
-
-        std::stringstream buffer;
-        buffer << inputFile.rdbuf();
-        std::string fileContent = buffer.str();
-        inputFile.close();
-
-        // Find the old project name in the "Modules" section
-        std::regex nameRegex(R"("Modules":\s*\[\s*\{\s*"Name":\s*"([^"]+))");
-        std::smatch matches;
-        std::string oldProjectName;
-
-        if (std::regex_search(fileContent, matches, nameRegex) && matches.size() > 1)
+        else if (argument == "--verbose")
         {
-            oldProjectName = matches[1].str();
+            consoleLogLevel = LogLevel::Verbose;
         }
-        else
+        else if (argument == "--log-json" && hasValue)
         {
-
-            SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nERROR: Could not find the module name in the .uproject file." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            jsonLogPath = argv[++i];
         }
-
-        ReplaceAll(fileContent, oldProjectName, newProjectName);
-
-        // Write the modified content back to the .uproject file
-        std::ofstream outputFile(oldUprojectFilePath);
-        if (!outputFile)
+        else if (argument == "--trace" && hasValue)
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nERROR: Error writing to the .uproject file." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            traceFilePath = argv[++i];
         }
-        outputFile << fileContent;
-        outputFile.close();
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nSuccessfully modified .uproject file module name to : " << newProjectName << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-    else
-    {
-        SetConsoleColour(COLOUR_GREEN);
-        std::cerr << "\nNo module name detected in the .uproject file as project is blueprint only." << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-}
-
-
-// Rename .uproject file
-void RenameUprojectFile()
-{
-    newUprojectFilePath = oldUprojectFilePath.parent_path() / (newProjectName + ".uproject");
-
-    try
-    {
-        fs::rename(oldUprojectFilePath, newUprojectFilePath);
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nSuccessfully renamed project file to: " << newUprojectFilePath << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-    catch (const fs::filesystem_error& e)
-    {
-        SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: Error renaming project file: " << e.what() << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
-    }
-}
-
-
-// Locate target files
-void EditTargetFiles()
-{
-    sourceDirectory = fs::path(projectRootDirectory) / "Source";
-
-    if (!fs::exists(sourceDirectory) || !fs::is_directory(sourceDirectory))
-    {
-        if (isCPPProject)
+        else if (argument == "--restore" && hasValue)
         {
-            SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nERROR: Source directory does not exist." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
+            restoreBackupPath = argv[++i];
         }
-        else
+        else if (argument == "--rollback" && hasValue)
         {
-            SetConsoleColour(COLOUR_GREEN);
-            std::cerr << "\nNo source directory detected as project is blueprint only." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-            
+            rollbackRunPath = argv[++i];
         }
-        return;
-    }
-
-    bool targetFileFound = false;
-    bool editorTargetFileFound = false;
-
-    for (const auto& entry : fs::directory_iterator(sourceDirectory))
-    {
-        if (entry.is_regular_file())
+        else if ((argument == "--jobs" || argument == "-j") && hasValue)
         {
-            std::string filename = entry.path().filename().string();
-            std::string oldName = filename.substr(0, filename.find('.'));
-            fs::path newFilePath;
-
-            if (filename.size() > 16 && filename.substr(filename.size() - 16) == "Editor.Target.cs")
+            std::string value = argv[++i];
+            try
             {
-                editorTargetFileFound = true;
-                oldName = filename.substr(0, filename.size() - 16);
-                newFilePath = sourceDirectory / (newProjectName + "Editor.Target.cs");
-
-                MakeFileWritable(entry.path());
-
-                // Backup the file
-                BackupFile(entry.path());
-
-                // Rename the file
-                fs::rename(entry.path(), newFilePath);
-
-                // Replace contents within the file
-                std::ifstream editorTargetFile(newFilePath);
-                std::stringstream buffer;
-                buffer << editorTargetFile.rdbuf();
-                std::string fileContent = buffer.str();
-                editorTargetFile.close();
-
-                ReplaceAll(fileContent, oldName, newProjectName);
-
-                std::ofstream outFile(newFilePath);
-                outFile << fileContent;
-                outFile.close();
-
-                SetConsoleColour(COLOUR_GREEN);
-                std::cout << "\nSuccessfully renamed and updated Editor Target file to: " << newFilePath << std::endl;
+                int jobs = std::stoi(value);
+                if (jobs < 1) throw std::out_of_range("jobs");
+                jobCount = static_cast<unsigned>(jobs);
+            }
+            catch (const std::exception&)
+            {
+                SetConsoleColour(COLOUR_RED);
+                std::cerr << "\nERROR: --jobs expects a positive number, got: " << value << std::endl;
                 SetConsoleColour(COLOUR_WHITE);
-                continue;
+                return false;
             }
-
-            if (filename.size() > 10 && filename.substr(filename.size() - 10) == ".Target.cs")
+        }
+        else if (argument == "--io" && hasValue)
+        {
+            std::string value = argv[++i];
+            if (value == "auto") fileIoBackend = FileIoBackend::Auto;
+            else if (value == "io_uring") fileIoBackend = FileIoBackend::IoUring;
+            else if (value == "threads") fileIoBackend = FileIoBackend::ThreadPool;
+            else
             {
-                targetFileFound = true;
-                oldName = filename.substr(0, filename.size() - 10);
-                newFilePath = sourceDirectory / (newProjectName + ".Target.cs");
-
-                MakeFileWritable(entry.path());
-
-                // Backup the file
-                BackupFile(entry.path());
-
-                // Rename the file
-                fs::rename(entry.path(), newFilePath);
-
-                // Replace references within the file
-                std::ifstream targetFile(newFilePath);
-                std::stringstream buffer;
-                buffer << targetFile.rdbuf();
-                std::string fileContent = buffer.str();
-                targetFile.close();
-
-                ReplaceAll(fileContent, oldName, newProjectName);
-
-                std::ofstream outFile(newFilePath);
-                outFile << fileContent;
-                outFile.close();
-
-                SetConsoleColour(COLOUR_GREEN);
-                std::cout << "\nSuccessfully renamed and updated Target file to: " << newFilePath << std::endl;
+                SetConsoleColour(COLOUR_RED);
+                std::cerr << "\nERROR: --io expects auto, io_uring or threads, got: " << value << std::endl;
                 SetConsoleColour(COLOUR_WHITE);
+                return false;
             }
         }
+        else if (argument == "--ubt-timeout" && hasValue)
+        {
+            std::string value = argv[++i];
+            try
+            {
+                int seconds = std::stoi(value);
+                if (seconds < 1) throw std::out_of_range("ubt-timeout");
+                projectFileGenerationTimeout = std::chrono::seconds(seconds);
+            }
+            catch (const std::exception&)
+            {
+                SetConsoleColour(COLOUR_RED);
+                std::cerr << "\nERROR: --ubt-timeout expects a positive number of seconds, got: " << value << std::endl;
+                SetConsoleColour(COLOUR_WHITE);
+                return false;
+            }
+        }
+        else
+        {
+            SetConsoleColour(COLOUR_RED);
+            std::cerr << "\nERROR: Unknown or incomplete argument: " << argument << std::endl;
+            SetConsoleColour(COLOUR_WHITE);
+            PrintUsage();
+            return false;
+        }
     }
 
-    if (!targetFileFound)
+    if (isManifestMode && !commandLineProject.projectRootDirectory.empty())
     {
         SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: No Target file found in the Source directory." << std::endl;
+        std::cerr << "\nERROR: --project and --manifest cannot be used together." << std::endl;
         SetConsoleColour(COLOUR_WHITE);
+        return false;
     }
 
-    if (!editorTargetFileFound)
+    if (!referenceQuery.empty() && commandLineProject.projectRootDirectory.empty())
     {
         SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: No Editor Target file found in the Source directory." << std::endl;
+        std::cerr << "\nERROR: --where needs the project given with --project." << std::endl;
         SetConsoleColour(COLOUR_WHITE);
+        return false;
     }
-}
-
-void EditSourceFolder()
-{
-    if (isCPPProject)
-    { 
-        ShellExecute(NULL, L"open", sourceDirectory.c_str(), NULL, NULL, SW_SHOWNORMAL);
-
-        while (true)
-        {
-            SetConsoleColour(COLOUR_WHITE);
-            std::cout << "\nPlease enter the EXACT name of the folder currently containing your C++ source files: ";
-            std::getline(std::cin, userCPPSourceName);
-
-            fs::path folderPath = sourceDirectory / userCPPSourceName;
-
-            if (fs::exists(folderPath) && fs::is_directory(folderPath))
-            {
-                //Backup the entire folder
-                BackupFolder(folderPath);
-
-                // Process all .h files recursively
-                for (const auto& entry : fs::recursive_directory_iterator(folderPath))
-                {
-                    if (entry.is_regular_file() && entry.path().extension() == ".h")
-                    {
-                        MakeFileWritable(entry.path());
-
-                        std::string filename = entry.path().filename().string();
-
-                        // Read and modify the .h file
-                        std::ifstream headerFile(entry.path());
-                        std::stringstream buffer;
-                        buffer << headerFile.rdbuf();
-                        std::string fileContent = buffer.str();
-                        headerFile.close();
-
-                        // Replace the API macro name
-                        std::string oldAPIName = userCPPSourceName + "_API";
-                        std::string newAPIName = newProjectName + "_API";
-
-                        // Convert newAPINames to uppercase
-                        std::transform(oldAPIName.begin(), oldAPIName.end(), oldAPIName.begin(),
-                            [](unsigned char c)
-                            {
-                                return std::toupper(c);
-                            });
-
-
-                        std::transform(newAPIName.begin(), newAPIName.end(), newAPIName.begin(),
-                            [](unsigned char c)
-                            {
-                                return std::toupper(c);
-                            });
-
-                        ReplaceAll(fileContent, oldAPIName, newAPIName);
-
-                        // Write the modified content back to the file
-                        std::ofstream outFile(entry.path());
-                        outFile << fileContent;
-                        outFile.close();
-
-                        SetConsoleColour(COLOUR_GREEN);
-                        std::cout << "\nSuccessfully updated .h file: " << entry.path() << std::endl;
-                        SetConsoleColour(COLOUR_WHITE);
-                    }
-                }
-
-                fs::path newFolderPath = sourceDirectory / newProjectName;
-                //Find and edit .Build.cs
-                bool buildFileFound = false;
-                for (const auto& entry : fs::directory_iterator(folderPath))
-                {
-                    if (entry.is_regular_file())
-                    {
-                        std::string filename = entry.path().filename().string();
-                        if (filename.size() > 9 && filename.substr(filename.size() - 9) == ".Build.cs")
-                        {
-                            buildFileFound = true;
-                            MakeFileWritable(entry.path());
-
-                            // Read and modify the .Build.cs file
-                            std::ifstream buildFile(entry.path());
-                            std::stringstream buffer;
-                            buffer << buildFile.rdbuf();
-                            std::string fileContent = buffer.str();
-                            buildFile.close();
-
-                            ReplaceAll(fileContent, userCPPSourceName, newProjectName);
-
-                            std::ofstream outFile(entry.path());
-                            outFile << fileContent;
-                            outFile.close();
-
-                            // Rename the .Build.cs file
-                            fs::path newBuildFilePath = folderPath / (newProjectName + ".Build.cs");
-                            fs::rename(entry.path(), newBuildFilePath);
-
-                            SetConsoleColour(COLOUR_GREEN);
-                            std::cout << "\nSuccessfully renamed and updated .Build.cs file to: " << newBuildFilePath << std::endl;
-                            SetConsoleColour(COLOUR_WHITE);
-                            break;
-                        }
-                    }
-                }
-
-                if (!buildFileFound)
-                {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cerr << "\nERROR: No .Build.cs file found in the specified folder. Please try again." << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                    continue;  // Continue the loop to prompt the user again
-                }
-
-                // Find and edit .cpp and .h files
-                bool cppFileFound = false;
-                bool headerFileFound = false;
-
-                for (const auto& entry : fs::directory_iterator(folderPath))
-                {
-                    if (entry.is_regular_file())
-                    {
-                        std::string filename = entry.path().filename().string();
-
-                        if (filename == userCPPSourceName + ".cpp")
-                        {
-                            cppFileFound = true;
-                            MakeFileWritable(entry.path());
-
-                            // Read and modify the .cpp file
-                            std::ifstream cppFile(entry.path());
-                            std::stringstream buffer;
-                            buffer << cppFile.rdbuf();
-                            std::string fileContent = buffer.str();
-                            cppFile.close();
-
-                            ReplaceAll(fileContent, "#include \"" + userCPPSourceName + ".h\"", "#include \"" + newProjectName + ".h\"");
-                            ReplaceAll(fileContent, "IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, " + userCPPSourceName + ", \"" + userCPPSourceName + "\" );", "IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, " + newProjectName + ", \"" + newProjectName + "\" );");
-
-                            std::ofstream outFile(entry.path());
-                            outFile << fileContent;
-                            outFile.close();
-
-                            // Rename the .cpp file
-                            fs::path newCppFilePath = folderPath / (newProjectName + ".cpp");
-                            fs::rename(entry.path(), newCppFilePath);
-
-                            SetConsoleColour(COLOUR_GREEN);
-                            std::cout << "\nSuccessfully renamed and updated .cpp file to: " << newCppFilePath << std::endl;
-                            SetConsoleColour(COLOUR_WHITE);
-                        }
 
-                        if (filename == userCPPSourceName + ".h")
-                        {
-                            headerFileFound = true;
-
-                            MakeFileWritable(entry.path());
-
-                            // Rename the .h file
-                            fs::path newHeaderFilePath = folderPath / (newProjectName + ".h");
-                            fs::rename(entry.path(), newHeaderFilePath);
-
-                            SetConsoleColour(COLOUR_GREEN);
-                            std::cout << "\nSuccessfully renamed .h file to: " << newHeaderFilePath << std::endl;
-                            SetConsoleColour(COLOUR_WHITE);
-                        }
-                    }
-                }
+    if (isBatchMode && !isManifestMode && referenceQuery.empty() && commandLineProject.newProjectName.empty())
+    {
+        SetConsoleColour(COLOUR_RED);
+        std::cerr << "\nERROR: --name is required when running with --project." << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+        return false;
+    }
 
-                if (!cppFileFound || !headerFileFound)
-                {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cerr << "\nERROR: Could not find .cpp and/or .h file in the specified folder. Please try again." << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                    continue;  // Continue the loop to prompt the user again
-                }
+    AppendSearchPath(EnvironmentVariable("UEPR_ENGINE_SEARCH_PATH"));
 
-                // Rename source file folder
-                try
-                {
-                    fs::rename(folderPath, newFolderPath);
-                    SetConsoleColour(COLOUR_GREEN);
-                    std::cout << "\nSuccessfully renamed C++ source folder to: " << newFolderPath << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                    break;  // Exit the loop if successful
-                }
-                catch (const fs::filesystem_error& e)
-                {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cerr << "\nError: Error renaming C++ source folder: " << e.what() << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                }
-            }
-            else
-            {
-                SetConsoleColour(COLOUR_RED);
-                std::cerr << "\nERROR: The specified folder does not exist in the Source directory. Please try again." << std::endl;
-                SetConsoleColour(COLOUR_WHITE);
-            }
-        }
-    }
-    else
+    if (jobCount == 0)
     {
-        SetConsoleColour(COLOUR_GREEN);
-        std::cerr << "\nNo source directory detected as project is blueprint only." << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
+        unsigned hardwareThreads = std::thread::hardware_concurrency();
+        jobCount = hardwareThreads > 0 ? hardwareThreads : 1;
     }
+    return true;
 }
 
-// Function to edit config files
-void EditConfigFiles()
-{
-    fs::path configDirectory = fs::path(projectRootDirectory) / "Config";
-    fs::path defaultEngineIniPath = configDirectory / "DefaultEngine.ini";
 
-    if (!fs::exists(configDirectory) || !fs::is_directory(configDirectory))
+// Read the manifest into one context per project. Each line is "<project root>,<new name>[,<module>]",
+// blank lines and lines starting with '#' are ignored.
+bool LoadManifest(std::vector<std::unique_ptr<ProjectContext>>& projects)
+{
+    std::ifstream manifest(manifestPath);
+    if (!manifest)
     {
         SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: Config directory does not exist." << std::endl;
+        std::cerr << "\nERROR: Could not open manifest file: " << manifestPath << std::endl;
         SetConsoleColour(COLOUR_WHITE);
-        return;
+        return false;
     }
 
-    // Update all config files
-    for (const auto& entry : fs::directory_iterator(configDirectory))
-    {
-        if (entry.is_regular_file())
+    auto trim = [](std::string text)
         {
-            // Backup the file
-            MakeFileWritable(entry.path());
-
-            BackupFile(entry.path());
-
-            std::string filename = entry.path().filename().string();
-
-            // Read and modify the config file
-            std::ifstream configFile(entry.path());
-            std::stringstream buffer;
-            buffer << configFile.rdbuf();
-            std::string fileContent = buffer.str();
-            configFile.close();
-
-            ReplaceAll(fileContent, userCPPSourceName, newProjectName);
-
-            std::ofstream outFile(entry.path());
-            outFile << fileContent;
-            outFile.close();
+            size_t start = text.find_first_not_of(" \t\r");
+            size_t end = text.find_last_not_of(" \t\r");
+            return start == std::string::npos ? std::string() : text.substr(start, end - start + 1);
+        };
 
-            SetConsoleColour(COLOUR_GREEN);
-            std::cout << "\nSuccessfully updated config file: " << entry.path() << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-        }
-    }
-
-    // Specific logic for DefaultEngine.ini
-    if (fs::exists(defaultEngineIniPath))
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(manifest, line))
     {
-        MakeFileWritable(defaultEngineIniPath);
+        lineNumber++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
 
-        std::ifstream configFile(defaultEngineIniPath);
-        std::stringstream buffer;
-        buffer << configFile.rdbuf();
-        std::string fileContent = buffer.str();
-        configFile.close();
-
-        // Check for [URL] section
-        std::size_t urlPos = fileContent.find("[URL]");
-        if (urlPos == std::string::npos)
+        std::vector<std::string> fields;
+        std::stringstream lineStream(line);
+        std::string field;
+        while (std::getline(lineStream, field, ','))
         {
-            // Add [URL] section if it doesn't exist
-            fileContent += "\n[URL]\nGameName=" + newProjectName + "\n";
-        }
-        else
-        {
-            // Check for GameName= under [URL] section
-            std::size_t gameNamePos = fileContent.find("GameName=", urlPos);
-            std::size_t nextSectionPos = fileContent.find('[', urlPos + 1);
-            if (gameNamePos == std::string::npos || (nextSectionPos != std::string::npos && gameNamePos > nextSectionPos))
-            {
-                // Add GameName= under [URL] section if it doesn't exist
-                fileContent.insert(urlPos + 5, "\nGameName=" + newProjectName + "\n");
-            }
-            else
-            {
-                // Update GameName= value if it exists
-                std::size_t endOfLinePos = fileContent.find('\n', gameNamePos);
-                fileContent.replace(gameNamePos, endOfLinePos - gameNamePos, "GameName=" + newProjectName);
-            }
+            fields.push_back(trim(field));
         }
 
-        // Check for [/Script/Engine.Engine] section
-        std::size_t enginePos = fileContent.find("[/Script/Engine.Engine]");
-        if (enginePos == std::string::npos)
+        if (fields.size() < 2 || fields.size() > 3 || fields[0].empty() || fields[1].empty())
         {
-            // Add [/Script/Engine.Engine] section if it doesn't exist
-            fileContent += "\n[/Script/Engine.Engine]\n+ActiveGameNameRedirects=(OldGameName=\"/Script/" + userCPPSourceName + "\", NewGameName=\"/Script/" + newProjectName + "\")";
-        }
-        else
-        {
-            // Check for +ActiveGameNameRedirects under [/Script/Engine.Engine]
-            std::size_t redirectsPos = fileContent.find("+ActiveGameNameRedirects=", enginePos);
-            std::size_t nextSectionPos = fileContent.find('[', enginePos + 1);
-
-            bool redirectFound = false;
-            std::set<std::string> oldGameNames;
-            std::size_t redirectsEndPos;
-            while (redirectsPos != std::string::npos && (nextSectionPos == std::string::npos || redirectsPos < nextSectionPos))
-            {
-                redirectsEndPos = fileContent.find('\n', redirectsPos);
-                std::size_t oldGameNameStart = fileContent.find("OldGameName=\"/Script/", redirectsPos) + 18;
-                std::size_t oldGameNameEnd = fileContent.find('\"', oldGameNameStart);
-                std::size_t newGameNameStart = fileContent.find("NewGameName=\"/Script/", redirectsPos) + 21;
-                std::size_t newGameNameEnd = fileContent.find('\"', newGameNameStart);
-
-                if (oldGameNameStart != std::string::npos && oldGameNameStart < redirectsEndPos)
-                {
-                    std::string oldGameName = fileContent.substr(oldGameNameStart, oldGameNameEnd - oldGameNameStart);
-                    oldGameNames.insert(oldGameName);
-
-                    std::string newGameName = fileContent.substr(newGameNameStart, newGameNameEnd - newGameNameStart);
-                    if (newGameName != newProjectName)
-                    {
-                        fileContent.replace(newGameNameStart, newGameNameEnd - newGameNameStart, newProjectName);
-                    }
-
-                    redirectFound = true;
-                }
-
-                redirectsPos = fileContent.find("+ActiveGameNameRedirects=", redirectsEndPos);
-            }
-
-            // Ensure there is at least one +ActiveGameNameRedirects entry for the new project name
-            if (!redirectFound || oldGameNames.find(userCPPSourceName) == oldGameNames.end())
-            {
-                fileContent.insert(enginePos + std::string("[/Script/Engine.Engine]").length(), "\n+ActiveGameNameRedirects=(OldGameName=\"/Script/" + userCPPSourceName + "\", NewGameName=\"/Script/" + newProjectName + "\")");
-            }
+            SetConsoleColour(COLOUR_RED);
+            std::cerr << "\nERROR: Invalid manifest line " << lineNumber << ", expected <project root>,<new name>[,<module>]: " << line << std::endl;
+            SetConsoleColour(COLOUR_WHITE);
+            return false;
         }
 
-        std::ofstream outFile(defaultEngineIniPath);
-        outFile << fileContent;
-        outFile.close();
-
-        SetConsoleColour(COLOUR_GREEN);
-        std::cout << "\nSuccessfully updated DefaultEngine.ini file: " << defaultEngineIniPath << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
+        auto project = std::make_unique<ProjectContext>();
+        project->projectRootDirectory = fields[0];
+        project->newProjectName = fields[1];
+        project->userCPPSourceName = fields.size() > 2 ? fields[2] : "";
+        project->unrealEngineDirectory = commandLineProject.unrealEngineDirectory;
+        projects.push_back(std::move(project));
     }
-    else
+
+    if (projects.empty())
     {
         SetConsoleColour(COLOUR_RED);
-        std::cerr << "\nERROR: DefaultEngine.ini file does not exist." << std::endl;
+        std::cerr << "\nERROR: The manifest does not list any projects: " << manifestPath << std::endl;
         SetConsoleColour(COLOUR_WHITE);
+        return false;
     }
+    return true;
 }
 
-void DeleteCachedProjectDirectories()
+// Rename every project in the manifest. Each project's steps run as one task on the shared pool,
+// so the steps of independent projects overlap while their file work is spread over all workers.
+int RenameManifestProjects()
 {
-    std::string userInput;
-
-    while (true)
+    std::vector<std::unique_ptr<ProjectContext>> projects;
+    if (!LoadManifest(projects))
     {
-        SetConsoleColour(COLOUR_ORANGE);
-        std::cout << "\nThe 'Saved' 'Intermediate' and 'Binaries' folders in your project directory are not backed up automatically. However it is still highly recommended that they should be deleted to clean all cached data." << std::endl;
-        std::cout << "\nWould you like this software to delete them for you? Please type 'Y' or 'N': ";
-        std::getline(std::cin, userInput);
-
-        if (userInput == "Y")
-        {
-            std::vector<std::string> directories = {"Saved", "Intermediate", "Binaries"};
-            for (const auto& dir : directories)
-            {
-                fs::path dirPath = fs::path(projectRootDirectory) / dir;
-                if (fs::exists(dirPath) && fs::is_directory(dirPath))
-                {
-                    try
-                    {
-                        fs::remove_all(dirPath);
-                        SetConsoleColour(COLOUR_GREEN);
-                        std::cout << "\nSuccessfully deleted directory: " << dirPath << std::endl;
-                        SetConsoleColour(COLOUR_WHITE);
-                    }
-                    catch (const fs::filesystem_error& e)
-                    {
-                        SetConsoleColour(COLOUR_RED);
-                        std::cerr << "\nERROR: Error deleting directory " << dirPath << ": " << e.what() << std::endl;
-                        SetConsoleColour(COLOUR_WHITE);
-                    }
-                }
-            }
-            break;
-        }
-        else if (userInput == "N")
-        {
-            break;
-        }
-        else
-        {
-            SetConsoleColour(COLOUR_RED);
-            std::cout << "ERROR: Invalid input. Please type 'Y' or 'N'." << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-        }
+        return EXIT_CODE_USAGE;
     }
-}
-
 
-void DeleteSlnFiles()
-{
-    if (isCPPProject)
+    std::vector<int> exitCodes(projects.size(), EXIT_CODE_SUCCESS);
+    TaskGroup group;
+    for (size_t i = 0; i < projects.size(); ++i)
     {
-        for (const auto& entry : fs::directory_iterator(projectRootDirectory))
-        {
-            if (entry.is_regular_file() && entry.path().extension() == ".sln")
+        threadPool->Submit(group, [&projects, &exitCodes, i]()
             {
-                BackupFile(entry.path());
-
+                // A step that throws, such as a failed journal write, only stops its own project
+                ProjectContext& project = *projects[i];
+                std::string error;
                 try
                 {
-                    fs::remove(entry.path());
-                    SetConsoleColour(COLOUR_GREEN);
-                    std::cout << "\nSuccessfully deleted .sln file: " << entry.path() << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
+                    exitCodes[i] = RenameProject(project);
+                    return;
                 }
-                catch (const fs::filesystem_error& e)
+                catch (const std::exception& e)
                 {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cerr << "\nERROR: Error deleting .sln file " << entry.path() << ": " << e.what() << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
+                    error = e.what();
                 }
-            }
-        }
+                catch (...)
+                {
+                    error = "unknown error";
+                }
+                project.phaseSpan.reset();
+                project.errorCount++;
+                exitCodes[i] = EXIT_CODE_RENAME_FAILED;
+                SubmitLog({ { LogLevel::Error, COLOUR_RED, project.newProjectName, "\nERROR: The rename stopped: " + error } });
+            });
     }
-    else
+    threadPool->Wait(group);
+    FlushLog();
+
+    // Summary of the whole batch, the exit code is the worst of all projects
+    int exitCode = EXIT_CODE_SUCCESS;
+    std::cout << "\nManifest summary:" << std::endl;
+    for (size_t i = 0; i < projects.size(); ++i)
     {
-        SetConsoleColour(COLOUR_GREEN);
-        std::cerr << "\nNo .sln file as project is blueprint only." << std::endl;
-        SetConsoleColour(COLOUR_WHITE);
+        SetConsoleColour(exitCodes[i] == EXIT_CODE_SUCCESS ? COLOUR_GREEN : COLOUR_RED);
+        std::cout << "  " << projects[i]->projectRootDirectory << " -> " << projects[i]->newProjectName << ": "
+            << (exitCodes[i] == EXIT_CODE_SUCCESS ? "renamed" : "failed") << " (" << projects[i]->errorCount << " error(s))" << std::endl;
+        exitCode = exitCodes[i] > exitCode ? exitCodes[i] : exitCode;
     }
+    SetConsoleColour(COLOUR_WHITE);
+    return exitCode;
 }
 
 
-// Function to generate Visual Studio project files using UnrealBuildTool
-void GenerateVisualStudioProjectFiles()
+int main(int argc, char* argv[])
 {
-    if (isCPPProject)
+    if (!ParseCommandLine(argc, argv))
     {
-        std::string unrealBuildToolPath;
-        std::string engineVersion;
-
-        while (true)
-        {
-            std::cout << "\nPlease enter the Major Unreal Engine version you are using (4 or 5): ";
-            std::getline(std::cin, engineVersion);
-
-            if (engineVersion == "4" || engineVersion == "5")
-            {
-                break; // Exit the loop if the input is valid
-            }
-            else
-            {
-                std::cout << "\nInvalid input. Please enter either 4 or 5.";
-            }
-        }
+        return EXIT_CODE_USAGE;
+    }
+    threadPool = std::make_unique<ThreadPool>(jobCount);
+    fileIo = CreateFileIo(fileIoBackend, *threadPool);
+    if (fileIoBackend == FileIoBackend::IoUring && std::string(fileIo->Name()) != "io_uring")
+    {
+        SetConsoleColour(COLOUR_ORANGE);
+        std::cout << "\nWARNING: io_uring is not available, files are read and written on the thread pool instead." << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+    }
+    engineLocator = std::make_unique<EngineLocator>(EngineLocator::DefaultIndexFile(), engineSearchPath);
 
-        while (true)
-        {
-            SetConsoleColour(COLOUR_WHITE);
+    if (!restoreBackupPath.empty())
+    {
+        return RestoreBackup();
+    }
 
-            std::cout << "\nPlease enter the Unreal Engine directory (usually found inside C:\\Program Files\\Epic Games\\): ";
-            std::getline(std::cin, unrealEngineDirectory);
+    if (!rollbackRunPath.empty())
+    {
+        return RollbackRun();
+    }
 
-            if (fs::exists(unrealEngineDirectory) && fs::is_directory(unrealEngineDirectory))
-            {
-                // Path to the UnrealBuildTool.exe - Use the provided Unreal Engine directory
+    if (!referenceQuery.empty())
+    {
+        return FindReferences();
+    }
 
-                if (engineVersion == "4")
-                {
-                    unrealBuildToolPath = unrealEngineDirectory + "\\Engine\\Binaries\\DotNET\\UnrealBuildTool.exe";
-                }
-                else
-                {
-                    unrealBuildToolPath = unrealEngineDirectory + "\\Engine\\Binaries\\DotNET\\UnrealBuildTool\\UnrealBuildTool.exe";
-                }
-                if (fs::exists(unrealBuildToolPath))
-                {
-                    break;
-                }
-                else
-                {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cout << "\nCannot find UnrealBuildTool.exe at " << unrealBuildToolPath << ". Please try again." << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                }
-            }
-            else
-            {
-                SetConsoleColour(COLOUR_RED);
-                std::cout << "\nThe provided path is not a valid directory. Please try again." << std::endl;
-                SetConsoleColour(COLOUR_WHITE);
-            }
-        }
+    if (!DisplayWarningAndGetConfirmation())
+    {
+        return EXIT_CODE_USAGE;
+    }
 
+    // From here on workers queue their console output and the logger thread prints it
+    std::string logError;
+    if (!StartLogger(consoleLogLevel, jsonLogPath, logError))
+    {
+        SetConsoleColour(COLOUR_RED);
+        std::cerr << "\nERROR: " << logError << std::endl;
+        SetConsoleColour(COLOUR_WHITE);
+        return EXIT_CODE_USAGE;
+    }
 
-        // Command to generate Visual Studio project files
-        std::string command = "\"\"" + unrealBuildToolPath + "\" -projectfiles -project=\"" + newUprojectFilePath.string() + "\" -game -engine\"";
+    if (!traceFilePath.empty())
+    {
+        StartTrace();
+    }
 
+    int exitCode = isManifestMode ? RenameManifestProjects() : RenameProject(commandLineProject);
+    StopLogger();
 
-        // Execute the command
-        int result = std::system(command.c_str());
-        if (result == 0)
+    if (!traceFilePath.empty())
+    {
+        std::string error;
+        if (WriteTrace(traceFilePath, error))
         {
-            SetConsoleColour(COLOUR_GREEN);
-            std::cout << "\nVisual Studio project files generated successfully." << std::endl;
+            std::cout << "\nTrace written to " << traceFilePath << std::endl << std::endl;
+            WriteTraceSummary(std::cout);
         }
         else
         {
             SetConsoleColour(COLOUR_RED);
-            std::cerr << "\nError generating Visual Studio project files." << std::endl;
+            std::cerr << "\nERROR: " << error << std::endl;
+            SetConsoleColour(COLOUR_WHITE);
         }
-        SetConsoleColour(COLOUR_WHITE);
     }
-    else
+
+    if (consoleLogLevel <= LogLevel::Info)
     {
-        SetConsoleColour(COLOUR_GREEN);
-        std::cerr << "\nGenerating Visual Studio project files not required as project is blueprint only." << std::endl;
+        SetConsoleColour(COLOUR_ORANGE);
+        std::cout << "\nINFO: When opening your Unreal Engine project for the first time after renaming, it will prompt you to rebuild missing or out of date modules. Select 'Yes'" << std::endl;
         SetConsoleColour(COLOUR_WHITE);
     }
-}
-
-void RenameProjectFolder()
-{
-    bool success = false;
 
-    while (!success)
+    if (!isBatchMode)
     {
-        try
-        {
-            // Set the current path as the old path
-            fs::path oldFolderPath = projectRootDirectory;
-
-            // Get the parent path of the old directory
-            fs::path parentPath = oldFolderPath.parent_path();
-
-            // Create the new path by combining the parent path with the new name
-            fs::path newFolderPath = parentPath / newProjectName;
-
-            // Convert paths to wstring for Windows API
-            std::wstring oldPath = oldFolderPath.wstring(); // Explicit conversion
-            std::wstring newPath = newFolderPath.wstring(); // Explicit conversion
-
-            // Attempt to rename with MoveFileEx
-            if (MoveFileEx(oldPath.c_str(), newPath.c_str(), MOVEFILE_REPLACE_EXISTING))
-            {
-                SetConsoleColour(COLOUR_GREEN);
-                std::cout << "\nSuccessfully renamed folder from:\n" << oldFolderPath << "\nTo:\n" << newFolderPath << std::endl;
-                SetConsoleColour(COLOUR_WHITE);
-                success = true;
-            }
-            else
-            {
-                DWORD dwError = GetLastError();
-                if (dwError == ERROR_ACCESS_DENIED)  // Error 5 means access denied
-                {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cout << "Failed to rename folder. Error code: " << dwError << std::endl;
-                    std::cout << "Please ensure all instances of this folder are closed (including File Explorer), and then press any key to retry..." << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                    // Wait for user to press a key to retry
-                    _getch(); // Waits for a key press
-                    std::cout << "Retrying...\n";
-                }
-                else
-                {
-                    SetConsoleColour(COLOUR_RED);
-                    std::cout << "Failed to rename folder. Error code: " << dwError << std::endl;
-                    SetConsoleColour(COLOUR_WHITE);
-                    break;
-                }
-            }
-        }
-        catch (const std::exception& e)
-        {
-            SetConsoleColour(COLOUR_RED);
-            std::cout << "Exception: " << e.what() << std::endl;
-            SetConsoleColour(COLOUR_WHITE);
-            break;
-        }
+        // Wait for a key press before closing
+        std::cout << "\nPress any key to close...";
+        WaitForKeyPress();
     }
+    return exitCode;
 }
-
-
-int main()
-{
-    DisplayWarningAndGetConfirmation();
-    SelectProjectPath();
-    CreateBackupFolder();
-    CheckIfCPPProject();
-    SetNewProjectName();
-    SetUprojectModuleName();
-    RenameUprojectFile();
-    EditTargetFiles();
-    EditSourceFolder();
-    EditConfigFiles();
-    DeleteCachedProjectDirectories();
-    DeleteSlnFiles();
-    GenerateVisualStudioProjectFiles();
-    RenameProjectFolder();
-    SetConsoleColour(COLOUR_GREEN);
-    std::cout << "\nSuccessfully completed Unreal Engine project rename" << std::endl;
-    SetConsoleColour(COLOUR_ORANGE);
-    std::cout << "\nINFO: When opening your Unreal Engine project for the first time after renaming, it will prompt you to rebuild missing or out of date modules. Select 'Yes'" << std::endl;
-    SetConsoleColour(COLOUR_WHITE);
-
-    // Wait for a key press before closing
-    std::cout << "\nPress any key to close...";
-    _getch(); // Waits for a key press
-    return 0;
-}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "globals.h"
+
+ProjectContext commandLineProject;
+
+bool isBatchMode = false;
+bool assumeYes = false;
+CacheCleanup cacheCleanup = CacheCleanup::Keep;
+bool skipProjectFileGeneration = false;
+
+bool isDryRun = false;
+
+std::string manifestPath;
+bool isManifestMode = false;
+
+unsigned jobCount = 0;
+std::unique_ptr<ThreadPool> threadPool;
+
+FileIoBackend fileIoBackend = FileIoBackend::Auto;
+std::unique_ptr<FileIo> fileIo;
+
+std::chrono::seconds projectFileGenerationTimeout(600);
+
+std::vector<fs::path> engineSearchPath;
+std::unique_ptr<EngineLocator> engineLocator;
+
+std::string referenceQuery;
+
+std::string restoreBackupPath;
+
+std::string rollbackRunPath;
+
+std::string traceFilePath;
+
+LogLevel consoleLogLevel = LogLevel::Info;
+
+std::string jsonLogPath;
@@ -1,27 +1,164 @@
 #pragma once
-#include <windows.h>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <string>
+#include "BackupStore.h"
+#include "ChangePlan.h"
+#include "EngineLocator.h"
+#include "FileIo.h"
+#include "Journal.h"
+#include "Logger.h"
+#include "Platform.h"
+#include "ProjectDescriptor.h"
+#include "ProgressLedger.h"
+#include "ProjectSnapshot.h"
+#include "ReferenceIndex.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "TrashCollector.h"
 
 namespace fs = std::filesystem;
 
 //Console Colours
-const WORD COLOUR_WHITE = 7;
-const WORD COLOUR_RED = 12;
-const WORD COLOUR_GREEN = 10;
-const WORD COLOUR_ORANGE = 6;
-
-std::string projectRootDirectory;
-std::string unrealEngineDirectory;
-std::string userCPPSourceName;
-std::string backupFolderName;
-std::string newProjectName;
-
-fs::path oldUprojectFilePath;
-fs::path newUprojectFilePath;
-fs::path sourceDirectory;
-fs::path backupDirectory;
-fs::path currentDateTimeBackupFolder;
-
-bool isCPPProject;
+const ConsoleColour COLOUR_WHITE = 7;
+const ConsoleColour COLOUR_RED = 12;
+const ConsoleColour COLOUR_GREEN = 10;
+const ConsoleColour COLOUR_ORANGE = 6;
+
+//Process exit codes for unattended runs
+const int EXIT_CODE_SUCCESS = 0;
+const int EXIT_CODE_USAGE = 1;
+const int EXIT_CODE_INVALID_PROJECT = 2;
+const int EXIT_CODE_RENAME_FAILED = 3;
+
+// How long one step of a rename took
+struct PhaseTiming
+{
+    std::string name;
+    double seconds;
+};
+
+// Everything the rename steps know about one project. Each project renamed by the process
+// has its own context, so projects from a manifest can be renamed side by side.
+struct ProjectContext
+{
+    std::string projectRootDirectory;
+    std::string unrealEngineDirectory;
+    std::string userCPPSourceName;
+    std::string backupFolderName;
+    std::string newProjectName;
+
+    fs::path oldUprojectFilePath;
+    fs::path newUprojectFilePath;
+    fs::path sourceDirectory;
+    fs::path backupDirectory;
+
+    bool isCPPProject = false;
+
+    // Every file and folder of the project, listed once when it is opened
+    std::unique_ptr<ProjectSnapshot> snapshot;
+
+    // Every module renamed with the project: those of the .uproject and of the project plugins
+    std::vector<ModuleRename> moduleRenames;
+
+    // The .uplugin files of the project plugins, and every Source folder holding modules
+    std::vector<fs::path> pluginDescriptors;
+    std::vector<fs::path> moduleSourceDirectories;
+
+    // Every file and folder rename of the run, in order, so generated files can follow them.
+    // Modules are renamed on the pool, so additions are guarded.
+    std::vector<std::pair<fs::path, fs::path>> renamedPaths;
+    std::mutex renamedPathsMutex;
+
+    // Where the module names appear in the project's files, kept in UEPR_Backups between runs
+    std::unique_ptr<ReferenceIndex> referenceIndex;
+
+    // Content-addressed backup store for this run
+    std::unique_ptr<BackupStore> backupStore;
+
+    // Write-ahead journal of every change made by this run
+    std::unique_ptr<Journal> journal;
+
+    // What this run has finished, so an interrupted run is resumed instead of repeated
+    std::unique_ptr<ProgressLedger> progress;
+
+    // Set for --dry-run: every step records its changes here instead of making them
+    std::unique_ptr<ChangePlan> changePlan;
+
+    // UnrealBuildTool generating the Visual Studio project files in the background, since when
+    std::unique_ptr<ChildProcess> projectFileGenerator;
+    std::chrono::steady_clock::time_point projectFileGenerationStart;
+
+    // Deletes the cache folders in the background once they are moved aside
+    std::unique_ptr<TrashCollector> trash;
+
+    // Time taken by each step of the run, in order, for the phase benchmark
+    std::vector<PhaseTiming> phaseTimings;
+    std::string currentPhase;
+    std::chrono::steady_clock::time_point phaseStart;
+    std::unique_ptr<TraceSpan> phaseSpan;
+
+    std::atomic<unsigned> errorCount{ 0 };
+};
+
+// The project given with --project or typed in interactively
+extern ProjectContext commandLineProject;
+
+// Unattended mode, enabled by --project or --manifest, never prompts and reports the outcome through the exit code
+extern bool isBatchMode;
+extern bool assumeYes;
+
+// What happens to the Saved, Intermediate and Binaries caches in unattended runs
+enum class CacheCleanup
+{
+    Keep,
+    Stale,  // Only build products named after the old project or module
+    All
+};
+extern CacheCleanup cacheCleanup;
+extern bool skipProjectFileGeneration;
+
+// --dry-run plans the rename and prints the changes and diffs without touching the disk
+extern bool isDryRun;
+
+// CSV manifest of "<project root>,<new name>[,<module>]" lines renamed in one process
+extern std::string manifestPath;
+extern bool isManifestMode;
+
+// Worker threads used for per-file rewrites, sized by --jobs
+extern unsigned jobCount;
+extern std::unique_ptr<ThreadPool> threadPool;
+
+// How the scan and rewrite passes read and write files, chosen with --io
+extern FileIoBackend fileIoBackend;
+extern std::unique_ptr<FileIo> fileIo;
+
+// How long UnrealBuildTool may take to generate project files before it is stopped, set with --ubt-timeout
+extern std::chrono::seconds projectFileGenerationTimeout;
+
+// Finds the engine of each project from its EngineAssociation when --engine is not given.
+// Folders from --engine-search and UEPR_ENGINE_SEARCH_PATH are searched for engines too.
+extern std::vector<fs::path> engineSearchPath;
+extern std::unique_ptr<EngineLocator> engineLocator;
+
+// The name whose references --where lists from the reference index
+extern std::string referenceQuery;
+
+// The backup run folder to restore when --restore is given
+extern std::string restoreBackupPath;
+
+// The backup run folder whose journal is undone when --rollback is given
+extern std::string rollbackRunPath;
+
+// Where --trace writes the spans of the run as a Chrome trace
+extern std::string traceFilePath;
+
+// Lowest level printed to the console, raised by --quiet and lowered by --verbose
+extern LogLevel consoleLogLevel;
+
+// Where --log-json writes every message as one JSON object per line
+extern std::string jsonLogPath;
 
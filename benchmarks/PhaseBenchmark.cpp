@@ -0,0 +1,273 @@
+// Times every phase of a rename on generated projects and reports files/s, MB/s and peak memory.
+// With --baseline the median phase times are compared with an earlier --save, and the exit code
+// is 1 if any phase got slower by more than --tolerance percent, so releases can be gated on it.
+//
+// Usage: uepr_phase_benchmark [options]
+//   --modules <n>        Modules in the project (default 8)
+//   --headers <n>        Headers per module, each with a .cpp (default 200)
+//   --file-size <kb>     Median source file size (default 8)
+//   --configs <n>        Config files (default 12)
+//   --intermediate <mb>  Size of the Intermediate folder (default 256)
+//   --seed <n>           Seed of the generated content (default 2408)
+//   --runs <n>           Renames to take the median of (default 3)
+//   --jobs <n>           Worker threads (defaults to the number of CPU threads)
+//   --io <backend>       File I/O backend: auto (default), io_uring or threads
+//   --work-dir <dir>     Where projects are generated (default: a folder in the temp directory)
+//   --generate <dir>     Only generate a project in <dir> and exit
+//   --save <file>        Write the median phase times as a baseline
+//   --baseline <file>    Compare with a baseline written by --save
+//   --tolerance <pct>    Slowdown allowed against the baseline (default 25)
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "globals.h"
+#include "Platform.h"
+#include "ProjectGenerator.h"
+#include "ProjectRenamer.h"
+
+namespace
+{
+    struct Options
+    {
+        GeneratorOptions generator;
+        unsigned runs = 3;
+        unsigned jobs = 0;
+        FileIoBackend io = FileIoBackend::Auto;
+        fs::path workDirectory = fs::temp_directory_path() / "uepr-phase-benchmark";
+        fs::path generateOnly;
+        fs::path saveFile;
+        fs::path baselineFile;
+        double tolerance = 25.0;
+    };
+
+    // Phases that go through one kind of file, so their time can be turned into a rate
+    FileCount PhaseWorkload(const std::string& phase, const GeneratedProject& project)
+    {
+        if (phase == "RefreshReferenceIndex")
+        {
+            return { project.descriptors.files + project.sources.files + project.configs.files, project.descriptors.bytes + project.sources.bytes + project.configs.bytes };
+        }
+        if (phase == "EditTargetFiles") return project.descriptors;
+        if (phase == "RenameModules") return project.sources;
+        if (phase == "EditConfigFiles") return project.configs;
+        if (phase == "DeleteCachedProjectDirectories" || phase == "FinishCacheDeletion") return project.intermediate;
+        return FileCount();
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string argument = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << argument << std::endl;
+                return false;
+            }
+            std::string value = argv[++i];
+            try
+            {
+                if (argument == "--modules") options.generator.moduleCount = std::stoul(value);
+                else if (argument == "--headers") options.generator.headersPerModule = std::stoul(value);
+                else if (argument == "--file-size") options.generator.medianFileSize = std::stoul(value) * 1024;
+                else if (argument == "--configs") options.generator.configCount = std::stoul(value);
+                else if (argument == "--intermediate") options.generator.intermediateSize = std::stoull(value) << 20;
+                else if (argument == "--seed") options.generator.seed = std::stoul(value);
+                else if (argument == "--runs") options.runs = std::max(1ul, std::stoul(value));
+                else if (argument == "--jobs") options.jobs = std::stoul(value);
+                else if (argument == "--io" && value == "auto") options.io = FileIoBackend::Auto;
+                else if (argument == "--io" && value == "io_uring") options.io = FileIoBackend::IoUring;
+                else if (argument == "--io" && value == "threads") options.io = FileIoBackend::ThreadPool;
+                else if (argument == "--work-dir") options.workDirectory = value;
+                else if (argument == "--generate") options.generateOnly = value;
+                else if (argument == "--save") options.saveFile = value;
+                else if (argument == "--baseline") options.baselineFile = value;
+                else if (argument == "--tolerance") options.tolerance = std::stod(value);
+                else
+                {
+                    std::cerr << "Unknown option " << argument << std::endl;
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << "Invalid value for " << argument << ": " << value << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Rename one freshly generated project with the tool's output silenced, and return its phase timings
+    bool RunOnce(const Options& options, unsigned run, GeneratedProject& generated, std::vector<PhaseTiming>& timings)
+    {
+        fs::path runDirectory = options.workDirectory / ("run" + std::to_string(run));
+        std::error_code error;
+        fs::remove_all(runDirectory, error);
+
+        std::string generateError;
+        if (!GenerateProject(runDirectory, options.generator, generated, generateError))
+        {
+            std::cerr << generateError << std::endl;
+            return false;
+        }
+
+        auto project = std::make_unique<ProjectContext>();
+        project->projectRootDirectory = generated.root.string();
+        project->newProjectName = "Renamed";
+
+        std::ostringstream discarded;
+        std::streambuf* output = std::cout.rdbuf(discarded.rdbuf());
+        std::streambuf* errors = std::cerr.rdbuf(discarded.rdbuf());
+        int exitCode = RenameProject(*project);
+        std::cout.rdbuf(output);
+        std::cerr.rdbuf(errors);
+
+        if (exitCode != EXIT_CODE_SUCCESS)
+        {
+            std::cerr << "Run " << run << " failed with exit code " << exitCode << ":" << discarded.str() << std::endl;
+            return false;
+        }
+        timings = project->phaseTimings;
+
+        fs::remove_all(runDirectory, error);
+        return true;
+    }
+
+    std::map<std::string, double> ReadBaseline(const fs::path& file)
+    {
+        std::map<std::string, double> baseline;
+        std::ifstream input(file);
+        std::string line;
+        while (std::getline(input, line))
+        {
+            size_t comma = line.find(',');
+            if (line.empty() || line[0] == '#' || comma == std::string::npos) continue;
+            try
+            {
+                baseline[line.substr(0, comma)] = std::stod(line.substr(comma + 1));
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+        return baseline;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (!options.generateOnly.empty())
+    {
+        GeneratedProject generated;
+        std::string error;
+        if (!GenerateProject(options.generateOnly, options.generator, generated, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::cout << "Generated " << generated.root.string() << ": " << generated.sources.files << " source files, "
+            << generated.configs.files << " config files, " << (generated.intermediate.bytes >> 20) << " MB in Intermediate" << std::endl;
+        return 0;
+    }
+
+    // The settings of an unattended rename that deletes the caches and does not start UnrealBuildTool
+    isBatchMode = true;
+    assumeYes = true;
+    cacheCleanup = CacheCleanup::All;
+    skipProjectFileGeneration = true;
+    if (options.jobs == 0)
+    {
+        unsigned hardwareThreads = std::thread::hardware_concurrency();
+        options.jobs = hardwareThreads > 0 ? hardwareThreads : 1;
+    }
+    jobCount = options.jobs;
+    threadPool = std::make_unique<ThreadPool>(jobCount);
+    fileIo = CreateFileIo(options.io, *threadPool);
+
+    std::vector<std::string> phaseOrder;
+    std::map<std::string, std::vector<double>> phaseSeconds;
+    GeneratedProject generated;
+    for (unsigned run = 1; run <= options.runs; ++run)
+    {
+        std::vector<PhaseTiming> timings;
+        if (!RunOnce(options, run, generated, timings))
+        {
+            return 1;
+        }
+        for (const auto& timing : timings)
+        {
+            if (phaseSeconds.find(timing.name) == phaseSeconds.end()) phaseOrder.push_back(timing.name);
+            phaseSeconds[timing.name].push_back(timing.seconds);
+        }
+    }
+
+    std::cout << "Project: " << generated.sources.files << " source files (" << (generated.sources.bytes >> 20) << " MB), "
+        << generated.configs.files << " config files, " << generated.intermediate.files << " files in Intermediate ("
+        << (generated.intermediate.bytes >> 20) << " MB), median of " << options.runs << " runs, " << fileIo->Name() << " I/O" << std::endl << std::endl;
+    std::cout << std::left << std::setw(32) << "Phase" << std::right << std::setw(10) << "ms" << std::setw(12) << "files/s" << std::setw(10) << "MB/s" << std::endl;
+
+    std::map<std::string, double> medians;
+    for (const auto& phase : phaseOrder)
+    {
+        std::vector<double>& seconds = phaseSeconds[phase];
+        std::sort(seconds.begin(), seconds.end());
+        double median = seconds[seconds.size() / 2];
+        medians[phase] = median;
+
+        std::cout << std::left << std::setw(32) << phase << std::right << std::fixed << std::setprecision(1) << std::setw(10) << median * 1000.0;
+        FileCount workload = PhaseWorkload(phase, generated);
+        if (workload.files > 0 && median > 0.0)
+        {
+            std::cout << std::setw(12) << std::setprecision(0) << workload.files / median << std::setw(10) << std::setprecision(1) << workload.bytes / median / (1 << 20);
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl << "Peak memory: " << (PeakMemoryUsage() >> 20) << " MB" << std::endl;
+
+    if (!options.saveFile.empty())
+    {
+        std::ofstream baseline(options.saveFile);
+        baseline << "# phase,median seconds\n";
+        for (const auto& phase : phaseOrder)
+        {
+            baseline << phase << ',' << std::setprecision(6) << medians[phase] << '\n';
+        }
+    }
+
+    // Phases shorter than a few milliseconds vary more than any tolerance between runs
+    int exitCode = 0;
+    if (!options.baselineFile.empty())
+    {
+        const double noiseSeconds = 0.01;
+        for (const auto& [phase, seconds] : ReadBaseline(options.baselineFile))
+        {
+            auto current = medians.find(phase);
+            if (current == medians.end()) continue;
+            if (current->second > seconds * (1.0 + options.tolerance / 100.0) && current->second - seconds > noiseSeconds)
+            {
+                std::cout << "REGRESSION: " << phase << " took " << std::setprecision(1) << current->second * 1000.0 << " ms, baseline " << seconds * 1000.0 << " ms" << std::endl;
+                exitCode = 1;
+            }
+        }
+        if (exitCode == 0)
+        {
+            std::cout << "No phase is more than " << options.tolerance << "% slower than the baseline" << std::endl;
+        }
+    }
+    return exitCode;
+}
@@ -0,0 +1,246 @@
+#include "ProjectGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Lines of generated and hand written Unreal code. {M} is the module, {A} its API macro, {P} the
+    // primary module and {n} a running number. Most lines do not mention a module, as in real code.
+    const std::vector<std::string> CodeLines = {
+        "class {A} U{M}Component{n} : public UActorComponent\n{\n\tGENERATED_BODY()\npublic:\n",
+        "\tUPROPERTY(EditAnywhere, BlueprintReadWrite, Category = \"Movement\")\n\tfloat MaxWalkSpeed{n} = 600.0f;\n",
+        "\tUFUNCTION(BlueprintCallable, Category = \"Movement\")\n\tvoid UpdateMovement{n}(float DeltaTime, const FVector& Direction);\n",
+        "};\n\n",
+        "\tconst int32 Count = Items.Num();\n\tfor (int32 Index = 0; Index < Count; ++Index)\n\t{\n\t\tItems[Index].Reset();\n\t}\n",
+        "\tif (!Target.IsValid() || Target->GetWorld() == nullptr)\n\t{\n\t\treturn;\n\t}\n",
+        "\tstatic UClass* Z_Construct_UClass_UActorComponent_NoRegister();\n\tstatic void StaticRegisterNatives{n}();\n",
+        "\tDECLARE_FUNCTION(execUpdateMovement{n});\n\tP_GET_PROPERTY(FFloatProperty, Z_Param_DeltaTime);\n\tP_FINISH;\n",
+        "\tFVector Location = GetOwner()->GetActorLocation() + Direction * Speed * DeltaTime;\n\tSetActorLocation(Location, true);\n",
+        "\t// Keep the previous state so the update can be blended over several frames\n\tPreviousState = CurrentState;\n",
+        "DEFINE_LOG_CATEGORY_STATIC(Log{M}, Log, All);\n",
+        "#include \"{M}Types.h\"\n#include \"{P}.h\"\n",
+        "\tUE_LOG(Log{M}, Verbose, TEXT(\"/Script/{M}.U{M}Component{n} updated\"));\n",
+    };
+
+    const std::vector<unsigned> CodeLineWeights = { 2, 12, 8, 2, 10, 10, 6, 6, 10, 8, 1, 1, 1 };
+
+    std::string ApiMacro(const std::string& moduleName)
+    {
+        std::string macro = moduleName;
+        std::transform(macro.begin(), macro.end(), macro.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        return macro + "_API";
+    }
+
+    std::string Expand(const std::string& pattern, const std::string& moduleName, const std::string& primaryModule, unsigned number)
+    {
+        std::string text;
+        text.reserve(pattern.size() + 64);
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            if (pattern[i] == '{' && i + 2 < pattern.size() && pattern[i + 2] == '}')
+            {
+                switch (pattern[i + 1])
+                {
+                case 'M': text += moduleName; break;
+                case 'A': text += ApiMacro(moduleName); break;
+                case 'P': text += primaryModule; break;
+                case 'n': text += std::to_string(number); break;
+                }
+                i += 2;
+            }
+            else
+            {
+                text += pattern[i];
+            }
+        }
+        return text;
+    }
+
+    class Generator
+    {
+    public:
+        Generator(const GeneratorOptions& options, GeneratedProject& project, std::string& error)
+            : options(options), project(project), error(error), random(options.seed), pickLine(CodeLineWeights.begin(), CodeLineWeights.end())
+        {
+        }
+
+        bool Run(const fs::path& parent)
+        {
+            project.root = parent / options.projectName;
+
+            std::vector<std::string> modules;
+            for (unsigned i = 0; i < std::max(options.moduleCount, 1u); ++i)
+            {
+                if (i == 0) modules.push_back(options.projectName);
+                else if (i == 1) modules.push_back(options.projectName + "Core");
+                else if (i == 2) modules.push_back(options.projectName + "Editor");
+                else modules.push_back(options.projectName + "Module" + std::to_string(i));
+            }
+
+            return WriteDescriptors(modules) && WriteSources(modules) && WriteConfigs(modules) && WriteIntermediate(modules);
+        }
+
+    private:
+        bool WriteDescriptors(const std::vector<std::string>& modules)
+        {
+            std::string uproject = "{\n\t\"FileVersion\": 3,\n\t\"EngineAssociation\": \"5.3\",\n\t\"Category\": \"\",\n\t\"Description\": \"\",\n\t\"Modules\": [\n";
+            std::string moduleList;
+            for (size_t i = 0; i < modules.size(); ++i)
+            {
+                bool isEditor = modules[i] == options.projectName + "Editor";
+                uproject += "\t\t{\n\t\t\t\"Name\": \"" + modules[i] + "\",\n\t\t\t\"Type\": \"" + (isEditor ? "Editor" : "Runtime") + "\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}";
+                uproject += i + 1 < modules.size() ? ",\n" : "\n";
+                moduleList += (i > 0 ? ", \"" : "\"") + modules[i] + "\"";
+            }
+            uproject += "\t]\n}\n";
+            if (!Write(project.root / (options.projectName + ".uproject"), uproject, project.descriptors)) return false;
+
+            for (const std::string suffix : { "", "Editor" })
+            {
+                std::string targetName = options.projectName + suffix;
+                std::string target = "using UnrealBuildTool;\nusing System.Collections.Generic;\n\npublic class " + targetName + "Target : TargetRules\n{\n"
+                    "\tpublic " + targetName + "Target(TargetInfo Target) : base(Target)\n\t{\n\t\tType = TargetType." + (suffix[0] ? "Editor" : "Game") + ";\n"
+                    "\t\tDefaultBuildSettings = BuildSettingsVersion.V4;\n\t\tExtraModuleNames.AddRange(new string[] { " + moduleList + " });\n\t}\n}\n";
+                if (!Write(project.root / "Source" / (targetName + ".Target.cs"), target, project.descriptors)) return false;
+            }
+
+            for (const auto& moduleName : modules)
+            {
+                std::string dependencies = "\"Core\", \"CoreUObject\", \"Engine\"";
+                if (moduleName != modules[0]) dependencies += ", \"" + modules[0] + "\"";
+                std::string build = "using UnrealBuildTool;\n\npublic class " + moduleName + " : ModuleRules\n{\n\tpublic " + moduleName + "(ReadOnlyTargetRules Target) : base(Target)\n\t{\n"
+                    "\t\tPCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;\n\t\tPublicDependencyModuleNames.AddRange(new string[] { " + dependencies + " });\n\t}\n}\n";
+                if (!Write(project.root / "Source" / moduleName / (moduleName + ".Build.cs"), build, project.descriptors)) return false;
+            }
+            return true;
+        }
+
+        bool WriteSources(const std::vector<std::string>& modules)
+        {
+            unsigned number = 0;
+            for (const auto& moduleName : modules)
+            {
+                fs::path moduleDirectory = project.root / "Source" / moduleName;
+                std::string implement = moduleName == modules[0]
+                    ? "IMPLEMENT_PRIMARY_GAME_MODULE(FDefaultGameModuleImpl, " + moduleName + ", \"" + moduleName + "\");\n"
+                    : "IMPLEMENT_MODULE(FDefaultModuleImpl, " + moduleName + ");\n";
+                if (!Write(moduleDirectory / "Public" / (moduleName + ".h"), "#pragma once\n\n#include \"CoreMinimal.h\"\n", project.sources)) return false;
+                if (!Write(moduleDirectory / "Private" / (moduleName + ".cpp"), "#include \"" + moduleName + ".h\"\n#include \"Modules/ModuleManager.h\"\n\n" + implement, project.sources)) return false;
+
+                for (unsigned i = 0; i < options.headersPerModule; ++i)
+                {
+                    std::string baseName = moduleName + "Thing" + std::to_string(i);
+                    std::string header = "#pragma once\n\n#include \"CoreMinimal.h\"\n#include \"" + baseName + ".generated.h\"\n\n" + Code(moduleName, modules[0], number);
+                    std::string source = "#include \"" + baseName + ".h\"\n\n" + Code(moduleName, modules[0], number);
+                    if (!Write(moduleDirectory / "Public" / (baseName + ".h"), header, project.sources)) return false;
+                    if (!Write(moduleDirectory / "Private" / (baseName + ".cpp"), source, project.sources)) return false;
+                }
+            }
+            return true;
+        }
+
+        bool WriteConfigs(const std::vector<std::string>& modules)
+        {
+            fs::path configDirectory = project.root / "Config";
+            const std::string& primary = modules[0];
+
+            std::string engine = "[/Script/EngineSettings.GameMapsSettings]\nGameDefaultMap=/Game/Maps/Main.Main\nGlobalDefaultGameMode=/Script/" + primary + "." + primary + "GameMode\n\n"
+                "[/Script/Engine.Engine]\n+ActiveGameNameRedirects=(OldGameName=\"TP_Blank\",NewGameName=\"/Script/" + primary + "\")\n"
+                "+ActiveGameNameRedirects=(OldGameName=\"/Script/TP_Blank\",NewGameName=\"/Script/" + primary + "\")\n\n"
+                "[/Script/WindowsTargetPlatform.WindowsTargetSettings]\nDefaultGraphicsRHI=DefaultGraphicsRHI_DX12\n";
+            if (!Write(configDirectory / "DefaultEngine.ini", engine, project.configs)) return false;
+
+            for (unsigned i = 1; i < options.configCount; ++i)
+            {
+                const std::string& moduleName = modules[i % modules.size()];
+                std::string config = "[/Script/" + moduleName + "." + moduleName + "Settings]\n";
+                size_t size = FileSize() / 4;
+                unsigned setting = 0;
+                while (config.size() < size)
+                {
+                    config += "+Entries=(Name=\"Entry" + std::to_string(setting) + "\",Class=\"/Script/" + (setting % 16 == 0 ? moduleName : std::string("Engine")) + ".Actor\",Value=" + std::to_string(setting * 7 % 1000) + ")\n";
+                    setting++;
+                }
+                std::string name = i == 1 ? "DefaultGame.ini" : i == 2 ? "DefaultInput.ini" : "DefaultBench" + std::to_string(i) + ".ini";
+                if (!Write(configDirectory / name, config, project.configs)) return false;
+            }
+            return true;
+        }
+
+        // Build products are written from one block of generated code, as only their number and size matter
+        bool WriteIntermediate(const std::vector<std::string>& modules)
+        {
+            unsigned number = 0;
+            std::string block;
+            while (block.size() < (1u << 20))
+            {
+                block += Code(modules[0], modules[0], number);
+            }
+
+            uint64_t written = 0;
+            for (unsigned i = 0; written < options.intermediateSize; ++i)
+            {
+                const std::string& moduleName = modules[i % modules.size()];
+                size_t size = static_cast<size_t>(std::min<uint64_t>(std::min<uint64_t>(FileSize() * 4, block.size()), options.intermediateSize - written));
+                fs::path path = project.root / "Intermediate" / "Build" / "Win64" / "UnrealEditor" / "Inc" / moduleName / "UHT" / (moduleName + "Thing" + std::to_string(i) + ".gen.cpp");
+                if (!Write(path, std::string_view(block).substr(0, size), project.intermediate)) return false;
+                written += size;
+            }
+            return true;
+        }
+
+        // Source text of about one file size
+        std::string Code(const std::string& moduleName, const std::string& primaryModule, unsigned& number)
+        {
+            size_t size = FileSize();
+            std::string text;
+            text.reserve(size + 256);
+            while (text.size() < size)
+            {
+                text += Expand(CodeLines[pickLine(random)], moduleName, primaryModule, number++);
+            }
+            return text;
+        }
+
+        size_t FileSize()
+        {
+            std::lognormal_distribution<double> size(std::log(static_cast<double>(std::max(options.medianFileSize, 64u))), 1.0);
+            return static_cast<size_t>(std::clamp(size(random), 64.0, 64.0 * 1024 * 1024));
+        }
+
+        bool Write(const fs::path& path, std::string_view content, FileCount& count)
+        {
+            std::error_code createError;
+            fs::create_directories(path.parent_path(), createError);
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(content.data(), static_cast<std::streamsize>(content.size()));
+            if (!file)
+            {
+                error = "Could not write " + path.string();
+                return false;
+            }
+            count.files++;
+            count.bytes += content.size();
+            return true;
+        }
+
+        const GeneratorOptions& options;
+        GeneratedProject& project;
+        std::string& error;
+        std::mt19937 random;
+        std::discrete_distribution<size_t> pickLine;
+    };
+}
+
+bool GenerateProject(const fs::path& parent, const GeneratorOptions& options, GeneratedProject& project, std::string& error)
+{
+    project = GeneratedProject();
+    Generator generator(options, project, error);
+    return generator.Run(parent);
+}
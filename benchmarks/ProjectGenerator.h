@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Shape of a generated project
+struct GeneratorOptions
+{
+    std::string projectName = "BenchGame";
+
+    // Modules in Source, the primary one included. They are named <Project>, <Project>Core, <Project>Editor,
+    // then <Project>Module<n>, so every one of them is renamed.
+    unsigned moduleCount = 8;
+
+    // Header files per module, each with a .cpp next to it
+    unsigned headersPerModule = 200;
+
+    // Median size of a source file in bytes. Sizes follow a log-normal distribution, so like real
+    // generated code a few files are many times larger than the rest.
+    unsigned medianFileSize = 8 * 1024;
+
+    // .ini files in Config, DefaultEngine.ini included
+    unsigned configCount = 12;
+
+    // Bytes of build products in Intermediate
+    uint64_t intermediateSize = 256ull << 20;
+
+    uint32_t seed = 2408;
+};
+
+// Number and size of the files of one kind
+struct FileCount
+{
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+};
+
+// What was written, to turn the time of a phase into files/s and MB/s
+struct GeneratedProject
+{
+    std::filesystem::path root;
+    FileCount descriptors;  // .uproject, Target.cs and Build.cs files
+    FileCount sources;
+    FileCount configs;
+    FileCount intermediate;
+};
+
+// Write a fake C++ project to <parent>/<projectName>. The files only have to look like a project to
+// the renamer: a .uproject listing the modules, Target and Build.cs files, headers and sources that
+// use the module names and API macros, config files with /Script/<Module> paths and an Intermediate
+// folder. Returns false with `error` set if a file could not be written.
+bool GenerateProject(const std::filesystem::path& parent, const GeneratorOptions& options, GeneratedProject& project, std::string& error);
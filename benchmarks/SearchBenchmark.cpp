@@ -0,0 +1,154 @@
+// Throughput of the substring search kernels against the std::string::find loop they replace.
+// Searches a generated text that looks like UnrealHeaderTool output, once for a single name and
+// once for the full pattern set of a module rename, and prints GB/s for every kernel the CPU has.
+//
+// Usage: uepr_search_benchmark [megabytes]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ReplaceEngine.h"
+#include "SubstringSearch.h"
+
+namespace
+{
+    // Identifiers, keywords and punctuation of generated headers, with the old module names rare among them
+    std::string GenerateText(size_t size)
+    {
+        const std::vector<std::string> tokens = {
+            "UPROPERTY", "UFUNCTION", "BlueprintCallable", "EditAnywhere", "Category", "Meta", "FVector", "FRotator",
+            "UObject", "AActor", "Z_Construct_UClass_", "StaticRegisterNatives", "DECLARE_FUNCTION", "P_FINISH;",
+            "int32", "float", "bool", "return", "const", "static", "(", ")", "{", "}", ";", "::", "=", "0.0f",
+            "GetPrivateStaticClass", "UE_INLINE_GENERATED_CPP_BY_NAME", "TEXT(\"", "\")", "Mesh", "Movement",
+            "MaxWalkSpeed", "Default__", "/Script/Engine", "ENGINE_API", "CoreUObject", "Game", "MAX_uint32"
+        };
+        const std::vector<std::string> rareTokens = { "MyGame", "MYGAME_API", "/Script/MyGame", "MyGameCore", "MYGAMEEDITOR_API" };
+
+        std::mt19937 random(2408);
+        std::uniform_int_distribution<size_t> pick(0, tokens.size() - 1);
+        std::uniform_int_distribution<size_t> pickRare(0, rareTokens.size() - 1);
+        std::uniform_int_distribution<int> percent(0, 999);
+
+        std::string text;
+        text.reserve(size + 64);
+        size_t lineLength = 0;
+        while (text.size() < size)
+        {
+            text += percent(random) == 0 ? rareTokens[pickRare(random)] : tokens[pick(random)];
+            lineLength++;
+            if (lineLength == 8)
+            {
+                text += "\r\n\t";
+                lineLength = 0;
+            }
+            else
+            {
+                text += ' ';
+            }
+        }
+        text.resize(size);
+        return text;
+    }
+
+    // Best of a few runs, in GB/s, as the first run also pays for page faults
+    double Measure(const std::string& text, const std::function<size_t()>& search, size_t& matches)
+    {
+        double best = 0.0;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            matches = search();
+            std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+            best = std::max(best, static_cast<double>(text.size()) / seconds.count() / 1e9);
+        }
+        return best;
+    }
+
+    void Report(const std::string& name, double gigabytesPerSecond, size_t matches, double baseline)
+    {
+        std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(8) << gigabytesPerSecond << " GB/s " << std::setw(7) << gigabytesPerSecond / baseline << "x "
+            << std::setw(10) << matches << " matches" << std::endl;
+    }
+
+    std::vector<SearchKernel> SupportedKernels()
+    {
+        std::vector<SearchKernel> kernels;
+        for (SearchKernel kernel : { SearchKernel::Scalar, SearchKernel::SSE2, SearchKernel::AVX2, SearchKernel::AVX512 })
+        {
+            if (IsSearchKernelSupported(kernel)) kernels.push_back(kernel);
+        }
+        return kernels;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    std::string text = GenerateText(std::max<size_t>(megabytes, 1) << 20);
+    std::cout << "Searching " << (text.size() >> 20) << " MiB, best kernel here: " << SearchKernelName(DetectSearchKernel()) << std::endl;
+
+    // One name, as a single ReplaceAll used to search for it
+    const std::string name = "MyGame";
+    std::cout << "\nOne string, \"" << name << "\":" << std::endl;
+    size_t matches = 0;
+    double baseline = Measure(text, [&]()
+        {
+            size_t count = 0;
+            for (size_t i = text.find(name); i != std::string::npos; i = text.find(name, i + 1)) count++;
+            return count;
+        }, matches);
+    Report("std::string::find", baseline, matches, baseline);
+
+    for (SearchKernel kernel : SupportedKernels())
+    {
+        CandidateFilter filter({ name }, kernel);
+        double speed = Measure(text, [&]()
+            {
+                size_t count = 0;
+                for (size_t i = filter.Next(text, 0); i + name.size() <= text.size(); i = filter.Next(text, i + 1))
+                {
+                    if (std::memcmp(text.data() + i, name.data(), name.size()) == 0) count++;
+                }
+                return count;
+            }, matches);
+        Report(std::string("filter, ") + SearchKernelName(kernel), speed, matches, baseline);
+    }
+
+    // Everything a rename of three modules looks for, once one find loop per pattern
+    const std::vector<std::string> patterns = {
+        "MyGame", "MYGAME_API", "/Script/MyGame", "MyGameCore", "MYGAMECORE_API", "/Script/MyGameCore",
+        "MyGameEditor", "MYGAMEEDITOR_API", "/Script/MyGameEditor"
+    };
+    std::cout << "\nRename patterns, " << patterns.size() << " strings:" << std::endl;
+    baseline = Measure(text, [&]()
+        {
+            size_t count = 0;
+            for (const auto& pattern : patterns)
+            {
+                for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1)) count++;
+            }
+            return count;
+        }, matches);
+    Report("std::string::find per string", baseline, matches, baseline);
+
+    for (SearchKernel kernel : SupportedKernels())
+    {
+        MultiReplacer replacer;
+        for (const auto& pattern : patterns)
+        {
+            replacer.Add(pattern, pattern);
+        }
+        replacer.Compile(kernel);
+        double speed = Measure(text, [&]() { return replacer.FindAllMatches(text).size(); }, matches);
+        Report(std::string("automaton, ") + SearchKernelName(kernel), speed, matches, baseline);
+    }
+    return 0;
+}